@@ -16,7 +16,9 @@
  * scanline 192-262/312 = blank<br>
  * <br>
  * With extended blank bitmap buffer can be transferred to VRAM 20 times per second in NTSC<br>
- * and 25 time per second in PAL.
+ * and 25 time per second in PAL.<br>
+ * Only tile rows (8 pixels lines) modified since the buffer was last transferred are sent to VRAM
+ * so flipping a mostly static bitmap is much faster.
  */
 
 #include "maths.h"
@@ -229,7 +231,8 @@ typedef struct
  */
 extern u8 *bmp_buffer_read;
 /**
- *      Current bitmap write buffer.
+ *      Current bitmap write buffer.<br>
+ *      If you write directly into it you need to call #BMP_invalidate() on modified area.
  */
 extern u8 *bmp_buffer_write;
 
@@ -315,6 +318,20 @@ u16 BMP_flip(u16 async);
  *      Clear bitmap buffer.
  */
 void BMP_clear(void);
+/**
+ *  \brief
+ *      Mark the specified lines of bitmap write buffer as modified.
+ *
+ *  \param y
+ *      First modified line.
+ *  \param h
+ *      Number of modified lines.
+ *
+ * Only modified tile rows are transferred to VRAM on flip so you need to call it
+ * when you write directly into #bmp_buffer_write.<br>
+ * All BMP_xxx drawing methods already take care of it.
+ */
+void BMP_invalidate(u16 y, u16 h);
 
 /**
  *  \brief
@@ -326,7 +343,8 @@ void BMP_clear(void);
  *      Y pixel coordinate.
  *
  * As coordinates are expressed for 4bpp pixel BMP_getWritePointer(0,0)
- * and BMP_getWritePointer(1,0) actually returns the same address.
+ * and BMP_getWritePointer(1,0) actually returns the same address.<br>
+ * All lines from Y to the bottom of the bitmap are considered as modified.
  */
 u8*  BMP_getWritePointer(u16 x, u16 y);
 /**
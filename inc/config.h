@@ -101,6 +101,21 @@
  */
 #define LEGACY_FONT_LOCATION    1
 
+/**
+ *  \brief
+ *      Set it to 1 to enable the CPU profiler (see profiler.h).<br>
+ *      When disabled PROF_BEGIN(..) / PROF_END(..) macros don't generate any code.
+ */
+#define ENABLE_PROFILER         0
+
+/**
+ *  \brief
+ *      Size (in bytes) of the frame arena reserved at end of heap by MEM_init() (see MEM_allocFrame(..)).<br>
+ *      Frame arena provides fast temporary allocations automatically released on each SYS_doVBlankProcess() call.<br>
+ *      Set it to 0 to disable the frame arena (default) so all memory remains available for the heap.
+ */
+#define FRAME_ARENA_SIZE        0
+
 /**
  *  \brief
  *      Set it to 1 to enable automatic bank switch using official SEGA mapper for ROM > 4MB.
@@ -30,6 +30,22 @@
  */
 #define DMA_VSRAM   2
 
+/**
+ *  \brief
+ *      Low priority for DMA queue transfer (see #DMA_setQueuePriority(..)).
+ */
+#define DMA_PRIO_LOW        0
+/**
+ *  \brief
+ *      Normal priority for DMA queue transfer (default).
+ */
+#define DMA_PRIO_NORMAL     1
+/**
+ *  \brief
+ *      High priority for DMA queue transfer.
+ */
+#define DMA_PRIO_HIGH       2
+
 #define DMA_QUEUE_SIZE_DEFAULT          80
 #define DMA_QUEUE_SIZE_MIN              32
 
@@ -76,6 +92,11 @@ typedef struct
  *      DMA queue structure
  */
 extern DMAOpInfo *dmaQueues;
+/**
+ *  \brief
+ *      DMA queue transfer priorities
+ */
+extern u8* dmaQueuePrios;
 /**
  *  \brief
  *      DMA queue structure
@@ -231,8 +252,54 @@ bool DMA_getIgnoreOverCapacity(void);
  *      When set to <i>FALSE</i> all DMA operations are done even when we are over the maximum capacity (which can lead to important slowdown).
  *
  *  \see DMA_setMaxTransferSize()
+ *  \see DMA_setCarryOverCapacity()
  */
 void DMA_setIgnoreOverCapacity(bool value);
+/**
+ *  \brief
+ *      Return TRUE means that DMA operations above the maximum capacity are delayed to next frame (see #DMA_setCarryOverCapacity(..) method).
+ *
+ *  \see DMA_setCarryOverCapacity(void)
+ */
+bool DMA_getCarryOverCapacity(void);
+/**
+ *  \brief
+ *      Set the "carry over capacity" DMA queue strategy (default is FALSE).
+ *
+ *      When set to <i>TRUE</i> and the DMA queue is above the maximum defined transfer capacity (see #DMA_setMaxTransferSize(..)),
+ *      #DMA_flushQueue() only sends the transfers fitting in the capacity, selected by priority (see #DMA_setQueuePriority(..)) then queue order,
+ *      and keeps the remaining ones (oldest first) in the queue for the next flush.<br>
+ *      Priority levels are sent whole while they fit, the first level not fitting is sent in queue order while capacity remains
+ *      and lower levels are delayed.<br>
+ *      Delayed transfers get their priority raised so they can't be delayed forever, and a transfer is never sent before an older
+ *      delayed transfer with overlapping destination.<br>
+ *      Source data of delayed transfers must stay valid until they are actually done (data allocated in the DMA temporary buffer is preserved,
+ *      and the frame arena isn't released by SYS_doVBlankProcess() while a delayed transfer uses it, see #MEM_allocFrame(..)).<br>
+ *      This strategy is exclusive with the "ignore over capacity" strategy (see #DMA_setIgnoreOverCapacity(..)).
+ *
+ *  \see DMA_setMaxTransferSize()
+ *  \see DMA_setQueuePriority()
+ *  \see DMA_getQueueBacklog()
+ */
+void DMA_setCarryOverCapacity(bool value);
+/**
+ *  \brief
+ *      Returns the priority affected to new DMA queue transfers.
+ *
+ *  \see DMA_setQueuePriority(..)
+ */
+u8 DMA_getQueuePriority(void);
+/**
+ *  \brief
+ *      Set the priority affected to next DMA queue transfers (default is #DMA_PRIO_NORMAL).<br>
+ *      Priority is only used by the "carry over capacity" strategy to select transfers to send first.
+ *
+ *  \param value
+ *      Priority value: #DMA_PRIO_LOW, #DMA_PRIO_NORMAL or #DMA_PRIO_HIGH
+ *
+ *  \see DMA_setCarryOverCapacity(..)
+ */
+void DMA_setQueuePriority(u8 value);
 
 /**
  *  \brief
@@ -266,6 +333,21 @@ u16 DMA_getQueueSize(void);
  *      PAL frame allows about 17 KB (in H40).
  */
 u16 DMA_getQueueTransferSize(void);
+/**
+ *  \brief
+ *      Returns the number of extra frames (#DMA_flushQueue() calls) required to transfer all data currently present
+ *      in the DMA queue given the maximum transfer capacity (0 means all pending transfers will be done on next flush).<br>
+ *      Only meaningful with the "carry over capacity" strategy (see #DMA_setCarryOverCapacity(..)).
+ */
+u16 DMA_getQueueBacklog(void);
+/**
+ *  \brief
+ *      Returns the number of transfers merged in the DMA queue since DMA initialization.<br>
+ *      A queued transfer is automatically merged with the previous one when both source and destination are contiguous
+ *      and step and priority are the same (saves a queue entry and the DMA setup time), as long as the merged transfer
+ *      doesn't cross a 128 KB source bank and doesn't exceed the maximum transfer capacity (see #DMA_setMaxTransferSize(..)).
+ */
+u32 DMA_getMergedTransferCount(void);
 
 /**
  *  \brief
@@ -402,6 +484,7 @@ bool DMA_copyAndQueueDma(u8 location, void* from, u16 to, u16 len, u16 step);
  *  \brief
  *      Queues the specified DMA transfer operation in the DMA queue.<br>
  *      The idea of the DMA queue is to burst all DMA operations during VBLank to maximize bandwidth usage.<br>
+ *      The transfer is merged with the previous queued transfer when they are contiguous (see #DMA_getMergedTransferCount()).<br>
  *
  *  \param location
  *      Destination location.<br>
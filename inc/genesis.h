@@ -54,6 +54,7 @@
 
 #include "joy.h"
 #include "timer.h"
+#include "profiler.h"
 
 #include "task.h"
 
@@ -82,6 +82,8 @@ typedef void MapDataPatchCallback(Map *map, u16 *buf, u16 x, u16 y, MapUpdateTyp
  *      b0-b3=compression type for metaTiles<br>
  *      b4-b7=compression for blocks data<br>
  *      b8-b11=compression for blockIndexes data<br>
+ *      b12-b14=chunk row shift for streamed blockIndexes data (see MAP_STREAMING)<br>
+ *      b15=streaming flag (MAP_STREAMING)<br>
  *      Accepted values:<br>
  *        <b>COMPRESSION_NONE</b><br>
  *        <b>COMPRESSION_APLIB</b><br>
@@ -104,10 +106,25 @@ typedef void MapDataPatchCallback(Map *map, u16 *buf, u16 x, u16 y, MapUpdateTyp
  *  \param blockIndexes
  *      block index array (referencing blocks) for the w * hp sized map<br>
  *      if numBlock <= 256 --> 8 bit index for block
- *      else --> 16 bit index for block
+ *      else --> 16 bit index for block<br>
+ *      When MAP_STREAMING flag is set, it contains a chunk table (numChunk + 1 entries, b31-b24=compression, b23-b0=offset)
+ *      followed by the independently packed chunks, each chunk containing (1 << chunk row shift) rows of block indexes.
  *  \param blockRowOffsets
  *      block row offsets used internally for fast retrieval of block data (index = blockIndexes[blockRowOffsets[y] + x])
  */
+/**
+ *  \brief
+ *      Streaming flag for MapDefinition.compression field.<br>
+ *      When set, block indexes are split in small independently packed row chunks which are unpacked on demand
+ *      in a small cache instead of unpacking the whole block index array in memory.
+ */
+#define MAP_STREAMING               0x8000
+/**
+ *  \brief
+ *      Number of cached block index chunks for streamed map (should be >= 3 to handle a full screen update)
+ */
+#define MAP_STREAMING_SLOT          4
+
 typedef struct
 {
     u16 w;
@@ -122,6 +139,51 @@ typedef struct
     u16* blockRowOffsets;
 } MapDefinition;
 
+/**
+ *  \brief
+ *      Internal - block indexes chunk cache used by streamed map (see MAP_STREAMING)
+ *
+ *  \param chunkInfo
+ *      chunk table (packed data location and compression for each chunk)
+ *  \param srcRowOffsets
+ *      MapDefinition.blockRowOffsets (ROM)
+ *  \param chunkRowSft
+ *      number of block row per chunk (shift)
+ *  \param hp
+ *      map height in block removing duplicated rows
+ *  \param rowSize
+ *      size of a block index row in byte
+ *  \param slotSize
+ *      size of a cache slot in block index unit
+ *  \param tick
+ *      access counter (used for LRU slot eviction)
+ *  \param slotChunk
+ *      chunk index cached in each slot (0xFFFF = empty)
+ *  \param slotTick
+ *      last access tick of each slot
+ *  \param data
+ *      slot buffers (unpacked block indexes)
+ */
+typedef struct
+{
+    const u32* chunkInfo;
+    const u16* srcRowOffsets;
+    u16 chunkRowSft;
+    u16 hp;
+    u16 rowSize;
+    u16 slotSize;
+    u16 tick;
+    u16 slotChunk[MAP_STREAMING_SLOT];
+    u16 slotTick[MAP_STREAMING_SLOT];
+    void* data;
+} MapStream;
+
+/**
+ *  \brief
+ *      Size of #MapStream structure in byte (rescomp uses it to estimate streamed map memory usage, keep it in sync with the structure)
+ */
+#define MAP_STREAM_SIZE             ((2 * 4) + (5 * 2) + (MAP_STREAMING_SLOT * 2 * 2) + 4)
+
 /**
  *  \brief
  *      Map structure containing information for large background/plane update based on #MapDefinition
@@ -137,7 +199,7 @@ typedef struct
  *  \param blockIndexes
  *      internal - unpacked data of MapDefinition.blockIndexes
  *  \param blockRowOffsets
- *      internal - direct access of MapDefinition.blockRowOffsets
+ *      internal - direct access of MapDefinition.blockRowOffsets (or cache relative offsets for streamed map)
  *  \param plane
  *      VDP plane where MAP is draw
  *  \param baseTile
@@ -174,6 +236,8 @@ typedef struct
  *      internal
  *  \param getMetaTilemapRectCB
  *      internal
+ *  \param stream
+ *      internal - block indexes chunk cache (NULL if map isn't streamed)
  */
 typedef struct Map
 {
@@ -204,6 +268,7 @@ typedef struct Map
     MapDataPatchCallback* mapDataPatchCB;
     u16  (*getMetaTileCB)(Map *map, u16 x, u16 y);
     void (*getMetaTilemapRectCB)(Map *map, u16 x, u16 y, u16 w, u16 h, u16* dest);
+    MapStream* stream;
 } Map;
 
 
@@ -211,7 +276,9 @@ typedef struct Map
  *  \brief
  *      Create and return a Map structure required to use all MAP_xxx functions
  *      from a given MapDefinition.<br>
- *      When you're done with the map you shall use MAP_release(map) to release it.
+ *      When you're done with the map you shall use MAP_release(map) to release it.<br>
+ *      For streamed map (MAP_STREAMING) only a small block indexes cache is allocated, chunks are unpacked on demand
+ *      by MAP_scrollTo(..) and MAP_getXXX(..) methods.
  *
  *  \param mapDef
  *      MapDefinition structure containing background/plane data.
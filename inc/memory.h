@@ -141,6 +141,42 @@
 #endif  // ENABLE_NEWLIB
 
 
+/**
+ *  \brief
+ *      First fit allocation mode (default).<br>
+ *      All blocks are allocated with a first fit search over the heap blocks chain.
+ */
+#define MEM_ALLOC_FIRST_FIT     0
+/**
+ *  \brief
+ *      Size class allocation mode.<br>
+ *      Small blocks (up to 126 bytes) are rounded to 4 bytes and released blocks are kept in per size free lists
+ *      so they can be reused in constant time, first fit search is only used for large blocks.
+ */
+#define MEM_ALLOC_SIZE_CLASS    1
+
+
+/**
+ *  \brief
+ *      Set memory allocation mode.
+ *
+ *  \param mode
+ *      Allocation mode, accepted values are:<br>
+ *      #MEM_ALLOC_FIRST_FIT<br>
+ *      #MEM_ALLOC_SIZE_CLASS
+ *
+ * Size class mode greatly reduce allocation and release time when you do many small allocations (sprites, pools...)
+ * at the cost of a bit of memory (small blocks rounding).<br>
+ * Cached small blocks are automatically released when a large allocation fails, when #MEM_pack() is called
+ * or when you switch back to first fit mode.
+ */
+void MEM_setAllocMode(u16 mode);
+/**
+ *  \brief
+ *      Return current memory allocation mode (see #MEM_setAllocMode(..))
+ */
+u16  MEM_getAllocMode(void);
+
 /**
  *  \brief
  *      Return available memory in bytes
@@ -153,7 +189,7 @@ u16  MEM_getFree(void);
 u16  MEM_getAllocated(void);
 /**
  *  \brief
- *      Return largest free memory block in bytes
+ *      Return largest free memory block in bytes (small blocks cached by #MEM_ALLOC_SIZE_CLASS mode are not considered)
  */
 u16  MEM_getLargestFreeBlock(void);
 
@@ -202,6 +238,52 @@ void* MEM_alloc(u16 size);
  */
  void* MEM_allocAt(u32 addr, u16 size);
 
+/**
+ *  \brief
+ *      Allocate memory block from the frame arena
+ *
+ *  \param size
+ *      Number of bytes to allocate
+ *  \return
+ *      On success, a pointer to the allocated memory block (2 bytes aligned).<br>
+ *      If the frame arena doesn't have enough space left, a <i>NULL</i> pointer is returned.
+ *
+ * The frame arena is a linear memory region of #FRAME_ARENA_SIZE bytes reserved at MEM_init() time.<br>
+ * Allocation is a simple pointer increment (no fragmentation) and you never release blocks individually:
+ * the whole arena is released by #MEM_resetFrame() which is automatically called by SYS_doVBlankProcess()
+ * (after the DMA queue has been flushed, and only once transfers delayed by the DMA "carry over capacity" strategy don't use it anymore).<br>
+ * Use it for temporary data living only during the current frame (collision lists, sort buffers, tilemap rows to upload...).
+ */
+void* MEM_allocFrame(u16 size);
+/**
+ *  \brief
+ *      Release all frame arena allocations.
+ *
+ * Automatically called by SYS_doVBlankProcess(), you only need to call it when you don't use SYS_doVBlankProcess().
+ */
+void MEM_resetFrame(void);
+/**
+ *  \brief
+ *      Return frame arena size in bytes (#FRAME_ARENA_SIZE)
+ */
+u16  MEM_getFrameSize(void);
+/**
+ *  \brief
+ *      Return memory currently allocated from the frame arena in bytes
+ */
+u16  MEM_getFrameUsed(void);
+/**
+ *  \brief
+ *      Return maximum memory allocated from the frame arena (high water mark) in bytes.<br>
+ *      Useful to tune #FRAME_ARENA_SIZE.
+ */
+u16  MEM_getFrameHighWater(void);
+/**
+ *  \brief
+ *      Reset frame arena high water mark to current frame arena usage.
+ */
+void MEM_resetFrameHighWater(void);
+
 /**
  *  \brief
  *      Pack all free blocks and reset allocation search from start of heap.<br>
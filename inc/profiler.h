@@ -0,0 +1,226 @@
+/**
+ *  \file profiler.h
+ *  \brief CPU profiling zones
+ *  \author Stephane Dallongeville
+ *  \date 10/2026
+ *
+ * This unit provides methods to measure where the CPU frame time is spent.<br>
+ * <br>
+ * A profiling zone is a named piece of code enclosed by #PROF_BEGIN(..) / #PROF_END(..):<pre>
+ * u16 aiZone = PROF_addZone("ai");
+ * ...
+ * PROF_BEGIN(aiZone);
+ * updateEnemies();
+ * PROF_END(aiZone);
+ * </pre>
+ * Time is measured from the VDP HV counter so it has sub scanline precision (1 unit = 1 H counter step,
+ * see #PROF_getLineLength()). Each completed zone is recorded in a RAM ring buffer and aggregated per frame (count, total and max time).<br>
+ * Frame aggregation is done by #PROF_frame() which is automatically called by SYS_doVBlankProcess(), you can then dump results
+ * of last frame in the KDebug console with #PROF_dump().<br>
+ * Some library zones are always defined: DMA queue flush, sprite engine update and MAP update.<br>
+ * <br>
+ * Profiling is only available when ENABLE_PROFILER is set to 1 in config.h, otherwise #PROF_BEGIN(..) / #PROF_END(..) macros produce no code.<br>
+ * Note that the V counter rollback during vertical blank makes a few scanlines ambiguous, they are resolved from previous timestamp
+ * so a zone starting and ending inside the V blank period may rarely be a few scanlines off.
+ * Profiling doesn't work when HV counter latching is enabled.
+ */
+
+#ifndef _PROFILER_H_
+#define _PROFILER_H_
+
+
+/**
+ *  \brief
+ *      Maximum number of profiling zones
+ */
+#define PROF_MAX_ZONE           32
+/**
+ *  \brief
+ *      Number of entries in the profiling ring buffer (must be a power of 2)
+ */
+#define PROF_EVENT_NUM          128
+
+/**
+ *  \brief
+ *      DMA queue flush zone (library)
+ */
+#define PROF_ZONE_DMA           0
+/**
+ *  \brief
+ *      Sprite engine update zone (library)
+ */
+#define PROF_ZONE_SPRITE        1
+/**
+ *  \brief
+ *      MAP update zone (library)
+ */
+#define PROF_ZONE_MAP           2
+/**
+ *  \brief
+ *      First zone available for user
+ */
+#define PROF_ZONE_USER          3
+
+
+#if (ENABLE_PROFILER != 0)
+
+/**
+ *  \brief
+ *      Start profiling zone (no code generated if profiler is disabled)
+ */
+#define PROF_BEGIN(zone)        PROF_begin(zone)
+/**
+ *  \brief
+ *      End profiling zone (no code generated if profiler is disabled)
+ */
+#define PROF_END(zone)          PROF_end(zone)
+
+#else
+
+#define PROF_BEGIN(zone)
+#define PROF_END(zone)
+
+#endif  // ENABLE_PROFILER
+
+
+/**
+ *  \brief
+ *      Profiling ring buffer entry
+ *
+ *  \param zone
+ *      zone index
+ *  \param frame
+ *      frame number (low 16 bits of vtimer)
+ *  \param start
+ *      zone start timestamp (see #PROF_getStamp())
+ *  \param duration
+ *      zone duration
+ */
+typedef struct
+{
+    u16 zone;
+    u16 frame;
+    u32 start;
+    u32 duration;
+} ProfEvent;
+
+/**
+ *  \brief
+ *      Profiling zone statistics
+ *
+ *  \param name
+ *      zone name
+ *  \param start
+ *      start timestamp of current opened zone
+ *  \param count
+ *      number of completed zone in current frame
+ *  \param total
+ *      total time of current frame
+ *  \param max
+ *      max time of current frame
+ *  \param lastCount
+ *      number of completed zone in last frame
+ *  \param lastTotal
+ *      total time of last frame
+ *  \param lastMax
+ *      max time of last frame
+ *  \param peak
+ *      max time since #PROF_reset()
+ */
+typedef struct
+{
+    const char* name;
+    u32 start;
+    u16 count;
+    u16 lastCount;
+    u32 total;
+    u32 max;
+    u32 lastTotal;
+    u32 lastMax;
+    u32 peak;
+} ProfZone;
+
+
+#if (ENABLE_PROFILER != 0)
+
+/**
+ *  \brief
+ *      Initialize profiler (automatically done at system init).
+ *
+ * Remove all user zones and reset statistics.
+ */
+void PROF_init(void);
+/**
+ *  \brief
+ *      Reset all zones statistics and clear the ring buffer.
+ */
+void PROF_reset(void);
+
+/**
+ *  \brief
+ *      Add a new profiling zone.
+ *
+ *  \param name
+ *      Zone name (used for dump so it should not contain any ';' character)
+ *  \return
+ *      Zone index or -1 if no more zone is available (see #PROF_MAX_ZONE)
+ */
+s16  PROF_addZone(const char* name);
+/**
+ *  \brief
+ *      Return zone statistics structure (read only).
+ */
+const ProfZone* PROF_getZone(u16 zone);
+
+/**
+ *  \brief
+ *      Start a profiling zone, you should use #PROF_BEGIN(..) macro instead.
+ */
+void PROF_begin(u16 zone);
+/**
+ *  \brief
+ *      End a profiling zone, you should use #PROF_END(..) macro instead.
+ */
+void PROF_end(u16 zone);
+
+/**
+ *  \brief
+ *      Return current timestamp in H counter units from HV counter (monotonic, wrap on 32 bits).
+ */
+u32  PROF_getStamp(void);
+/**
+ *  \brief
+ *      Return number of timestamp units per scanline for current display mode (211 in H40, 171 in H32).
+ */
+u16  PROF_getLineLength(void);
+
+/**
+ *  \brief
+ *      Aggregate statistics for the frame: current frame statistics become the last frame statistics.
+ *
+ * Automatically called by SYS_doVBlankProcess().
+ */
+void PROF_frame(void);
+
+/**
+ *  \brief
+ *      Dump last frame statistics in the KDebug console.
+ *
+ * Output is one line per zone having some activity, semicolon separated:<br>
+ * <code>PROF;frame;zone;count;total;max;peak</code><br>
+ * preceded by a header line giving the time unit:<br>
+ * <code>PROF_HDR;frame;line_length;lines_per_frame</code>
+ */
+void PROF_dump(void);
+/**
+ *  \brief
+ *      Dump the profiling ring buffer content (oldest first) in the KDebug console.
+ *
+ * Output is one line per recorded zone, semicolon separated:<br>
+ * <code>PROF_EVT;frame;zone;start;duration</code>
+ */
+void PROF_dumpEvents(void);
+
+#endif  // ENABLE_PROFILER
+
+#endif // _PROFILER_H_
@@ -20,6 +20,15 @@
 #include "pool.h"
 
 
+/**
+ *  \brief
+ *      Sprite resource (SpriteDefinition) binary format version.<br>
+ *      rescomp stores it in SpriteDefinition.format and generated headers check it so resources built for a newer SGDK version fail to compile.<br>
+ *      Resources built by an older rescomp have format = 0 and are still supported.<br>
+ *      2: added tile deltas to Animation (Animation.deltas only exists when SpriteDefinition.format >= 2)
+ */
+#define SPR_RES_FORMAT          2
+
 /**
  *  \brief
  *      No collision type
@@ -78,12 +87,26 @@
  *      hardware sprite. This result in faster visibility computation at the expense of using extra (wasting) hardware sprites.
  */
 #define SPR_FLAG_FAST_AUTO_VISIBILITY           0x0100
+/**
+ *  \brief
+ *      Enable shared VRAM allocation (replace #SPR_FLAG_AUTO_VRAM_ALLOC and imply #SPR_FLAG_AUTO_TILE_UPLOAD).<br>
+ *      Instead of allocating VRAM for its biggest frame, the sprite only allocates VRAM for its current frame tileset and this
+ *      allocation is shared (reference counted) with all others shared sprites displaying a frame using the same tileset.
+ *      Tiles of a shared frame tileset are uploaded only once, when the first sprite starts to use it.
+ */
+#define SPR_FLAG_SHARED_VRAM                    0x0080
+/**
+ *  \brief
+ *      Sprite is never dropped by the sprite multiplexing (only meaningful if multiplexing is enabled, see #SPR_enableMultiplexing()).<br>
+ *      Use it for important sprites as player or bullets.
+ */
+#define SPR_FLAG_MULTIPLEX_PRIORITY             0x0040
 
 /**
  *  \brief
  *      Mask for sprite flag
  */
-#define SPR_FLAG_MASK                           (SPR_FLAG_INSERT_HEAD | SPR_FLAG_DISABLE_DELAYED_FRAME_UPDATE | SPR_FLAG_AUTO_VRAM_ALLOC | SPR_FLAG_AUTO_TILE_UPLOAD | SPR_FLAG_AUTO_VISIBILITY | SPR_FLAG_FAST_AUTO_VISIBILITY)
+#define SPR_FLAG_MASK                           (SPR_FLAG_INSERT_HEAD | SPR_FLAG_DISABLE_DELAYED_FRAME_UPDATE | SPR_FLAG_AUTO_VRAM_ALLOC | SPR_FLAG_AUTO_TILE_UPLOAD | SPR_FLAG_AUTO_VISIBILITY | SPR_FLAG_FAST_AUTO_VISIBILITY | SPR_FLAG_SHARED_VRAM | SPR_FLAG_MULTIPLEX_PRIORITY)
 
 /**
  *  \brief
@@ -235,6 +258,27 @@ typedef struct
     FrameVDPSprite frameVDPSprites[];
 } AnimationFrame;
 
+/**
+ *  \brief
+ *      Animation frame tile delta structure: tiles to upload when a frame is reached from the previous frame of the animation sequence.
+ *
+ *  \param from
+ *      previous animation frame, delta can be used only if tiles of this frame are in VRAM
+ *  \param numTile
+ *      total number of tile to upload
+ *  \param numRange
+ *      number of tile range to upload
+ *  \param ranges
+ *      tile ranges to upload (first tile index and number of tile in frame tileset)
+ */
+typedef struct
+{
+    const AnimationFrame* from;
+    u16 numTile;
+    u16 numRange;
+    u16 ranges[];
+} FrameTileDelta;
+
 /**
  *  \brief
  *      Sprite animation structure.
@@ -245,12 +289,16 @@ typedef struct
  *      frame index for loop (last index if no loop)
  *  \param frames
  *      frames composing the animation
+ *  \param deltas
+ *      tile delta for each frame (NULL if frame doesn't have delta), can be NULL if animation doesn't have any delta.<br>
+ *      Only present when SpriteDefinition.format >= 2, never access it otherwise
  */
 typedef struct
 {
     u8 numFrame;
     u8 loop;
     AnimationFrame** frames;
+    FrameTileDelta** deltas;
 } Animation;
 
 /**
@@ -269,6 +317,8 @@ typedef struct
  *      animation definitions
  *  \param maxNumTile
  *      maximum number of tile used by a single animation frame (used for VRAM tile space allocation)
+ *  \param format
+ *      resource format (see #SPR_RES_FORMAT), 0 for resources built before format versioning
  *  \param maxNumSprite
  *      maximum number of VDP sprite used by a single animation frame (used for VDP sprite allocation)
  *
@@ -282,7 +332,8 @@ typedef struct
     u16 numAnimation;
     Animation** animations;
     u16 maxNumTile;
-    u16 maxNumSprite;
+    u8 format;
+    u8 maxNumSprite;
 } SpriteDefinition;
 
 /**
@@ -294,6 +345,8 @@ typedef struct
  *      Internal state and automatic allocation information (internal)
  *  \param visibility
  *      visibility information of current frame for each VDP sprite (max = 16)
+ *  \param uploadVisibility
+ *      VDP sprites (same format as visibility) of current frame having their tiles already uploaded to VRAM (internal)
  *  \param spriteDef
  *      Sprite definition pointer
  *  \param onFrameChange
@@ -329,6 +382,7 @@ typedef struct Sprite
 {
     u16 status;
     u16 visibility;
+    u16 uploadVisibility;
     const SpriteDefinition* definition;
     void (*onFrameChange)(struct Sprite* sprite);
     Animation* animation;
@@ -450,6 +504,10 @@ void SPR_reset(void);
  *          If you don't set this flag you will have to manually define VRAM tile index position for this sprite with the <i>attribut</i> parameter or by using the #SPR_setVRAMTileIndex(..) method<br>
  *      #SPR_FLAG_AUTO_TILE_UPLOAD = Enable automatic upload of sprite tiles data into VRAM (enabled by default)<br>
  *          If you don't set this flag you will have to manually upload tiles data of sprite into the VRAM (you can change this setting using #SPR_setAutoTileUpload(..) method).<br>
+ *      #SPR_FLAG_SHARED_VRAM = Enable shared VRAM allocation (replace #SPR_FLAG_AUTO_VRAM_ALLOC)<br>
+ *          VRAM is allocated per frame tileset and shared between all sprites using this flag and displaying a frame with the same tileset,
+ *          tiles are uploaded only once per tileset. Useful when many sprites use the same definition (enemies, bullets...).<br>
+ *      #SPR_FLAG_MULTIPLEX_PRIORITY = Sprite is never dropped by sprite multiplexing (see #SPR_enableMultiplexing())<br>
  *      #SPR_FLAG_INSERT_HEAD = Allow to insert the sprite at the start/head of the list.<br>
  *          When you use this flag the sprite will be inserted at the head of the list making it top most (equivalent to #SPR_setDepth(#SPR_MIN_DEPTH))<br>
  *          while default insertion position is at the end of the list (equivalent to #SPR_setDepth(#SPR_MAX_DEPTH))<br>
@@ -520,6 +578,10 @@ Sprite* SPR_addSprite(const SpriteDefinition* spriteDef, s16 x, s16 y, u16 attri
  *          If you don't set this flag you will have to manually define VRAM tile index position for this sprite with the <i>attribut</i> parameter or by using the #SPR_setVRAMTileIndex(..) method<br>
  *      #SPR_FLAG_AUTO_TILE_UPLOAD = Enable automatic upload of sprite tiles data into VRAM (enabled by default)<br>
  *          If you don't set this flag you will have to manually upload tiles data of sprite into the VRAM (you can change this setting using #SPR_setAutoTileUpload(..) method).<br>
+ *      #SPR_FLAG_SHARED_VRAM = Enable shared VRAM allocation (replace #SPR_FLAG_AUTO_VRAM_ALLOC)<br>
+ *          VRAM is allocated per frame tileset and shared between all sprites using this flag and displaying a frame with the same tileset,
+ *          tiles are uploaded only once per tileset. Useful when many sprites use the same definition (enemies, bullets...).<br>
+ *      #SPR_FLAG_MULTIPLEX_PRIORITY = Sprite is never dropped by sprite multiplexing (see #SPR_enableMultiplexing())<br>
  *      #SPR_FLAG_INSERT_HEAD = Allow to insert the sprite at the start/head of the list.<br>
  *          When you use this flag the sprite will be inserted at the head of the list making it top most (equivalent to #SPR_setDepth(#SPR_MIN_DEPTH))<br>
  *          while default insertion position is at the end of the list (equivalent to #SPR_setDepth(#SPR_MAX_DEPTH))<br>
@@ -614,6 +676,72 @@ void SPR_enableVDPSpriteChecking();
  *  \see SPR_getNumVDPSprite(..)
  */
 void SPR_disableVDPSpriteChecking();
+
+/**
+ *  \brief
+ *      Enable sprite multiplexing.<br>
+ *      When the sprites displayed on some scanlines exceed the hardware limits (20 sprites / 320 pixels per scanline in H40, 16 sprites / 256 pixels in H32)
+ *      or when there is more VDP sprites than the hardware can display (80 in H40, 64 in H32), the hardware drops the last sprites in the sprite list order.<br>
+ *      With multiplexing enabled, #SPR_update() measures scanlines usage and when an overflow is detected, it rotates the display order of sprites
+ *      on each frame so dropouts are spread on all sprites (flickering) instead of always hiding the same sprites.<br>
+ *      Sprites using #SPR_FLAG_MULTIPLEX_PRIORITY are always displayed first so they are never dropped.<br>
+ *      Note that scanlines usage is measured by group of 8 scanlines (conservative), display order between non priority sprites is not preserved
+ *      when overflow occurs and the first hardware sprite is reserved (as list head) when multiplexing is enabled.
+ *
+ *      Multiplexing is disabled by #SPR_end().
+ *
+ *  \return FALSE if there is not enough memory to enable multiplexing or if sprite engine isn't initialized.
+ *
+ *  \see SPR_disableMultiplexing()
+ *  \see SPR_setMultiplexPriority(..)
+ *  \see SPR_getOverflowSprites()
+ */
+bool SPR_enableMultiplexing(void);
+/**
+ *  \brief
+ *      Disable sprite multiplexing (default).
+ *
+ *  \see SPR_enableMultiplexing()
+ */
+void SPR_disableMultiplexing(void);
+/**
+ *  \brief
+ *      Return the number of hardware sprites exceeding the hardware limits on the worst scanline (or exceeding total number of hardware sprites)
+ *      during last #SPR_update() (0 = no overflow).<br>
+ *      Only computed when multiplexing is enabled.
+ *
+ *  \see SPR_enableMultiplexing()
+ *  \see SPR_getOverflowScanlines()
+ */
+u16 SPR_getOverflowSprites(void);
+/**
+ *  \brief
+ *      Return the number of scanlines exceeding the hardware sprite limits during last #SPR_update() (by group of 8 scanlines).<br>
+ *      Only computed when multiplexing is enabled.
+ *
+ *  \see SPR_enableMultiplexing()
+ *  \see SPR_getOverflowSprites()
+ */
+u16 SPR_getOverflowScanlines(void);
+/**
+ *  \brief
+ *      Enable deferred depth sorting.<br>
+ *      #SPR_setDepth(..) only stores the new depth value and the whole sprite list is sorted once (bucket sort) on next #SPR_update().<br>
+ *      Ordering is the same as immediate sorting (sprites with same depth keep their relative order) but it's much faster
+ *      when many sprites change their depth every frame (Y sorting for instance).<br>
+ *      Note that sprite list order is only valid after #SPR_update() when this mode is enabled.
+ *
+ *  \see SPR_disableDeferredSorting()
+ *  \see SPR_setDepth(..)
+ */
+void SPR_enableDeferredSorting(void);
+/**
+ *  \brief
+ *      Disable deferred depth sorting, sprite is immediately sorted when its depth is changed (default).
+ *
+ *  \see SPR_enableDeferredSorting()
+ */
+void SPR_disableDeferredSorting(void);
 /**
  *  \brief
  *      Defragment allocated VRAM for sprites, that can help when sprite allocation fail (SPR_addSprite(..) or SPR_addSpriteEx(..) return <i>NULL</i>).
@@ -817,7 +945,10 @@ void SPR_setPriority(Sprite* sprite, bool value);
  *      The depth value (SPR_MIN_DEPTH to set always on top)
  *
  *  Sprite having lower depth are display in front of sprite with higher depth.<br>
- *  The sprite is *immediately* sorted when its depth value is changed.
+ *  The sprite is *immediately* sorted when its depth value is changed, unless deferred sorting is enabled
+ *  in which case the whole sprite list is sorted on next #SPR_update() call.
+ *
+ *  \see SPR_enableDeferredSorting()
  */
 void SPR_setDepth(Sprite* sprite, s16 value);
 /**
@@ -967,6 +1098,19 @@ void SPR_setAutoTileUpload(Sprite* sprite, bool value);
  *  \see #SPR_FLAG_DISABLE_DELAYED_FRAME_UPDATE
  */
 void SPR_setDelayedFrameUpdate(Sprite* sprite, bool value);
+/**
+ *  \brief
+ *      Set the multiplexing priority for this sprite.
+ *
+ *  \param sprite
+ *      Sprite we want to set the multiplexing priority.
+ *  \param value
+ *      TRUE = sprite is never dropped by sprite multiplexing (displayed first), FALSE = sprite can be dropped when scanlines overflow (default).
+ *
+ *  \see SPR_FLAG_MULTIPLEX_PRIORITY
+ *  \see SPR_enableMultiplexing()
+ */
+void SPR_setMultiplexPriority(Sprite* sprite, bool value);
 /**
  *  \brief
  *      Set the frame change event callback for this sprite.
@@ -20,6 +20,15 @@
 #include "pool.h"
 
 
+/**
+ *  \brief
+ *      Sprite resource (SpriteDefinition) binary format version (legacy engine ignores the animation tile deltas).<br>
+ *      rescomp stores it in SpriteDefinition.format and generated headers check it so resources built for a newer SGDK version fail to compile.<br>
+ *      Resources built by an older rescomp have format = 0 and are still supported.<br>
+ *      2: added tile deltas to Animation (Animation.deltas only exists when SpriteDefinition.format >= 2)
+ */
+#define SPR_RES_FORMAT          2
+
 /**
  *  \brief
  *      No collision type
@@ -274,6 +283,8 @@ typedef struct
  *      animation definitions
  *  \param maxNumTile
  *      maximum number of tile used by a single animation frame (used for VRAM tile space allocation)
+ *  \param format
+ *      resource format (see #SPR_RES_FORMAT), 0 for resources built before format versioning
  *  \param maxNumSprite
  *      maximum number of VDP sprite used by a single animation frame (used for VDP sprite allocation)
  *
@@ -287,7 +298,8 @@ typedef struct
     u16 numAnimation;
     Animation** animations;
     u16 maxNumTile;
-    u16 maxNumSprite;
+    u8 format;
+    u8 maxNumSprite;
 } SpriteDefinition;
 
 /**
@@ -7,6 +7,7 @@
 // forward
 static u16 doAlloc(u16 num, u16 size, void **allocs, u16 verif);
 static u16 doRelease(u16 num, u16 size, void **allocs, u16 verif);
+static u32 doFragmentedAllocRelease(u16 num, u16 cycles, void **allocs);
 static u16 doVRamAlloc(VRAMRegion *region, u16 num, u16 size, s16 *allocs, u16 verif);
 static u16 doVRamRelease(VRAMRegion *region, u16 num, u16 size, s16 *allocs, u16 verif);
 static u32 displayResult(u32 bytes, fix32 time, u16 y);
@@ -223,6 +224,7 @@ u16 executeMemAllocTest(u16 *scores)
     fix32 start;
     fix32 end;
     fix32 time;
+    u32 nb;
     u16 i, y;
     void **allocs;
     u16 *score;
@@ -385,6 +387,36 @@ u16 executeMemAllocTest(u16 *scores)
     waitMs(5000);
     VDP_clearPlane(BG_A, TRUE);
 
+    y = 0;
+    VDP_drawText("Executing mem fragmentation tests...", 1, y++);
+    y++;
+
+    VDP_drawText("Fragmented alloc/release (first fit)", 2, y++);
+    MEM_setAllocMode(MEM_ALLOC_FIRST_FIT);
+    start = getTimeAsFix32(FALSE);
+    nb = doFragmentedAllocRelease(400, 20, allocs);
+    end = getTimeAsFix32(FALSE);
+    // not added to global score so it stays comparable with previous versions
+    *score++ = displayResultAlloc(nb, end - start, y++);
+    y++;
+
+    VDP_drawText("Fragmented alloc/release (size class)", 2, y++);
+    MEM_setAllocMode(MEM_ALLOC_SIZE_CLASS);
+    start = getTimeAsFix32(FALSE);
+    nb = doFragmentedAllocRelease(400, 20, allocs);
+    end = getTimeAsFix32(FALSE);
+    *score++ = displayResultAlloc(nb, end - start, y++);
+    y++;
+
+    // back to default mode (release cached blocks)
+    MEM_setAllocMode(MEM_ALLOC_FIRST_FIT);
+
+    if (!MEM_checkIntegrity())
+        VDP_drawText("Memory integrity check failed !", 2, y++);
+
+    waitMs(5000);
+    VDP_clearPlane(BG_A, TRUE);
+
     MEM_free(allocs);
     MEM_pack();
 
@@ -703,6 +735,42 @@ static u16 doRelease(u16 num, u16 size, void **allocs, u16 verif)
     return TRUE;
 }
 
+// mixed block sizes, mostly small ones as sprites or pools allocations
+static const u16 fragSizes[16] = { 8, 16, 24, 12, 32, 200, 48, 16, 64, 10, 400, 20, 96, 40, 120, 6 };
+
+static u32 doFragmentedAllocRelease(u16 num, u16 cycles, void **allocs)
+{
+    u32 ops;
+    u16 i, c;
+
+    // fill heap with mixed size blocks
+    for(i = 0; i < num; i++)
+        allocs[i] = MEM_alloc(fragSizes[i & 15]);
+    ops = num;
+
+    // release one block on two so heap is fragmented
+    for(i = 0; i < num; i += 2)
+        MEM_free(allocs[i]);
+    ops += num / 2;
+
+    // alloc / release cycles in fragmented heap (size changes on each cycle)
+    for(c = 0; c < cycles; c++)
+    {
+        for(i = 0; i < num; i += 2)
+            allocs[i] = MEM_alloc(fragSizes[(i + c) & 15]);
+        for(i = 0; i < num; i += 2)
+            MEM_free(allocs[i]);
+        ops += num;
+    }
+
+    // release remaining blocks
+    for(i = 1; i < num; i += 2)
+        MEM_free(allocs[i]);
+    ops += num / 2;
+
+    return ops;
+}
+
 
 static u16 doVRamAlloc(VRAMRegion *region, u16 num, u16 size, s16 *allocs, u16 verif)
 {
@@ -17,6 +17,10 @@ static u16 executePartic(u16 time, u16 numPartic, u16 preloadedTiles, u16 reallo
 static void updateDonut(u16 num, u16 preloadedTiles, u16 time);
 static u16 executeDonut(u16 time, u16 preloadedTiles);
 
+static void initYSort(u16 num);
+static void updateYSort(u16 num);
+static u16 executeYSort(u16 time, u16 numSpr);
+
 static void initPos(u16 num);
 static void updatePos(u16 num);
 static void updateAnim(u16 num);
@@ -759,6 +763,85 @@ u16 executeSpritesTest(u16 *scores)
     SPR_logProfil();
 
 
+    SYS_disableInts();
+    // reset sprite engine (release all allocated resources)
+    SPR_reset();
+    SPR_clear();
+    VDP_clearPlane(BG_A, TRUE);
+    VDP_drawText("80 sprites 16x16 Y sorted", 1, 2);
+    SYS_enableInts();
+
+    waitMs(5000);
+    SYS_disableInts();
+    VDP_clearPlane(BG_A, TRUE);
+    SYS_enableInts();
+
+    // initialize sprites
+    for(i = 0; i < 80; i++)
+    {
+        Sprite* spr;
+
+        spr = SPR_addSprite(&flare_small, 0, 0, TILE_ATTR(PAL1, FALSE, FALSE, FALSE));
+        sprites[i] = spr;
+
+        // associate object to sprite
+        spr->data = (u32) &objects[i];
+    }
+
+    // set palette
+    PAL_setPalette(PAL1, flare_small.palette->data, CPU);
+
+    // init positions
+    initYSort(80);
+
+    // execute Y sort bench (sprite is sorted on each depth change)
+    *scores = executeYSort(15, 80) * 1;
+    globalScore += *scores++;
+    SPR_logProfil();
+
+#if !LEGACY_SPRITE_ENGINE
+    SYS_disableInts();
+    // reset sprite engine (release all allocated resources)
+    SPR_reset();
+    SPR_clear();
+    VDP_clearPlane(BG_A, TRUE);
+    VDP_drawText("80 sprites 16x16 Y sorted (deferred sort)", 1, 2);
+    SYS_enableInts();
+
+    waitMs(5000);
+    SYS_disableInts();
+    VDP_clearPlane(BG_A, TRUE);
+    SYS_enableInts();
+
+    // sprite list is sorted once per SPR_update()
+    SPR_enableDeferredSorting();
+
+    // initialize sprites
+    for(i = 0; i < 80; i++)
+    {
+        Sprite* spr;
+
+        spr = SPR_addSprite(&flare_small, 0, 0, TILE_ATTR(PAL1, FALSE, FALSE, FALSE));
+        sprites[i] = spr;
+
+        // associate object to sprite
+        spr->data = (u32) &objects[i];
+    }
+
+    // set palette
+    PAL_setPalette(PAL1, flare_small.palette->data, CPU);
+
+    // init positions
+    initYSort(80);
+
+    // execute Y sort bench
+    *scores = executeYSort(15, 80) * 1;
+    globalScore += *scores++;
+    SPR_logProfil();
+
+    SPR_disableDeferredSorting();
+#endif // LEGACY_SPRITE_ENGINE
+
     SYS_disableInts();
     // reset sprite engine (release all allocated resources)
     SPR_reset();
@@ -1201,6 +1284,99 @@ static u16 executeDonut(u16 time, u16 preloadedTiles)
     return freeCpuTime >> 8;
 }
 
+static void initYSort(u16 num)
+{
+    Sprite** sprite;
+    u16 i;
+
+    i = num;
+    sprite = sprites;
+    while(i--)
+    {
+        Sprite* s = *sprite;
+        MovingObject* o = (MovingObject*) s->data;
+
+        o->pos.x = FIX16(8 + (random() % (VDP_getScreenWidth() - 32)));
+        o->pos.y = FIX16(random() % (VDP_getScreenHeight() - 16));
+        o->mov.x = 0;
+        o->mov.y = FIX16(2) - (random() & (FIX16_FRAC_MASK << 2));
+        o->timer = random() & 0x1F;
+
+        sprite++;
+    }
+}
+
+static void updateYSort(u16 num)
+{
+    Sprite** sprite;
+    fix16 maxy;
+    u16 i;
+
+    maxy = FIX16(VDP_getScreenHeight() - 16);
+
+    i = num;
+    sprite = sprites;
+    while(i--)
+    {
+        Sprite* s = *sprite;
+        MovingObject* o = (MovingObject*) s->data;
+
+        // randomly change direction / speed
+        if (o->timer-- == 0)
+        {
+            o->mov.y = FIX16(2) - (random() & (FIX16_FRAC_MASK << 2));
+            o->timer = random() & 0x1F;
+        }
+
+        o->pos.y += o->mov.y;
+        if ((o->pos.y < 0) || (o->pos.y > maxy))
+        {
+            o->mov.y = -o->mov.y;
+            o->pos.y += o->mov.y;
+        }
+
+        // set sprite position
+        SPR_setPosition(s, F16_toInt(o->pos.x), F16_toInt(o->pos.y));
+        // Y sorting (lower sprite is in front)
+        SPR_setDepth(s, -F16_toInt(o->pos.y));
+
+        sprite++;
+    }
+}
+
+static u16 executeYSort(u16 time, u16 numSpr)
+{
+    u32 startTime;
+    u32 endTime;
+    u32 freeCpuTime;
+    u16 cpuLoad;
+
+    startTime = getTime(TRUE);
+    endTime = startTime + (time << 8);
+    freeCpuTime = 0;
+
+    do
+    {
+        updateYSort(numSpr);
+        // update sprites
+        SPR_update();
+
+        VDP_showFPS(FALSE, 1, 1);
+        VDP_showCPULoad(1, 2);
+        SYS_doVBlankProcess();
+        cpuLoad = SYS_getCPULoad();
+
+        // 100 + (0-100)
+        if (cpuLoad < 100) freeCpuTime += 100 + (100 - cpuLoad);
+        // 50 + (0-50)
+        else if (cpuLoad < 200) freeCpuTime += 50 + ((200 - cpuLoad) >> 1);
+        // (0-50)
+        else if (cpuLoad < 300) freeCpuTime += (300 - cpuLoad) >> 1;
+    } while(getTime(TRUE) < endTime);
+
+    return freeCpuTime >> 8;
+}
+
 static void initPos(u16 num)
 {
     Sprite** sprite;
@@ -46,6 +46,9 @@
 #define NTSC_TILES_BW           7
 #define PAL_TILES_BW            10
 
+#define ALL_ROWS                ((1UL << BMP_TILE_HEIGHT) - 1)
+#define ROW_BIT(y)              (1UL << ((y) >> BMP_YPIXPERTILE_SFT))
+
 
 // we don't want to share them
 extern vu16 VBlankProcess;
@@ -60,12 +63,21 @@ static u8 *bmp_buffer_1;
 VDPPlane bmp_plan;
 u16 *bmp_plane_addr;
 
+// write buffer tile rows state (bit n = tile row n), also updated from assembly methods
+// [0] = rows modified since buffer was last sent to VRAM
+// [1] = rows which may contain non zero pixels
+u32 bmp_write_rows[2];
+
 // internals
 static u16 flag;
 static u16 pal;
 static u16 prio;
 static vu16 state;
 static vs16 phase;
+// read buffer tile rows state (same layout as bmp_write_rows)
+static u32 bmp_read_rows[2];
+// tile rows remaining to blit (bit 0 = tile row at blit position)
+static u32 blit_rows;
 
 
 // ASM methods
@@ -207,6 +219,13 @@ NO_INLINE void BMP_reset()
     clearBitmapBuffer(bmp_buffer_0);
     clearBitmapBuffer(bmp_buffer_1);
 
+    // buffers and VRAM are all cleared, nothing to blit
+    bmp_write_rows[0] = 0;
+    bmp_write_rows[1] = 0;
+    bmp_read_rows[0] = 0;
+    bmp_read_rows[1] = 0;
+    blit_rows = 0;
+
     // set back vertical scroll to 0
     VDP_setVerticalScroll(bmp_plan, 0);
 
@@ -332,12 +351,35 @@ void BMP_showFPS(u16 float_display, u16 x, u16 y)
 void BMP_clear()
 {
     clearBitmapBuffer(bmp_buffer_write);
+
+    // all non empty rows are now modified and buffer is empty
+    bmp_write_rows[0] |= bmp_write_rows[1];
+    bmp_write_rows[1] = 0;
+}
+
+void BMP_invalidate(u16 y, u16 h)
+{
+    u16 ye;
+
+    if ((y >= BMP_HEIGHT) || (h == 0)) return;
+
+    ye = y + h;
+    if (ye > BMP_HEIGHT) ye = BMP_HEIGHT;
+
+    const u32 rows = ((ROW_BIT(ye - 1) << 1) - 1) & ~(ROW_BIT(y) - 1);
+
+    bmp_write_rows[0] |= rows;
+    bmp_write_rows[1] |= rows;
 }
 
 
 u8* BMP_getWritePointer(u16 x, u16 y)
 {
     const u16 off = (y * BMP_PITCH) + (x >> 1);
+
+    // we don't know how much will be written so consider everything from Y as modified
+    BMP_invalidate(y, BMP_HEIGHT - y);
+
     // return write address
     return bmp_buffer_write + off;
 }
@@ -372,10 +414,14 @@ inline u8 BMP_getPixel(u16 x, u16 y)
 inline void BMP_setPixelFast(u16 x, u16 y, u8 col)
 {
     const u16 off = (y * BMP_PITCH) + (x >> 1);
+    const u32 row = ROW_BIT(y);
     u8* dst = bmp_buffer_write + off;
 
     if (x & 1) *dst = (*dst & 0xF0) | (col & 0x0F);
     else *dst = (*dst & 0x0F) | (col & 0xF0);
+
+    bmp_write_rows[0] |= row;
+    bmp_write_rows[1] |= row;
 }
 
 // inlining allow C functions to perform better than assembly methods
@@ -397,6 +443,10 @@ void BMP_setPixels_V2D_old(const Vect2D_u16 *crd, u8 col, u16 num)
     const u8 cu = col & mu;
     const u8 cd = col & md;
 
+    // pixels can be anywhere
+    bmp_write_rows[0] = ALL_ROWS;
+    bmp_write_rows[1] = ALL_ROWS;
+
     base = bmp_buffer_write;
     v = crd;
     i = num;
@@ -432,6 +482,10 @@ void BMP_setPixelsFast_V2D_old(const Vect2D_u16 *crd, u8 col, u16 num)
     const u8 cu = col & mu;
     const u8 cd = col & md;
 
+    // pixels can be anywhere
+    bmp_write_rows[0] = ALL_ROWS;
+    bmp_write_rows[1] = ALL_ROWS;
+
     base = bmp_buffer_write;
     v = crd;
     i = num;
@@ -461,6 +515,10 @@ void BMP_setPixels_old(const Pixel *pixels, u16 num)
     const u8 mu = 0xF0;
     const u8 md = 0x0F;
 
+    // pixels can be anywhere
+    bmp_write_rows[0] = ALL_ROWS;
+    bmp_write_rows[1] = ALL_ROWS;
+
     base = bmp_buffer_write;
     p = pixels;
     i = num;
@@ -495,6 +553,10 @@ void BMP_setPixelsFast_old(const Pixel *pixels, u16 num)
     const u8 mu = 0xF0;
     const u8 md = 0x0F;
 
+    // pixels can be anywhere
+    bmp_write_rows[0] = ALL_ROWS;
+    bmp_write_rows[1] = ALL_ROWS;
+
     base = bmp_buffer_write;
     p = pixels;
     i = num;
@@ -546,6 +608,9 @@ void BMP_drawLine_old(Line *l)
         else
             step_y = BMP_PITCH;
 
+        if (step_y < 0) BMP_invalidate(y1 - dy, dy + 1);
+        else BMP_invalidate(y1, dy + 1);
+
         drawLine_old(x1, y1, dx, dy, step_x, step_y, l->col);
     }
 }
@@ -1087,7 +1152,9 @@ NO_INLINE void BMP_drawBitmapData(const u8 *image, u16 x, u16 y, u16 w, u16 h, u
 
     // prepare source and destination
     src = image;
-    dst = BMP_getWritePointer(x, y);
+    dst = bmp_buffer_write + (y * BMP_PITCH) + (x >> 1);
+
+    BMP_invalidate(y, adj_h);
 
     while(adj_h--)
     {
@@ -1135,6 +1202,9 @@ NO_INLINE bool BMP_drawBitmapScaled(const Bitmap *bitmap, u16 x, u16 y, u16 w, u
     // get the image height
     bmp_h = bitmap->h;
 
+    u8* dst = bmp_buffer_write + (y * BMP_PITCH) + (x >> 1);
+    BMP_invalidate(y, h);
+
     // compressed bitmap ?
     if (bitmap->compression != COMPRESSION_NONE)
     {
@@ -1142,11 +1212,11 @@ NO_INLINE bool BMP_drawBitmapScaled(const Bitmap *bitmap, u16 x, u16 y, u16 w, u
 
         if (b == NULL) return FALSE;
 
-        BMP_scale(b->image, bmp_wb, bmp_h, bmp_wb, BMP_getWritePointer(x, y), w >> 1, h, BMP_PITCH);
+        BMP_scale(b->image, bmp_wb, bmp_h, bmp_wb, dst, w >> 1, h, BMP_PITCH);
         MEM_free(b);
     }
     else
-        BMP_scale(FAR_SAFE(bitmap->image, mulu(w, h) / 2), bmp_wb, bmp_h, bmp_wb, BMP_getWritePointer(x, y), w >> 1, h, BMP_PITCH);
+        BMP_scale(FAR_SAFE(bitmap->image, mulu(w, h) / 2), bmp_wb, bmp_h, bmp_wb, dst, w >> 1, h, BMP_PITCH);
 
     // load the palette
     if (loadpal)
@@ -1321,6 +1391,8 @@ static void clearVRAMBuffer(u16 index)
 
 static void flipBuffer()
 {
+    u32 modified, used;
+
     if (READ_IS_FB0)
     {
         bmp_buffer_read = bmp_buffer_1;
@@ -1332,9 +1404,25 @@ static void flipBuffer()
         bmp_buffer_write = bmp_buffer_1;
     }
 
+    // swap tile rows state
+    modified = bmp_read_rows[0];
+    used = bmp_read_rows[1];
+    bmp_read_rows[0] = bmp_write_rows[0];
+    bmp_read_rows[1] = bmp_write_rows[1];
+    bmp_write_rows[0] = modified;
+    bmp_write_rows[1] = used;
+
     // we want buffer preservation ?
     if (HAS_BUFFERCOPY)
+    {
         copyBitmapBuffer(bmp_buffer_read, bmp_buffer_write);
+
+        // VRAM buffer of write buffer still contains its previous content
+        if (HAS_DOUBLEBUFFER) bmp_write_rows[0] |= bmp_read_rows[1] | bmp_write_rows[1];
+        // single VRAM buffer will contain read buffer content once blit is done
+        else bmp_write_rows[0] = 0;
+        bmp_write_rows[1] = bmp_read_rows[1];
+    }
 }
 
 static void doFlip()
@@ -1359,6 +1447,10 @@ static void doFlip()
             VDP_setVerticalScroll(bmp_plan, vscr);
         }
 
+        // single VRAM buffer now contains read buffer so write buffer differs on any non empty row
+        if (!HAS_DOUBLEBUFFER && !HAS_BUFFERCOPY)
+            bmp_write_rows[0] |= bmp_write_rows[1] | bmp_read_rows[1];
+
         // get bitmap state
         u16 s = state;
 
@@ -1408,73 +1500,70 @@ static NO_INLINE u16 doBlit()
     vu32 *pldata;
     u32 *src;
     u32 addr_tile;
+    u32 rows;
     u16 i;
 
     VDP_setAutoInc(2);
 
-    src = (u32 *) bmp_buffer_read;
-
-    if (HAS_DOUBLEBUFFER && READ_IS_FB1)
-        addr_tile = BMP_FB1_ADDR;
-    else
-        addr_tile = BMP_FB0_ADDR;
-
-    /* point to vdp ctrl port */
-    plctrl = (u32 *) VDP_CTRL_PORT;
-
-    // previous blit not completed ?
-    if (state & BMP_STAT_BLITTING)
-    {
-        // adjust tile address
-        addr_tile += pos_i * BMP_TILE_WIDTH * 32;
-        // adjust src pointer
-        src += pos_i * (BMP_YPIXPERTILE * (BMP_PITCH / 4));
-
-        // set destination address for tile
-        *plctrl = VDP_WRITE_VRAM_ADDR(addr_tile);
-    }
-    else
+    // previous blit completed ?
+    if (!(state & BMP_STAT_BLITTING))
     {
         // start blit
         state |= BMP_STAT_BLITTING;
         pos_i = 0;
 
-        // set destination address for tile
-        *plctrl = VDP_WRITE_VRAM_ADDR(addr_tile);
+        // only modified tile rows need to be sent
+        blit_rows = bmp_read_rows[0];
+        bmp_read_rows[0] = 0;
     }
 
-    const u16 remain = BMP_TILE_HEIGHT - pos_i;
-
-    if (IS_PAL_SYSTEM)
-    {
-        if (remain < PAL_TILES_BW) i = remain;
-        else i = PAL_TILES_BW;
-    }
+    if (HAS_DOUBLEBUFFER && READ_IS_FB1)
+        addr_tile = BMP_FB1_ADDR;
     else
-    {
-        if (remain < NTSC_TILES_BW) i = remain;
-        else i = NTSC_TILES_BW;
-    }
+        addr_tile = BMP_FB0_ADDR;
+
+    // adjust tile address
+    addr_tile += pos_i * BMP_TILE_WIDTH * 32;
+    // adjust src pointer
+    src = ((u32 *) bmp_buffer_read) + (pos_i * (BMP_YPIXPERTILE * (BMP_PITCH / 4)));
 
-    // save position
-    pos_i += i;
+    if (IS_PAL_SYSTEM) i = PAL_TILES_BW;
+    else i = NTSC_TILES_BW;
 
-    /* point to vdp data port */
+    /* point to vdp port */
+    plctrl = (u32 *) VDP_CTRL_PORT;
     pldata = (u32 *) VDP_DATA_PORT;
 
-    while(i--)
+    rows = blit_rows;
+
+    // only count transferred tile rows
+    while(rows && i)
     {
-        // send it to VRAM
-        TRANSFER8(0)
-        TRANSFER8(1)
-        TRANSFER8(2)
-        TRANSFER8(3)
+        if (rows & 1)
+        {
+            // set destination address for tile
+            *plctrl = VDP_WRITE_VRAM_ADDR(addr_tile);
+
+            // send it to VRAM
+            TRANSFER8(0)
+            TRANSFER8(1)
+            TRANSFER8(2)
+            TRANSFER8(3)
 
+            i--;
+        }
+
+        rows >>= 1;
+        pos_i++;
         src += (8 * BMP_PITCH) / 4;
+        addr_tile += BMP_TILE_WIDTH * 32;
     }
 
+    // save remaining rows
+    blit_rows = rows;
+
     // blit not yet done
-    if (pos_i < BMP_TILE_HEIGHT) return 0;
+    if (rows) return 0;
 
     // blit done
     state &= ~BMP_STAT_BLITTING;
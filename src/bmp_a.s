@@ -130,6 +130,17 @@ func BMP_setPixelFastA
     move.w  10(%sp),%d1                     // d1 = Y
 
 .spf_01:
+    move.w  %d0,%a1                         // save X
+    move.w  %d1,%d0
+    lsr.w   #6,%d0                          // d0 = (Y / 8) / 8 = mask byte index
+    lea     bmp_write_rows+3,%a0
+    sub.w   %d0,%a0                         // a0 = &mask byte (big endian)
+    move.w  %d1,%d0
+    lsr.w   #3,%d0                          // d0 = Y / 8 = tile row (bit number is modulo 8)
+    bset    %d0,(%a0)                       // mark tile row as modified
+    bset    %d0,4(%a0)                      // mark tile row as used
+    move.w  %a1,%d0                         // d0 = X
+
     lsl.w   #7,%d1
     lsr.w   #1,%d0
     jcs     .spf_x_odd
@@ -178,6 +189,8 @@ func BMP_setPixelA
 
 
 func BMP_setPixelsFast_V2D
+    move.l  #0xFFFFF,bmp_write_rows         // all tile rows modified
+    move.l  #0xFFFFF,bmp_write_rows+4
     move.l  4(%sp),%a0                      // a0 = crd
     move.b  11(%sp),%d1                     // d1 = col
     move.w  14(%sp),%d0                     // d0 = num
@@ -231,6 +244,8 @@ func BMP_setPixelsFast_V2D
 
 
 func BMP_setPixels_V2D
+    move.l  #0xFFFFF,bmp_write_rows         // all tile rows modified
+    move.l  #0xFFFFF,bmp_write_rows+4
     move.l  4(%sp),%a0                      // a0 = crd
     move.b  11(%sp),%d1                     // d1 = col
     move.w  14(%sp),%d0                     // d0 = num
@@ -298,6 +313,8 @@ func BMP_setPixels_V2D
 
 
 func BMP_setPixelsFast
+    move.l  #0xFFFFF,bmp_write_rows         // all tile rows modified
+    move.l  #0xFFFFF,bmp_write_rows+4
     move.l  4(%sp),%a0                      // a0 = pixels
     move.w  10(%sp),%d0                     // d0 = num
     subq.w  #1,%d0
@@ -350,6 +367,8 @@ func BMP_setPixelsFast
 
 
 func BMP_setPixels
+    move.l  #0xFFFFF,bmp_write_rows         // all tile rows modified
+    move.l  #0xFFFFF,bmp_write_rows+4
     move.l  4(%sp),%a0                      // a0 = pixels
     move.w  10(%sp),%d0                     // d0 = num
     subq.w  #1,%d0
@@ -576,6 +595,24 @@ func BMP_drawLine
     move.l  44(%sp),%a0     // a0 = &line
     movem.w (%a0)+,%d2-%d6  // d2 = x1, d3 = y1, d4 = x2, d5 = y2, d6 = col
 
+    // mark modified tile rows
+    move.w  %d3,%d0
+    move.w  %d5,%d1
+    cmp.w   %d0,%d1
+    jge     .dl_rows
+    exg     %d0,%d1         // d0 = min Y, d1 = max Y
+
+.dl_rows:
+    lsr.w   #3,%d1
+    moveq   #2,%d7
+    lsl.l   %d1,%d7
+    subq.l  #1,%d7          // d7 = (2 << maxRow) - 1
+    lsr.w   #3,%d0
+    lsr.l   %d0,%d7
+    lsl.l   %d0,%d7         // d7 = rows [minRow..maxRow]
+    or.l    %d7,bmp_write_rows
+    or.l    %d7,bmp_write_rows+4
+
 .dl_start:
     moveq   #1,%d0          // d0 = stepx = 1
     move.w  #128,%d1        // d1 = stepy = BMP_PITCH;
@@ -2945,6 +2982,19 @@ func BMP_drawPolygon
     sub.w %d2,%d6               // d6 = len = maxY - minY
     jlt .dp_end0                // < 0 = nothing to draw --> exit
 
+    move.w %d2,%d0
+    add.w %d6,%d0
+    lsr.w #3,%d0                // d0 = maxRow
+    moveq #2,%d1
+    lsl.l %d0,%d1
+    subq.l #1,%d1               // d1 = (2 << maxRow) - 1
+    move.w %d2,%d0
+    lsr.w #3,%d0                // d0 = minRow
+    lsr.l %d0,%d1
+    lsl.l %d0,%d1               // d1 = rows [minRow..maxRow]
+    or.l %d1,bmp_write_rows     // mark modified tile rows
+    or.l %d1,bmp_write_rows+4
+
     move.b 644+59(%sp),%d1      // d1 = col
 
     move.b %d1,-(%sp)
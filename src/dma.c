@@ -15,6 +15,10 @@
 
 #define DMA_AUTOFLUSH               1
 #define DMA_OVERCAPACITY_IGNORE     2
+#define DMA_OVERCAPACITY_CARRY      4
+
+// scheduled (sent this frame) flag in transfer priority
+#define DMA_PRIO_SCHEDULED          0x80
 
 
 // we don't want to share it
@@ -22,6 +26,8 @@ extern vu16 VBlankProcess;
 
 // DMA queue (initialized on reset)
 DMAOpInfo *dmaQueues;
+// DMA queue transfer priorities (same size than DMA queue, initialized on reset)
+u8* dmaQueuePrios;
 
 // DMA data buffer (initialized on reset)
 u16* dmaDataBuffer;
@@ -31,6 +37,7 @@ static u16* nextDataBuffer;
 static u16 queueSize;
 static u16 maxTransferPerFrame;
 static u16 flag;
+static u8 queuePrio;
 
 // DMA data buffer settings
 static u16 dataBufferSize;
@@ -40,8 +47,22 @@ static u16 queueIndex;
 static u16 queueIndexLimit;
 static u16 queueTransferSize;
 
+// carried transfers are using frame arena data (frame arena can't be released)
+static bool frameArenaCarried;
+
+// last queued transfer info (used to merge contiguous transfers)
+static bool canMerge;
+static u8 mergeLocation;
+static u16 mergeStep;
+static u32 mergeFrom;
+static u32 mergeTo;
+static u32 mergedCount;
+
 // do not share (assembly methods)
 extern void flushQueue(u16 num);
+extern void flushQueueEx(DMAOpInfo* info, u16 num);
+// we don't want to share that method
+extern bool MEM_isFrameAddress(const void* addr);
 
 
 void DMA_init()
@@ -55,6 +76,8 @@ NO_INLINE void DMA_initEx(u16 size, u16 capacity, u16 bufferSize)
     maxTransferPerFrame = capacity;
     // auto flush is enabled by default
     flag = DMA_AUTOFLUSH;
+    queuePrio = DMA_PRIO_NORMAL;
+    mergedCount = 0;
     VBlankProcess |= PROCESS_DMA_TASK;
 
     // release buffers first
@@ -63,6 +86,11 @@ NO_INLINE void DMA_initEx(u16 size, u16 capacity, u16 bufferSize)
         MEM_free(dmaQueues);
         dmaQueues = NULL;
     }
+    if (dmaQueuePrios)
+    {
+        MEM_free(dmaQueuePrios);
+        dmaQueuePrios = NULL;
+    }
     if (dmaDataBuffer)
     {
         MEM_free(dmaDataBuffer);
@@ -78,6 +106,7 @@ NO_INLINE void DMA_initEx(u16 size, u16 capacity, u16 bufferSize)
 
     // allocate DMA queue
     dmaQueues = MEM_alloc(queueSize * sizeof(DMAOpInfo));
+    dmaQueuePrios = MEM_alloc(queueSize * sizeof(u8));
 
     // define DMA data buffer size (in words)
     // this actually clear the DMA queue
@@ -115,8 +144,10 @@ void DMA_setMaxQueueSize(u16 value)
 
     // already allocated ?
     if (dmaQueues) MEM_free(dmaQueues);
+    if (dmaQueuePrios) MEM_free(dmaQueuePrios);
     // allocate DMA queue
     dmaQueues = MEM_alloc(queueSize * sizeof(DMAOpInfo));
+    dmaQueuePrios = MEM_alloc(queueSize * sizeof(u8));
 
     // reset queue
     DMA_clearQueue();
@@ -176,31 +207,225 @@ bool DMA_getIgnoreOverCapacity()
 
 void DMA_setIgnoreOverCapacity(bool value)
 {
-    if (value) flag |= DMA_OVERCAPACITY_IGNORE;
+    // ignore and carry strategies are exclusive
+    if (value) flag = (flag & ~DMA_OVERCAPACITY_CARRY) | DMA_OVERCAPACITY_IGNORE;
     else flag &= ~DMA_OVERCAPACITY_IGNORE;
 }
 
+bool DMA_getCarryOverCapacity()
+{
+    return (flag & DMA_OVERCAPACITY_CARRY) ? TRUE : FALSE;
+}
+
+void DMA_setCarryOverCapacity(bool value)
+{
+    // ignore and carry strategies are exclusive
+    if (value) flag = (flag & ~DMA_OVERCAPACITY_IGNORE) | DMA_OVERCAPACITY_CARRY;
+    else flag &= ~DMA_OVERCAPACITY_CARRY;
+}
+
+u8 DMA_getQueuePriority()
+{
+    return queuePrio;
+}
+
+void DMA_setQueuePriority(u8 value)
+{
+    queuePrio = min(value, DMA_PRIO_HIGH);
+}
+
 void DMA_clearQueue()
 {
     queueIndex = 0;
     queueIndexLimit = 0;
     queueTransferSize = 0;
+    canMerge = FALSE;
+    frameArenaCarried = FALSE;
 
     // reset DMA data buffer pointer
     nextDataBuffer = dmaDataBuffer;
 
 }
 
+static u16 getTransferLen(const DMAOpInfo* info)
+{
+    return (info->regLenL & 0xFF) | ((info->regLenH & 0xFF) << 8);
+}
+
+static u16 getTransferCost(const DMAOpInfo* info)
+{
+    const u16 len = getTransferLen(info);
+
+    // VRAM transfer are 2 times more expensive than CRAM/VSRAM transfer (see DMA_queueDmaFast(..))
+    if ((info->regCtrlWrite & 0xC0000030) == 0x40000000) return len << 1;
+    return len;
+}
+
+static u32 getTransferSource(const DMAOpInfo* info)
+{
+    return ((info->regAddrMStep & 0xFF0000) >> 7) | ((info->regAddrHAddrL & 0x7F00FF) << 1);
+}
+
+// destination memory type: 0 = VRAM, 1 = VSRAM, 2 = CRAM
+static u16 getDestType(const DMAOpInfo* info)
+{
+    const u32 cmd = info->regCtrlWrite;
+
+    return ((cmd >> 30) & 2) | ((cmd >> 4) & 1);
+}
+
+static u32 getDestStart(const DMAOpInfo* info)
+{
+    const u32 cmd = info->regCtrlWrite;
+
+    // VRAM uses 2 extra high bits
+    return ((cmd >> 16) & 0x3FFF) | ((cmd & 3) << 14);
+}
+
+static u32 getDestEnd(const DMAOpInfo* info, u32 start)
+{
+    // conservative, consider minimum step of 2
+    return start + (getTransferLen(info) * max(info->regAddrMStep & 0xFF, 2));
+}
+
+// select transfers to send this frame and return their number
+// - priority levels fully fitting in capacity are sent
+// - the first level not fitting is sent in queue order while there is capacity left
+// - lower levels are delayed
+static u16 scheduleQueue()
+{
+    u16 levelCost[DMA_PRIO_HIGH + 1];
+    // delayed transfers destination range per memory type (conservative union)
+    u32 delayedStart[3];
+    u32 delayedEnd[3];
+    u16 remaining = maxTransferPerFrame;
+    u16 num = 0;
+    s16 cut;
+    u16 i;
+
+    // counting pass: transfer cost per priority level
+    for(i = 0; i <= DMA_PRIO_HIGH; i++) levelCost[i] = 0;
+    for(i = 0; i < queueIndex; i++) levelCost[dmaQueuePrios[i]] += getTransferCost(&dmaQueues[i]);
+
+    // find the first level not fitting in capacity
+    cut = DMA_PRIO_HIGH;
+    while((cut >= DMA_PRIO_LOW) && (levelCost[cut] <= remaining)) remaining -= levelCost[cut--];
+
+    for(i = 0; i < 3; i++)
+    {
+        delayedStart[i] = 0xFFFFFFFF;
+        delayedEnd[i] = 0;
+    }
+
+    // single pass in queue order so all older transfers are already scheduled or delayed
+    for(i = 0; i < queueIndex; i++)
+    {
+        const s16 prio = dmaQueuePrios[i];
+        const DMAOpInfo* info = &dmaQueues[i];
+        const u16 type = getDestType(info);
+        const u32 start = getDestStart(info);
+        const u32 end = getDestEnd(info, start);
+        bool send;
+
+        if (prio > cut) send = TRUE;
+        else if (prio == cut)
+        {
+            const u16 cost = getTransferCost(info);
+
+            // fit in remaining capacity (always accept first transfer so a transfer bigger than capacity can't block the queue)
+            send = (cost <= remaining) || (remaining == maxTransferPerFrame);
+            if (send) remaining -= min(cost, remaining);
+        }
+        else send = FALSE;
+
+        // an older transfer to same destination is delayed --> need to delay this one as well to preserve order
+        if (send && (start < delayedEnd[type]) && (delayedStart[type] < end)) send = FALSE;
+
+        if (send)
+        {
+            dmaQueuePrios[i] |= DMA_PRIO_SCHEDULED;
+            num++;
+        }
+        else
+        {
+            if (start < delayedStart[type]) delayedStart[type] = start;
+            if (end > delayedEnd[type]) delayedEnd[type] = end;
+        }
+    }
+
+#ifdef DMA_DEBUG
+    KLog_U3("DMA scheduleQueue: ", num, " transfers scheduled on ", queueIndex, " - remaining capacity = ", remaining);
+#endif
+
+    return num;
+}
+
+// keep not scheduled transfers (in original order) for next frame
+static void carryQueue()
+{
+    u16* dataEnd = dmaDataBuffer;
+    u16 size = 0;
+    u16 num = 0;
+    bool arenaUsed = FALSE;
+    u16 i;
+
+    for(i = 0; i < queueIndex; i++)
+    {
+        const u8 prio = dmaQueuePrios[i];
+
+        // already sent ? --> remove it
+        if (prio & DMA_PRIO_SCHEDULED) continue;
+
+        DMAOpInfo* info = &dmaQueues[i];
+        const u32 from = getTransferSource(info);
+        u16* fromEnd = (u16*) (from + (getTransferLen(info) * 2));
+
+        // source is in DMA data buffer ? --> need to preserve it
+        if ((from >= (u32) dmaDataBuffer) && (fromEnd <= (dmaDataBuffer + dataBufferSize)) && (fromEnd > dataEnd))
+            dataEnd = fromEnd;
+        // source is in frame arena ? --> frame arena can't be released until transfer is done
+        if (MEM_isFrameAddress((void*) from)) arenaUsed = TRUE;
+
+        size += getTransferCost(info);
+        if (num != i) dmaQueues[num] = *info;
+        // carried transfer get higher priority so they can't be delayed forever
+        dmaQueuePrios[num] = min(prio + 1, DMA_PRIO_HIGH);
+        num++;
+    }
+
+    queueIndex = num;
+    queueIndexLimit = 0;
+    queueTransferSize = size;
+    nextDataBuffer = dataEnd;
+    // last transfer may have been sent
+    canMerge = FALSE;
+    frameArenaCarried = arenaUsed;
+}
+
+// this one can't be static (used by sys.c)
+bool DMA_isFrameArenaCarried()
+{
+    return frameArenaCarried;
+}
+
 void DMA_flushQueue()
 {
     u16 i;
     u8 autoInc;
+    bool carry;
 
     // default
     i = queueIndex;
+    carry = FALSE;
 
+    // we choose to carry over capacity transfers to next frame ?
+    if ((flag & DMA_OVERCAPACITY_CARRY) && (queueTransferSize > maxTransferPerFrame))
+    {
+        i = scheduleQueue();
+        carry = TRUE;
+    }
     // limit reached ?
-    if (queueIndexLimit)
+    else if (queueIndexLimit)
     {
         // we choose to ignore over capacity transfers ?
         if (flag & DMA_OVERCAPACITY_IGNORE)
@@ -224,12 +449,21 @@ void DMA_flushQueue()
     // DMA disabled --> replace with software copy
 
     DMAOpInfo *info = dmaQueues;
+    u8 *prio = dmaQueuePrios;
+    u16 n = carry ? queueIndex : i;
 
-    while(i--)
+    while(n--)
     {
-        u16 len = (info->regLenL & 0xFF) | ((info->regLenH & 0xFF) << 8);
+        // not scheduled for this frame ? --> skip it
+        if (carry && !(*prio++ & DMA_PRIO_SCHEDULED))
+        {
+            info++;
+            continue;
+        }
+
+        u16 len = getTransferLen(info);
         s16 step = info->regAddrMStep & 0xFF;
-        u32 from = ((info->regAddrMStep & 0xFF0000) >> 7) | ((info->regAddrHAddrL & 0x7F00FF) << 1);
+        u32 from = getTransferSource(info);
         // replace DMA command by WRITE command
         u32 cmd = info->regCtrlWrite & ~0x80;
 
@@ -247,7 +481,24 @@ void DMA_flushQueue()
     if (!busTaken) Z80_requestBus(FALSE);
 #endif  // HALT_Z80_ON_DMA
 
-    flushQueue(i);
+    if (carry)
+    {
+        u16 start = 0;
+
+        // send each block of consecutive scheduled transfers
+        while(start < queueIndex)
+        {
+            u16 end = start;
+
+            while((end < queueIndex) && (dmaQueuePrios[end] & DMA_PRIO_SCHEDULED)) end++;
+            flushQueueEx(&dmaQueues[start], end - start);
+
+            // skip carried transfers
+            start = end;
+            while((start < queueIndex) && !(dmaQueuePrios[start] & DMA_PRIO_SCHEDULED)) start++;
+        }
+    }
+    else flushQueue(i);
 
 #if (HALT_Z80_ON_DMA != 0)
     // re-enable Z80 after all DMA
@@ -256,8 +507,10 @@ void DMA_flushQueue()
 
 #endif  // DMA_DISABLED
 
+    // keep delayed transfers for next frame
+    if (carry) carryQueue();
     // can clear the queue now
-    DMA_clearQueue();
+    else DMA_clearQueue();
     // restore autoInc
     VDP_setAutoInc(autoInc);
 }
@@ -319,6 +572,20 @@ u16 DMA_getQueueTransferSize()
     return queueTransferSize;
 }
 
+u32 DMA_getMergedTransferCount()
+{
+    return mergedCount;
+}
+
+u16 DMA_getQueueBacklog()
+{
+    // no limit or everything fits in next flush
+    if (queueTransferSize <= maxTransferPerFrame) return 0;
+
+    // number of extra frames required to transfer all pending data
+    return (queueTransferSize - 1) / maxTransferPerFrame;
+}
+
 bool DMA_transfer(TransferMethod tm, u8 location, void* from, u16 to, u16 len, u16 step)
 {
     // nothing to do (avoid transfering 65536 words when len = 0)
@@ -451,11 +718,51 @@ bool DMA_queueDma(u8 location, void* from, u16 to, u16 len, u16 step)
     return DMA_queueDmaFast(location, from, to, newLen, step);
 }
 
+static bool mergeTransfer(u8 location, u32 fromAddr, u16 to, u16 len, u16 step)
+{
+    DMAOpInfo *info;
+    u16 size;
+    u32 newLen;
+
+    // not contiguous with last queued transfer ?
+    if (!canMerge || (fromAddr != mergeFrom) || (to != mergeTo) || (location != mergeLocation) || (step != mergeStep)) return FALSE;
+    // different priority
+    if (dmaQueuePrios[queueIndex - 1] != queuePrio) return FALSE;
+
+    info = &dmaQueues[queueIndex - 1];
+    newLen = getTransferLen(info) + len;
+    size = (location == DMA_VRAM) ? (len << 1) : len;
+
+    // DMA length is limited to 64 KWord, source can't cross 128 KB bank and we don't want to merge above capacity limit
+    if ((newLen > 0xFFFF) || (((fromAddr + (len << 1) - 1) ^ (fromAddr - 1)) & ~0x1FFFF) || ((queueTransferSize + size) > maxTransferPerFrame))
+        return FALSE;
+
+    // just extend last transfer length
+    info->regLenL = 0x9300 + (newLen & 0xFF);
+    info->regLenH = 0x9400 + ((newLen >> 8) & 0xFF);
+
+    queueTransferSize += size;
+    mergeFrom += len << 1;
+    mergeTo += len * step;
+    mergedCount++;
+
+#ifdef DMA_DEBUG
+    KLog_U4("DMA_queueDma: merged from=", fromAddr, " to=", to, " len=", len, " new len=", newLen);
+#endif
+
+    return TRUE;
+}
+
 NO_INLINE bool DMA_queueDmaFast(u8 location, void* from, u16 to, u16 len, u16 step)
 {
     u32 fromAddr;
     DMAOpInfo *info;
 
+    fromAddr = (u32) from;
+
+    // contiguous to last queued transfer ? --> merge them (save queue slot and DMA setup)
+    if (mergeTransfer(location, fromAddr, to, len, step)) return TRUE;
+
     // queue is full --> error
     if (queueIndex >= queueSize)
     {
@@ -467,10 +774,9 @@ NO_INLINE bool DMA_queueDmaFast(u8 location, void* from, u16 to, u16 len, u16 st
         return FALSE;
     }
 
-    fromAddr = (u32) from;
-
     // get DMA info structure and pass to next one
     info = &dmaQueues[queueIndex];
+    dmaQueuePrios[queueIndex] = queuePrio;
 
     // $13:len L  $14:len H (DMA length in word)
     info->regLenL = 0x9300 + (len & 0xFF);
@@ -514,6 +820,13 @@ NO_INLINE bool DMA_queueDmaFast(u8 location, void* from, u16 to, u16 len, u16 st
     // pass to next index
     queueIndex++;
 
+    // store info to merge next transfer if contiguous
+    canMerge = TRUE;
+    mergeLocation = location;
+    mergeStep = step;
+    mergeFrom = fromAddr + (len << 1);
+    mergeTo = to + (len * step);
+
 #ifdef DMA_DEBUG
     KLog_U2("  Queue index=", queueIndex, " new queueTransferSize=", queueTransferSize);
 #endif
@@ -535,7 +848,7 @@ NO_INLINE bool DMA_queueDmaFast(u8 location, void* from, u16 to, u16 len, u16 st
 #endif
         }
 
-        // return FALSE if transfer will be ignored
+        // return FALSE if transfer will be ignored (carried transfers will be done later)
         return (flag & DMA_OVERCAPACITY_IGNORE) ? FALSE : TRUE;
     }
 
@@ -20,4 +20,25 @@ func flushQueue
 	dbra %d0,.fq_loop
 
 .fq_end:
-	rts
\ No newline at end of file
+	rts
+
+func flushQueueEx
+	move.w 10(%sp),%d0
+    jeq     .fqe_end
+
+	move.l 4(%sp),%a0
+	move.l #0xC00004,%a1
+
+	subq.w #1,%d0           // prepare for dbra
+
+.fqe_loop:
+	move.l (%a0)+,(%a1)
+	move.l (%a0)+,(%a1)
+	move.l (%a0)+,(%a1)
+	move.w (%a0)+,(%a1)
+	move.w (%a0)+,(%a1)     // important to use word write for command triggering DMA (see SEGA notes)
+
+	dbra %d0,.fqe_loop
+
+.fqe_end:
+	rts
@@ -8,6 +8,7 @@
 #include "vdp_tile.h"
 #include "memory.h"
 #include "tools.h"
+#include "profiler.h"
 
 
 //#define MAP_DEBUG
@@ -20,6 +21,10 @@
 
 
 // forward
+static void initStream(Map* map, const MapDefinition* mapDef);
+static void ensureStreamRows(Map* map, u16 ym, u16 hm);
+static u16 loadStreamChunk(Map* map, u16 chunk, u16 lockMask);
+
 static void updateMap(Map *map, s16 xt, s16 yt);
 static void setMapColumn(Map *map, u16 column, u16 x, u16 y);
 static void setMapRow(Map *map, u16 row, u16 x, u16 y);
@@ -85,15 +90,20 @@ Map* NO_INLINE MAP_create(const MapDefinition* mapDef, VDPPlane plane, u16 baseT
     // init FAR pointer
     else result->blocks = FAR_SAFE(mapDef->blocks, mapDef->numBlock * 64 * ((mapDef->numMetaTile > 256)?2:1));
 
-    // get blocks indexes data compression
-    comp = (compression >> 8) & 0xF;
-    // blocks indexes data are compressed ?
-    if (comp != COMPRESSION_NONE) unpack(comp, (u8*) FAR_SAFE(mapDef->blockIndexes, mulu(mapDef->w, mapDef->hp) * ((mapDef->numBlock > 256)?2:1)), (u8*) result->blockIndexes);
-    // init FAR pointer
-    else result->blockIndexes = FAR_SAFE(mapDef->blockIndexes, mapDef->w * mapDef->hp * ((mapDef->numBlock > 256)?2:1));
-
-    // init FAR pointer
-    result->blockRowOffsets = FAR_SAFE(mapDef->blockRowOffsets, mapDef->h * 2);
+    // streamed blocks indexes ? --> only init chunk cache (chunks are unpacked on demand)
+    if (compression & MAP_STREAMING) initStream(result, mapDef);
+    else
+    {
+        // get blocks indexes data compression
+        comp = (compression >> 8) & 0xF;
+        // blocks indexes data are compressed ?
+        if (comp != COMPRESSION_NONE) unpack(comp, (u8*) FAR_SAFE(mapDef->blockIndexes, mulu(mapDef->w, mapDef->hp) * ((mapDef->numBlock > 256)?2:1)), (u8*) result->blockIndexes);
+        // init FAR pointer
+        else result->blockIndexes = FAR_SAFE(mapDef->blockIndexes, mapDef->w * mapDef->hp * ((mapDef->numBlock > 256)?2:1));
+
+        // init FAR pointer
+        result->blockRowOffsets = FAR_SAFE(mapDef->blockRowOffsets, mapDef->h * 2);
+    }
 
     // init base parameters
     result->plane = plane;
@@ -206,10 +216,170 @@ void MAP_release(Map* map)
 }
 
 
+static void initStream(Map* map, const MapDefinition* mapDef)
+{
+    MapStream* stream = map->stream;
+    const u16 compression = mapDef->compression;
+    const u16 sft = (compression >> 12) & 7;
+    u16 i;
+
+    stream->chunkRowSft = sft;
+    stream->hp = mapDef->hp;
+    stream->rowSize = mapDef->w * ((mapDef->numBlock > 256)?2:1);
+    // slot size in block index unit
+    stream->slotSize = (((stream->rowSize << sft) + 1) & 0xFFFE) / ((mapDef->numBlock > 256)?2:1);
+    stream->tick = 0;
+#if (ENABLE_BANK_SWITCH != 0)
+    const u16 numChunk = (mapDef->hp + (1 << sft) - 1) >> sft;
+
+    // last chunk table entry gives the whole chunk data size
+    stream->chunkInfo = FAR_SAFE(mapDef->blockIndexes, (numChunk + 1) * 4);
+    stream->chunkInfo = FAR_SAFE(mapDef->blockIndexes, stream->chunkInfo[numChunk] & 0xFFFFFF);
+#else
+    stream->chunkInfo = mapDef->blockIndexes;
+#endif
+    stream->srcRowOffsets = FAR_SAFE(mapDef->blockRowOffsets, mapDef->h * 2);
+
+    // all slots empty
+    for(i = 0; i < MAP_STREAMING_SLOT; i++)
+    {
+        stream->slotChunk[i] = 0xFFFF;
+        stream->slotTick[i] = 0;
+    }
+
+    // no row loaded yet
+    memsetU16(map->blockRowOffsets, 0xFFFF, mapDef->h);
+}
+
+static u16 loadStreamChunk(Map* map, u16 chunk, u16 lockMask)
+{
+    MapStream* stream = map->stream;
+    u16 slot;
+    u16 i;
+
+    // already cached ?
+    for(i = 0; i < MAP_STREAMING_SLOT; i++)
+    {
+        if (stream->slotChunk[i] == chunk)
+        {
+            stream->slotTick[i] = stream->tick;
+            return i;
+        }
+    }
+
+    // find an empty slot or the least recently used one (not used by current request)
+    slot = 0xFFFF;
+    for(i = 0; i < MAP_STREAMING_SLOT; i++)
+    {
+        if (lockMask & (1 << i)) continue;
+
+        if (stream->slotChunk[i] == 0xFFFF)
+        {
+            slot = i;
+            break;
+        }
+        if ((slot == 0xFFFF) || ((u16) (stream->tick - stream->slotTick[i]) > (u16) (stream->tick - stream->slotTick[slot])))
+            slot = i;
+    }
+
+    const u16 slotSize = stream->slotSize;
+    const u16 slotStart = mulu(slot, slotSize);
+    const u16 slotEnd = slotStart + slotSize;
+    u16* rowOffsets = map->blockRowOffsets;
+
+    // evicted chunk ? --> invalidate rows which were using this slot
+    if (stream->slotChunk[slot] != 0xFFFF)
+    {
+        for(i = 0; i < map->h; i++)
+        {
+            const u16 off = rowOffsets[i];
+            if ((off >= slotStart) && (off < slotEnd)) rowOffsets[i] = 0xFFFF;
+        }
+    }
+
+    // unpack chunk into slot
+    const u32 info = stream->chunkInfo[chunk];
+    const u16 comp = info >> 24;
+    u8* src = ((u8*) stream->chunkInfo) + (info & 0xFFFFFF);
+    u8* dst = ((u8*) stream->data) + mulu(slot, ((stream->rowSize << stream->chunkRowSft) + 1) & 0xFFFE);
+
+    if (comp != COMPRESSION_NONE) unpack(comp, src, dst);
+    else
+    {
+        u16 numRow = stream->hp - (chunk << stream->chunkRowSft);
+        if (numRow > (1 << stream->chunkRowSft)) numRow = 1 << stream->chunkRowSft;
+        memcpy(dst, src, mulu(numRow, stream->rowSize));
+    }
+
+    stream->slotChunk[slot] = chunk;
+    stream->slotTick[slot] = stream->tick;
+
+    return slot;
+}
+
+// make sure block index rows covering metatile rows [ym, ym + hm - 1] are in chunk cache (hm should be <= 8 * (MAP_STREAMING_SLOT - 1) + 1)
+static void ensureStreamRows(Map* map, u16 ym, u16 hm)
+{
+    MapStream* stream = map->stream;
+
+    // not a streamed map --> nothing to do
+    if (stream == NULL) return;
+
+    u16* rowOffsets = map->blockRowOffsets;
+    const u16 slotSize = stream->slotSize;
+    // block row position
+    u16 yb = (ym / 8) & map->hMask;
+    // number of block row
+    u16 num = ((ym & 7) + hm + 7) / 8;
+    // slots used by current request (can't be evicted)
+    u16 lockMask = 0;
+
+    stream->tick++;
+
+    while(num--)
+    {
+        // rows out of map height can't be resolved (map height should be a power of 2 for wrapping)
+        if (yb < map->h)
+        {
+            u16 off = rowOffsets[yb];
+
+            // row already available ? --> just touch its slot
+            if (off != 0xFFFF)
+            {
+                u16 slot = 0;
+
+                while(off >= slotSize)
+                {
+                    off -= slotSize;
+                    slot++;
+                }
+
+                stream->slotTick[slot] = stream->tick;
+                lockMask |= 1 << slot;
+            }
+            else
+            {
+                // physical row (duplicated rows share the same physical row)
+                const u16 row = divu(stream->srcRowOffsets[yb], map->w);
+                const u16 chunk = row >> stream->chunkRowSft;
+                const u16 slot = loadStreamChunk(map, chunk, lockMask);
+
+                lockMask |= 1 << slot;
+                rowOffsets[yb] = mulu(slot, slotSize) + mulu(row - (chunk << stream->chunkRowSft), map->w);
+            }
+        }
+
+        yb = (yb + 1) & map->hMask;
+    }
+}
+
+
 NO_INLINE void MAP_scrollToEx(Map* map, u32 x, u32 y, bool forceRedraw)
 {
     bool redraw = forceRedraw || map->firstUpdate;
 
+    PROF_BEGIN(PROF_ZONE_MAP);
+
     map->firstUpdate = FALSE;
 
     if (redraw)
@@ -272,6 +442,8 @@ NO_INLINE void MAP_scrollToEx(Map* map, u32 x, u32 y, bool forceRedraw)
         // store Y position
         map->posY = y;
     }
+
+    PROF_END(PROF_ZONE_MAP);
 }
 
 void MAP_scrollTo(Map* map, u32 x, u32 y)
@@ -291,6 +463,9 @@ static void updateMap(Map* map, s16 xt, s16 yt)
     // no update --> exit
     if ((deltaX == 0) && (deltaY == 0)) return;
 
+    // streamed map ? --> make sure visible block rows are available (all updates are done in [yt, yt + ROW_AHEAD - 1] range)
+    ensureStreamRows(map, yt, ROW_AHEAD);
+
 #ifdef MAP_DEBUG
     KLog_S4("updateMap xt=", xt, " yt=", yt, " deltaX=", deltaX, " deltaY=", deltaY);
 #endif
@@ -1498,11 +1673,13 @@ static void prepareMapDataRowEx_MTI16_BI16(Map* map, u16 *bufRow1, u16 *bufRow2,
 
 u16 MAP_getMetaTile(Map* map, u16 x, u16 y)
 {
+    ensureStreamRows(map, y, 1);
     return map->getMetaTileCB(map, x, y);
 }
 
 u16 MAP_getTile(Map* map, u16 x, u16 y)
 {
+    ensureStreamRows(map, y / 2, 1);
     u16 metaTileInd = map->getMetaTileCB(map, x / 2, y / 2);
     u16* metaTile = &map->metaTiles[2 * 2 * metaTileInd];
     return metaTile[((y & 1) * 2) + (x & 1)];
@@ -1510,7 +1687,28 @@ u16 MAP_getTile(Map* map, u16 x, u16 y)
 
 void MAP_getMetaTilemapRect(Map* map, u16 x, u16 y, u16 w, u16 h, u16* dest)
 {
-    return map->getMetaTilemapRectCB(map, x, y, w, h, dest);
+    // streamed map ? --> process block row by block row so we never need more chunks than the cache can hold
+    if (map->stream != NULL)
+    {
+        u16 yi = y;
+        u16 hi = h;
+        u16* d = dest;
+
+        while(hi)
+        {
+            // remaining metatile rows in current block row
+            u16 hb = 8 - (yi & 7);
+            if (hb > hi) hb = hi;
+
+            ensureStreamRows(map, yi, hb);
+            map->getMetaTilemapRectCB(map, x, yi, w, hb, d);
+
+            d += mulu(w, hb);
+            yi += hb;
+            hi -= hb;
+        }
+    }
+    else map->getMetaTilemapRectCB(map, x, y, w, h, dest);
 }
 
 void MAP_getTilemapRect(Map* map, u16 x, u16 y, u16 w, u16 h, bool column, u16* dest)
@@ -1531,7 +1729,26 @@ void MAP_getTilemapRect(Map* map, u16 x, u16 y, u16 w, u16 h, bool column, u16*
 
         while(wi--)
         {
-            updateCol(map, d1, d2, xi, y, h);
+            // streamed map ? --> process block row by block row so we never need more chunks than the cache can hold
+            if (map->stream != NULL)
+            {
+                u16 yi = y;
+                u16 hi = h;
+
+                while(hi)
+                {
+                    // remaining metatile rows in current block row
+                    u16 hb = 8 - (yi & 7);
+                    if (hb > hi) hb = hi;
+
+                    ensureStreamRows(map, yi, hb);
+                    updateCol(map, d1 + ((yi - y) * 2), d2 + ((yi - y) * 2), xi, yi, hb);
+
+                    yi += hb;
+                    hi -= hb;
+                }
+            }
+            else updateCol(map, d1, d2, xi, y, h);
             // next metatile X
             xi++;
             // next metatile column
@@ -1552,6 +1769,7 @@ void MAP_getTilemapRect(Map* map, u16 x, u16 y, u16 w, u16 h, bool column, u16*
 
         while(hi--)
         {
+            ensureStreamRows(map, yi, 1);
             updateRow(map, d1, d2, x, yi, w);
             // next metatile Y
             yi++;
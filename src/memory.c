@@ -11,6 +11,18 @@
 
 #define USED        1
 
+// size class allocation: blocks up to SIZECLASS_MAX bytes (header included) are rounded to 4 bytes
+// and recycled through per size free lists (minimum block size is 8 bytes to store the list link)
+#define SIZECLASS_MIN       8
+#define SIZECLASS_MAX       128
+#define SIZECLASS_SFT       2
+#define SIZECLASS_NUM       ((SIZECLASS_MAX >> SIZECLASS_SFT) + 1)
+// cached block marker (stored after the list link) to detect double free
+#define SIZECLASS_MAGIC     0xCAC4
+
+// frame arena size (2 bytes aligned)
+#define FRAME_SIZE          ((FRAME_ARENA_SIZE + 1) & 0xFFFE)
+
 
 // end of bss segment --> start of heap
 extern u32 _bend;
@@ -148,14 +160,33 @@ extern u32 _bend;
 // forward
 // static void packBlock(u16* block);
 static u16* pack(u16 nsize);
+static u16* findBlock(u16 nsize);
+static void packFree(void);
+static void flushSizeClass(void);
+static bool isSizeClassCached(u16* block);
 
 static u16* free;
 static u16* heap;
 static u16* heapEnd;
 static bool needPack;
 
+// size class allocation
+static u16 allocMode;
+// free lists (indexed by block size / 4), cached blocks keep their USED flag so they are never packed
+// (cached state is marked by SIZECLASS_MAGIC in block data)
+static u16* sizeClassList[SIZECLASS_NUM];
+// total size of cached blocks
+static u16 sizeClassCached;
+
+// frame arena (reserved at end of heap)
+static u8* frameArena;
+static u16 frameUsed;
+static u16 frameHighWater;
+
 void MEM_init()
 {
+    u16 i;
+
     // point to end of bss (start of heap)
     u32 h = (u32)&_bend;
     // 2 bytes aligned
@@ -163,8 +194,8 @@ void MEM_init()
     h >>= 1;
     h <<= 1;
 
-    // define available memory (sizeof(u16) is the memory reserved to indicate heap end)
-    u16 len = (u16)(MEMORY_HIGH - (h + sizeof(u16)));
+    // define available memory (sizeof(u16) is the memory reserved to indicate heap end, frame arena is taken from end of memory)
+    u16 len = (u16)(MEMORY_HIGH - (h + sizeof(u16) + FRAME_SIZE));
 
     // define heap
     heap = (u16*) h;
@@ -181,6 +212,29 @@ void MEM_init()
     heapEnd = heap + (len >> 1);
     *heapEnd = 0;
     needPack = FALSE;
+
+    // default allocation mode
+    allocMode = MEM_ALLOC_FIRST_FIT;
+    for(i = 0; i < SIZECLASS_NUM; i++) sizeClassList[i] = NULL;
+    sizeClassCached = 0;
+
+    // frame arena is located right after heap end
+    frameArena = (u8*) (heapEnd + 1);
+    frameUsed = 0;
+    frameHighWater = 0;
+}
+
+void MEM_setAllocMode(u16 mode)
+{
+    // release cached blocks when size class allocation is disabled
+    if (mode != MEM_ALLOC_SIZE_CLASS) flushSizeClass();
+
+    allocMode = mode;
+}
+
+u16 MEM_getAllocMode()
+{
+    return allocMode;
 }
 
 u16 MEM_getFree()
@@ -198,7 +252,8 @@ u16 MEM_getFree()
         b += bsize >> 1;
     }
 
-    return res;
+    // blocks cached in size class lists are available too
+    return res + sizeClassCached;
 }
 
 u16 MEM_getLargestFreeBlock()
@@ -241,7 +296,62 @@ u16 MEM_getAllocated()
         b += bsize >> 1;
     }
 
-    return res;
+    // blocks cached in size class lists are not allocated
+    return res - sizeClassCached;
+}
+
+void* MEM_allocFrame(u16 size)
+{
+    // 2 bytes aligned
+    const u16 adjsize = (size + 1) & 0xFFFE;
+    const u16 used = frameUsed + adjsize;
+
+    if ((used > FRAME_SIZE) || (used < adjsize))
+    {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+        KLog_U2_("MEM_allocFrame(", size, ") failed: frame arena over capacity (used = ", frameUsed, ")");
+#endif
+
+        return NULL;
+    }
+
+    void* result = frameArena + frameUsed;
+
+    frameUsed = used;
+    if (used > frameHighWater) frameHighWater = used;
+
+    return result;
+}
+
+void MEM_resetFrame()
+{
+    frameUsed = 0;
+}
+
+// used by dma.c (we don't want to share it)
+bool MEM_isFrameAddress(const void* addr)
+{
+    return ((u8*) addr >= frameArena) && ((u8*) addr < (frameArena + FRAME_SIZE));
+}
+
+u16 MEM_getFrameUsed()
+{
+    return frameUsed;
+}
+
+u16 MEM_getFrameHighWater()
+{
+    return frameHighWater;
+}
+
+void MEM_resetFrameHighWater()
+{
+    frameHighWater = frameUsed;
+}
+
+u16 MEM_getFrameSize()
+{
+    return FRAME_SIZE;
 }
 
 NO_INLINE void* MEM_alloc(u16 size)
@@ -249,45 +359,58 @@ NO_INLINE void* MEM_alloc(u16 size)
     if (size == 0)
         return 0;
 
-    // pack memory if requested
-    if (needPack) MEM_pack();
-
-    u16* p = free;
+    u16* p;
     // 2 bytes aligned
     u16 adjsize = (size + sizeof(u16) + 1) & 0xFFFE;
 
-    // block is not big enough ?
-    if (adjsize > *p)
+    // small block in size class allocation mode ?
+    if ((allocMode == MEM_ALLOC_SIZE_CLASS) && (adjsize <= SIZECLASS_MAX))
     {
-        // find the first big enough free block
-        while (*p && (adjsize > *p))
-        {
-            // next block
-            p += *p >> 1;
-            // bypass used blocks
-            while(*p & USED) p += *p >> 1;
-        }
+        // round to size class
+        adjsize = (adjsize + 3) & 0xFFFC;
+        if (adjsize < SIZECLASS_MIN) adjsize = SIZECLASS_MIN;
+
+        u16** list = &sizeClassList[adjsize >> SIZECLASS_SFT];
 
-        // reached end of heap ?
-        if (*p == 0)
+        p = *list;
+        // got a cached block ? --> just unlink it (already marked as used)
+        if (p != NULL)
         {
-            // try to pack memory
-            p = pack(adjsize);
-            // not enough memory
-            if (p == NULL)
-            {
-    #if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
-                if (size > MEM_getFree())
-                    KLog_U2_("MEM_alloc(", size, ") failed: no enough free memory (free = ", MEM_getFree(), ")");
-                else
-                    KLog_U3_("MEM_alloc(", size, ") failed: cannot find a big enough memory block (largest free block = ", MEM_getLargestFreeBlock(), " - free = ", MEM_getFree(), ")");
-    #endif
-
-                return NULL;
-            }
+            *list = *((u16**) (p + 1));
+            // not anymore cached
+            p[3] = 0;
+            sizeClassCached -= adjsize;
+
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_INFO)
+            kprintf("MEM_alloc(%d) success: %lx - remaining = %d", size, (u32) (p + 1), MEM_getFree());
+#endif
+
+            return p + 1;
         }
     }
 
+    p = findBlock(adjsize);
+
+    // not found ? --> release cached blocks and retry
+    if ((p == NULL) && sizeClassCached)
+    {
+        flushSizeClass();
+        p = findBlock(adjsize);
+    }
+
+    // not enough memory
+    if (p == NULL)
+    {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+        if (size > MEM_getFree())
+            KLog_U2_("MEM_alloc(", size, ") failed: no enough free memory (free = ", MEM_getFree(), ")");
+        else
+            KLog_U3_("MEM_alloc(", size, ") failed: cannot find a big enough memory block (largest free block = ", MEM_getLargestFreeBlock(), " - free = ", MEM_getFree(), ")");
+#endif
+
+        return NULL;
+    }
+
     // set free to next free block
     free = p + (adjsize >> 1);
 
@@ -326,6 +449,9 @@ NO_INLINE void* MEM_allocAt(u32 addr, u16 size)
     // 2 bytes aligned
     u16 adjsize = (size + sizeof(u16) + 1) & 0xFFFE;
 
+    // wanted block may be cached
+    flushSizeClass();
+
     u16* found = NULL;
     u16* b = heap;
     u16* best = b;
@@ -482,6 +608,35 @@ void MEM_free(void *ptr)
         }
 #endif
 
+        const u16 bsize = *block & ~USED;
+
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+        // already released in size class list ?
+        if ((bsize >= SIZECLASS_MIN) && (block[3] == SIZECLASS_MAGIC) && isSizeClassCached(block))
+        {
+            kprintf("MEM_free(%lx) failed: block is already released !", (u32) ptr);
+            return;
+        }
+#endif
+
+        // size class allocation: cache small block (keep it marked as used)
+        if ((allocMode == MEM_ALLOC_SIZE_CLASS) && (bsize >= SIZECLASS_MIN) && (bsize <= SIZECLASS_MAX) && !(bsize & 3))
+        {
+            u16** list = &sizeClassList[bsize >> SIZECLASS_SFT];
+
+            *((u16**) ptr) = *list;
+            // mark as cached
+            block[3] = SIZECLASS_MAGIC;
+            *list = block;
+            sizeClassCached += bsize;
+
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_INFO)
+            kprintf("MEM_free(%lx) --> remaining = %d", (u32) ptr, MEM_getFree());
+#endif
+
+            return;
+        }
+
         // mark block as free
         *block &= ~USED;
         // pack block
@@ -502,6 +657,13 @@ void MEM_free(void *ptr)
 }
 
 NO_INLINE void MEM_pack()
+{
+    // release cached blocks so they can be packed too
+    flushSizeClass();
+    packFree();
+}
+
+static void packFree()
 {
     u16* b = heap;
     u16* best = b;
@@ -559,6 +721,7 @@ NO_INLINE void MEM_pack()
 NO_INLINE bool MEM_checkIntegrity()
 {
     bool result = TRUE;
+    u16 i;
 
     // point to end of bss (start of heap)
     u32 h = (u32)&_bend;
@@ -567,7 +730,29 @@ NO_INLINE bool MEM_checkIntegrity()
     h >>= 1;
     h <<= 1;
     // size of heap available for dynamic memory allocation
-    u16 len = (u16)(MEMORY_HIGH - (h + sizeof(u16)));
+    u16 len = (u16)(MEMORY_HIGH - (h + sizeof(u16) + FRAME_SIZE));
+
+    // check size class lists
+    for(i = 0; i < SIZECLASS_NUM; i++)
+    {
+        u16* b = sizeClassList[i];
+
+        while(b != NULL)
+        {
+            if ((b < heap) || (b >= heapEnd) || (*b != ((i << SIZECLASS_SFT) | USED)) || (b[3] != SIZECLASS_MAGIC))
+            {
+                KDebug_Alert("MEM_checkIntegrity: size class list corrupted !");
+                KDebug_Alert("Size class:");
+                kprintf("%d", i << SIZECLASS_SFT);
+                KDebug_Alert("Block:");
+                kprintf("%08lx", (u32) b);
+                result = FALSE;
+                break;
+            }
+
+            b = *((u16**) (b + 1));
+        }
+    }
 
     if ((MEM_getFree() + MEM_getAllocated()) != len)
     {
@@ -581,6 +766,14 @@ NO_INLINE bool MEM_checkIntegrity()
         result = FALSE;
     }
 
+    if (frameHighWater > FRAME_SIZE)
+    {
+        KDebug_Alert("MEM_checkIntegrity: frame arena overflow !");
+        KDebug_Alert("Frame arena high water:");
+        kprintf("%05d", frameHighWater);
+        result = FALSE;
+    }
+
     u32 stackAdr = SYS_getStackPointer();
     // check if stack pointer is outside its range
     if (stackAdr < MEMORY_HIGH)
@@ -657,6 +850,36 @@ NO_INLINE void MEM_dump()
         KDebug_Alert("");
     }
 
+    KDebug_Alert(" Size class cached blocks:");
+
+    u16 i;
+    for(i = 0; i < SIZECLASS_NUM; i++)
+    {
+        u16 num = 0;
+
+        b = sizeClassList[i];
+        while(b != NULL)
+        {
+            num++;
+            b = *((u16**) (b + 1));
+        }
+
+        if (num)
+        {
+            strcpy(str, "    ");
+            intToStr(i << SIZECLASS_SFT, strNum, 0);
+            strcat(str, strNum);
+            strcat(str, " x ");
+            intToStr(num, strNum, 0);
+            strcat(str, strNum);
+            KDebug_Alert(str);
+        }
+    }
+
+    // cached blocks are seen as used in blocks list
+    memused -= sizeClassCached;
+    memfree += sizeClassCached;
+
     KDebug_Alert("Total used:");
     KDebug_AlertNumber(memused);
     KDebug_Alert("Total free:");
@@ -687,6 +910,86 @@ NO_INLINE void MEM_dump()
 //    *block = bsize;
 //}
 
+/*
+ * First fit search of a free block of given size (pack memory if needed)
+ */
+static u16* findBlock(u16 nsize)
+{
+    // pack memory if requested
+    if (needPack) packFree();
+
+    u16* p = free;
+
+    // block is not big enough ?
+    if (nsize > *p)
+    {
+        // find the first big enough free block
+        while (*p && (nsize > *p))
+        {
+            // next block
+            p += *p >> 1;
+            // bypass used blocks
+            while(*p & USED) p += *p >> 1;
+        }
+
+        // reached end of heap ? --> try to pack memory
+        if (*p == 0) return pack(nsize);
+    }
+
+    return p;
+}
+
+/*
+ * Return TRUE if block is present in its size class list
+ */
+static bool isSizeClassCached(u16* block)
+{
+    const u16 bsize = *block & ~USED;
+
+    if ((bsize < SIZECLASS_MIN) || (bsize > SIZECLASS_MAX) || (bsize & 3)) return FALSE;
+
+    u16* b = sizeClassList[bsize >> SIZECLASS_SFT];
+
+    while(b != NULL)
+    {
+        if (b == block) return TRUE;
+        b = *((u16**) (b + 1));
+    }
+
+    return FALSE;
+}
+
+/*
+ * Release all blocks cached in size class lists
+ */
+static void flushSizeClass()
+{
+    u16 i;
+
+    if (sizeClassCached == 0) return;
+
+    for(i = 0; i < SIZECLASS_NUM; i++)
+    {
+        u16* b = sizeClassList[i];
+
+        while(b != NULL)
+        {
+            u16* next = *((u16**) (b + 1));
+
+            // mark block as free (and not anymore cached)
+            *b &= ~USED;
+            b[3] = 0;
+            b = next;
+        }
+
+        sizeClassList[i] = NULL;
+    }
+
+    sizeClassCached = 0;
+    // request packing on next allocation
+    needPack = TRUE;
+}
+
 /*
  * Pack free blocks and return first free block matching size
  */
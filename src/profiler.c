@@ -0,0 +1,320 @@
+#include "config.h"
+#include "types.h"
+
+#include "profiler.h"
+
+#include "sys.h"
+#include "vdp.h"
+#include "timer.h"
+#include "memory.h"
+#include "tools.h"
+
+
+#if (ENABLE_PROFILER != 0)
+
+// H counter values (see timer.c)
+//
+// H40: 00-B6, E4-FF (211 steps per line), V counter increment at A5
+// H32: 00-93, E9-FF (171 steps per line), V counter increment at 85
+#define H40_LINE_LEN        211
+#define H40_JUMP_FROM       0xB6
+#define H40_JUMP_TO         0xE4
+#define H40_VINC            0xA5
+
+#define H32_LINE_LEN        171
+#define H32_JUMP_FROM       0x93
+#define H32_JUMP_TO         0xE9
+#define H32_VINC            0x85
+
+// V counter values (see timer.c)
+//
+// NTSC V28: 00-EA, E5-FF (262 lines)
+// PAL  V28: 00-FF, 00-02, CA-FF (313 lines)
+// PAL  V30: 00-FF, 00-0A, D2-FF (313 lines)
+#define NTSC_LINES          262
+#define PAL_LINES           313
+
+
+static ProfZone zones[PROF_MAX_ZONE];
+static u16 numZone;
+
+// ring buffer
+static ProfEvent events[PROF_EVENT_NUM];
+static u16 eventInd;
+static u16 eventNum;
+
+// last timestamp state
+static u32 lastStamp;
+static u32 lastPos;
+static u16 lastFrame;
+
+
+void PROF_init()
+{
+    numZone = 0;
+
+    // library zones
+    PROF_addZone("dma");
+    PROF_addZone("sprite");
+    PROF_addZone("map");
+
+    lastStamp = 0;
+    lastPos = 0;
+    lastFrame = vtimer;
+
+    PROF_reset();
+}
+
+void PROF_reset()
+{
+    ProfZone* z = zones;
+    u16 i = numZone;
+
+    while(i--)
+    {
+        z->count = 0;
+        z->lastCount = 0;
+        z->total = 0;
+        z->max = 0;
+        z->lastTotal = 0;
+        z->lastMax = 0;
+        z->peak = 0;
+        z++;
+    }
+
+    eventInd = 0;
+    eventNum = 0;
+}
+
+s16 PROF_addZone(const char* name)
+{
+    if (numZone >= PROF_MAX_ZONE)
+    {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+        kprintf("PROF_addZone(%s) failed: no more zone available (max = %d)", name, PROF_MAX_ZONE);
+#endif
+        return -1;
+    }
+
+    ProfZone* z = &zones[numZone];
+
+    memset(z, 0, sizeof(ProfZone));
+    z->name = name;
+
+    return numZone++;
+}
+
+const ProfZone* PROF_getZone(u16 zone)
+{
+    return &zones[zone];
+}
+
+
+static s32 getDelta(u16 frame, u32 pos, u32 frameLen)
+{
+    // elapsed frames since last timestamp (can be negative if vtimer is late)
+    const s16 df = frame - lastFrame;
+
+    return ((s32) pos - (s32) lastPos) + ((s32) df * (s32) frameLen);
+}
+
+u16 PROF_getLineLength()
+{
+    return (screenWidth == 320) ? H40_LINE_LEN : H32_LINE_LEN;
+}
+
+u32 PROF_getStamp()
+{
+    u16 lineLen;
+    u16 numLine;
+    u16 jump;
+    u16 ext;
+    u16 wrap;
+    u16 first;
+    u16 line;
+    u16 alt;
+    u16 hpos;
+
+    // read HV counter only once (V and H consistent)
+    const u16 hv = GET_HVCOUNTER;
+    const u16 blank = GET_VDP_STATUS(VDP_VBLANK_FLAG);
+    const u16 frame = vtimer;
+    const u16 v = hv >> 8;
+    const u16 h = hv & 0xFF;
+
+    // linear H position from V counter increment point
+    if (screenWidth == 320)
+    {
+        lineLen = H40_LINE_LEN;
+        hpos = (h > H40_JUMP_FROM) ? (h - (H40_JUMP_TO - (H40_JUMP_FROM + 1))) : h;
+        if (hpos >= H40_VINC) hpos -= H40_VINC;
+        else hpos += H40_LINE_LEN - H40_VINC;
+    }
+    else
+    {
+        lineLen = H32_LINE_LEN;
+        hpos = (h > H32_JUMP_FROM) ? (h - (H32_JUMP_TO - (H32_JUMP_FROM + 1))) : h;
+        if (hpos >= H32_VINC) hpos -= H32_VINC;
+        else hpos += H32_LINE_LEN - H32_VINC;
+    }
+
+    if (IS_PAL_SYSTEM)
+    {
+        numLine = PAL_LINES;
+        first = 0xFF;
+        if (screenHeight == 240)
+        {
+            ext = 0x0B;
+            wrap = 0xD2;
+        }
+        else
+        {
+            ext = 0x03;
+            wrap = 0xCA;
+        }
+    }
+    else
+    {
+        numLine = NTSC_LINES;
+        first = 0xEA;
+        ext = 0;
+        wrap = 0xE5;
+    }
+
+    // line offset for the last V counter segment
+    jump = numLine - 256;
+
+    // frame line from top of active display
+    line = v;
+    alt = v;
+    // V counter extension after 0xFF (PAL only)
+    if (blank && (v < ext)) line = alt = 256 + v;
+    // V counter rollback area
+    else if (v >= wrap)
+    {
+        // active display
+        if (!blank && (v < screenHeight)) line = alt = v;
+        // can be first or rollback pass
+        else if ((v >= screenHeight) && (v <= first)) alt = v + jump;
+        // rollback pass
+        else line = alt = v + jump;
+    }
+
+    const u32 frameLen = mulu(numLine, lineLen);
+    // vtimer is incremented on vblank start so adjust it to get frame index (frame starts on active display)
+    u16 f = (line >= screenHeight) ? frame - 1 : frame;
+    u32 pos = mulu(line, lineLen) + hpos;
+    s32 delta = getDelta(f, pos, frameLen);
+
+    // ambiguous line ? --> use the nearest position after last timestamp
+    if (alt != line)
+    {
+        const u16 altf = (alt >= screenHeight) ? frame - 1 : frame;
+        const u32 altPos = mulu(alt, lineLen) + hpos;
+        const s32 altDelta = getDelta(altf, altPos, frameLen);
+
+        if ((altDelta >= 0) && ((delta < 0) || (altDelta < delta)))
+        {
+            f = altf;
+            pos = altPos;
+            delta = altDelta;
+        }
+    }
+
+    // vtimer not yet updated (interrupts disabled) ? --> consider next frame
+    if (delta < 0)
+    {
+        delta += frameLen;
+        f++;
+    }
+    // still negative ? --> keep timestamp monotonic
+    if (delta < 0) delta = 0;
+
+    lastPos = pos;
+    lastFrame = f;
+    lastStamp += delta;
+
+    return lastStamp;
+}
+
+
+void PROF_begin(u16 zone)
+{
+    zones[zone].start = PROF_getStamp();
+}
+
+void PROF_end(u16 zone)
+{
+    ProfZone* z = &zones[zone];
+    const u32 start = z->start;
+    const u32 duration = PROF_getStamp() - start;
+
+    // frame aggregation
+    z->count++;
+    z->total += duration;
+    if (duration > z->max) z->max = duration;
+
+    // store in ring buffer
+    ProfEvent* e = &events[eventInd];
+    e->zone = zone;
+    e->frame = vtimer;
+    e->start = start;
+    e->duration = duration;
+
+    eventInd = (eventInd + 1) & (PROF_EVENT_NUM - 1);
+    if (eventNum < PROF_EVENT_NUM) eventNum++;
+}
+
+
+void PROF_frame()
+{
+    ProfZone* z = zones;
+    u16 i = numZone;
+
+    while(i--)
+    {
+        z->lastCount = z->count;
+        z->lastTotal = z->total;
+        z->lastMax = z->max;
+        if (z->max > z->peak) z->peak = z->max;
+
+        z->count = 0;
+        z->total = 0;
+        z->max = 0;
+        z++;
+    }
+}
+
+
+void PROF_dump()
+{
+    ProfZone* z = zones;
+    u16 i;
+
+    kprintf("PROF_HDR;%lu;%u;%u", (u32) vtimer, PROF_getLineLength(), IS_PAL_SYSTEM ? PAL_LINES : NTSC_LINES);
+
+    for(i = 0; i < numZone; i++, z++)
+    {
+        // no activity --> skip
+        if (z->lastCount == 0) continue;
+
+        kprintf("PROF;%lu;%s;%u;%lu;%lu;%lu", (u32) vtimer, z->name, z->lastCount, z->lastTotal, z->lastMax, z->peak);
+    }
+}
+
+void PROF_dumpEvents()
+{
+    u16 ind = (eventInd - eventNum) & (PROF_EVENT_NUM - 1);
+    u16 i = eventNum;
+
+    while(i--)
+    {
+        const ProfEvent* e = &events[ind];
+
+        kprintf("PROF_EVT;%u;%s;%lu;%lu", e->frame, zones[e->zone].name, e->start, e->duration);
+
+        ind = (ind + 1) & (PROF_EVENT_NUM - 1);
+    }
+}
+
+#endif  // ENABLE_PROFILER
@@ -18,6 +18,7 @@
 #include "kdebug.h"
 #include "string.h"
 #include "timer.h"
+#include "profiler.h"
 
 
 //#define SPR_DEBUG
@@ -34,6 +35,13 @@
 // hardware cannot handle more than 80 sprites anyway
 #define MAX_SPRITE                          80
 
+// multiplexing scanline usage is measured by band of 8 scanlines (max screen height = 240)
+#define MULTIPLEX_BAND_NUM                  30
+
+// shared VRAM tileset table size (power of 2, greater than MAX_SPRITE so it never get full)
+#define SHARED_TILESET_SIZE                 128
+#define SHARED_TILESET_MASK                 (SHARED_TILESET_SIZE - 1)
+
 // internals
 #define VISIBILITY_ON                       0xFFFF
 #define VISIBILITY_OFF                      0x0000
@@ -44,11 +52,55 @@
 #define NEED_VISIBILITY_UPDATE              0x0001
 #define NEED_FRAME_UPDATE                   0x0002
 #define NEED_TILES_UPLOAD                   0x0004
+#define NEED_TILES_DELTA                    0x0008
 
 #define NEED_UPDATE                         0x000F
 
+// first sprite resource format (SpriteDefinition.format) having Animation.deltas field
+#define RES_FORMAT_TILE_DELTA               2
+
 #define STATE_ANIMATION_DONE                0x0010
 
+// shared VRAM tileset entry (SPR_FLAG_SHARED_VRAM)
+typedef struct
+{
+    const TileSet* tileset;
+    u16 vramInd;
+    u8 refCount;
+    u8 uploaded;
+} SharedTileSet;
+
+// number of bucket for deferred depth sorting (radix sort on 4 bits digit)
+#define SORT_BUCKET_NUM                     16
+
+// group of SAT entries for a sprite (multiplexing)
+typedef struct
+{
+    u8 start;
+    u8 num;
+} MultiplexGroup;
+
+// multiplexing state
+typedef struct
+{
+    u16 numGroup;
+    u16 numPrioGroup;
+    u16 offset;
+    u16 overflowSprites;
+    u16 overflowScanlines;
+    u8 bandSprites[MULTIPLEX_BAND_NUM];
+    u16 bandPixels[MULTIPLEX_BAND_NUM];
+    MultiplexGroup groups[MAX_SPRITE];
+    MultiplexGroup prioGroups[MAX_SPRITE];
+} Multiplexer;
+
+// visibility mask for given number of VDP sprite
+static const u16 visibilityMask[17] =
+{
+    0x0000, 0x8000, 0xC000, 0xE000, 0xF000, 0xF800, 0xFC00, 0xFE00,
+    0xFF00, 0xFF80, 0xFFC0, 0xFFE0, 0xFFF0, 0xFFF8, 0xFFFC, 0xFFFE,
+    0xFFFF
+};
 
 
 // shared from vdp_spr.c unit
@@ -67,8 +119,15 @@ static u16 updateFrame(Sprite* sprite, u16 status);
 
 //static VDPSprite* updateSpriteTable(Sprite* sprite, VDPSprite* vdpSprite);
 
-static void loadTiles(Sprite* sprite);
+static bool loadTiles(Sprite* sprite, u16 visibility);
+static bool loadTileDelta(Sprite* sprite, const FrameTileDelta* delta);
+static const FrameTileDelta* getTileDelta(Sprite* sprite, u16 status);
+static SharedTileSet* findSharedTileSet(const TileSet* tileset);
+static SharedTileSet* acquireSharedTileSet(const TileSet* tileset);
+static void releaseSharedTileSet(const TileSet* tileset);
+static void updateMultiplexing(u16 numEntry);
 static Sprite* sortSprite(Sprite* sprite);
+static void sortSprites(void);
 static void moveAfter(Sprite* pos, Sprite* sprite);
 static u16 getSpriteIndex(Sprite* sprite);
 static void logSprite(Sprite* sprite);
@@ -89,6 +148,16 @@ static VRAMRegion vram;
 // size of VRAM allocated for Sprite Engine
 u16 spriteVramSize;
 
+// shared VRAM tileset hash table (allocated on first shared sprite)
+static SharedTileSet* sharedTileSets;
+
+// multiplexing state (NULL if multiplexing is disabled)
+static Multiplexer* multiplexer;
+
+// deferred depth sorting (sprite list is sorted once in SPR_update)
+static bool deferredSort;
+static bool needSort;
+
 #ifdef SPR_PROFIL
 
 
@@ -112,15 +181,22 @@ u16 spriteVramSize;
 #define PROFIL_LOADTILES                17
 #define PROFIL_SORT                     18
 #define PROFIL_VRAM_DEFRAG              19
+#define PROFIL_MULTIPLEX                20
 
-static u32 profil_time[20];
+static u32 profil_time[21];
 #endif
 
 
 NO_INLINE void SPR_initEx(u16 vramSize)
 {
     // end it first (if initialized)
-    SPR_end();
+    if (SPR_isInitialized()) SPR_end();
+    // not initialized --> memory was re-initialized (soft reset) or already released so remaining pointers are stale
+    else
+    {
+        sharedTileSets = NULL;
+        multiplexer = NULL;
+    }
 
     // create sprites object pool
     spritesPool = POOL_create(MAX_SPRITE, sizeof(Sprite));
@@ -135,6 +211,8 @@ NO_INLINE void SPR_initEx(u16 vramSize)
 
     // disable VDP sprite check by default
     usedVDPSprite = 0;
+    // immediate depth sorting by default (pending sort is cleared by SPR_reset)
+    deferredSort = FALSE;
 
 #if (LIB_LOG_LEVEL >= LOG_LEVEL_INFO)
     KLog("Sprite engine initialized !");
@@ -162,9 +240,15 @@ NO_INLINE void SPR_end()
         VDP_resetSprites();
         VDP_updateSprites(1, DMA_QUEUE);
 
-        // release memory
+        // release memory (multiplexing first as it requires initialized state)
+        SPR_disableMultiplexing();
         POOL_destroy(spritesPool);
         spritesPool = NULL;
+        if (sharedTileSets)
+        {
+            MEM_free(sharedTileSets);
+            sharedTileSets = NULL;
+        }
         VRAM_releaseRegion(&vram);
         spriteVramSize = 0;
 
@@ -196,11 +280,15 @@ void SPR_reset()
 
     // clear VRAM region
     VRAM_clearRegion(&vram);
+    // and shared tilesets
+    if (sharedTileSets) memset(sharedTileSets, 0, SHARED_TILESET_SIZE * sizeof(SharedTileSet));
     // reset VDP sprite (allocation and display)
     VDP_resetSprites();
 
     // clear used VDP sprite (only keep check VDP sprite flag)
     usedVDPSprite &= CHECK_VDP_SPRITE;
+    // nothing to sort
+    needSort = FALSE;
 
 #ifdef SPR_PROFIL
     memset(profil_time, 0, sizeof(profil_time));
@@ -326,6 +414,29 @@ Sprite* NO_INLINE SPR_addSpriteEx(const SpriteDefinition* spriteDef, s16 x, s16
     s16 ind;
     Sprite* sprite;
 
+    // shared VRAM replaces auto VRAM allocation and requires auto tile upload
+    if (flag & SPR_FLAG_SHARED_VRAM)
+    {
+        flag &= ~SPR_FLAG_AUTO_VRAM_ALLOC;
+        flag |= SPR_FLAG_AUTO_TILE_UPLOAD;
+
+        // allocate shared tileset table on first use
+        if (sharedTileSets == NULL)
+        {
+            sharedTileSets = MEM_alloc(SHARED_TILESET_SIZE * sizeof(SharedTileSet));
+
+            if (sharedTileSets == NULL)
+            {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+                KLog("SPR_addSpriteEx failed: not enough memory for shared VRAM tileset table !");
+#endif
+                return NULL;
+            }
+
+            memset(sharedTileSets, 0, SHARED_TILESET_SIZE * sizeof(SharedTileSet));
+        }
+    }
+
     // allocate new sprite
     sprite = allocateSprite(flag & SPR_FLAG_INSERT_HEAD);
 
@@ -382,6 +493,7 @@ Sprite* NO_INLINE SPR_addSpriteEx(const SpriteDefinition* spriteDef, s16 x, s16
     if (flag & SPR_FLAG_AUTO_VISIBILITY) sprite->visibility = 0;
     // otherwise we set it to visible by default
     else sprite->visibility = VISIBILITY_ON;
+    sprite->uploadVisibility = 0;
     // initialized with specified flag
     sprite->definition = spriteDef;
     sprite->onFrameChange = NULL;
@@ -422,6 +534,25 @@ Sprite* NO_INLINE SPR_addSpriteEx(const SpriteDefinition* spriteDef, s16 x, s16
         KLog_U3("  allocated ", spriteDef->maxNumTile, " tiles in VRAM at ", ind, ", remaining VRAM: ", VRAM_getFree(&vram));
 #endif // SPR_DEBUG
     }
+    // shared VRAM enabled ?
+    else if (flag & SPR_FLAG_SHARED_VRAM)
+    {
+        AnimationFrame* frame = spriteDef->animations[0]->frames[0];
+        // get VRAM for first frame tileset (may already be allocated by another sprite)
+        SharedTileSet* shared = acquireSharedTileSet(frame->tileset);
+
+        // not enough VRAM --> release sprite and return NULL
+        if (shared == NULL)
+        {
+            releaseSprite(sprite);
+            return NULL;
+        }
+
+        // first frame is considered as set (so frame update only changes shared tileset if needed)
+        sprite->frame = frame;
+        // set VRAM index and preserve specific attributs from parameter
+        sprite->attribut = shared->vramInd | (attribut & TILE_ATTR_MASK);
+    }
     // just use the given attribut
     else sprite->attribut = attribut;
 
@@ -497,6 +628,9 @@ void SPR_releaseSprite(Sprite* sprite)
         KLog_U3("  released ", sprite->definition->maxNumTile, " tiles in VRAM at ", sprite->attribut & TILE_INDEX_MASK, ", remaining VRAM: ", VRAM_getFree(&vram));
 #endif // SPR_DEBUG
     }
+    // shared VRAM enabled --> release current frame tileset
+    else if (status & SPR_FLAG_SHARED_VRAM)
+        releaseSharedTileSet(sprite->frame->tileset);
 
     END_PROFIL(PROFIL_REMOVE_SPRITE)
 }
@@ -532,6 +666,67 @@ void SPR_disableVDPSpriteChecking()
     usedVDPSprite &= ~CHECK_VDP_SPRITE;
 }
 
+bool SPR_enableMultiplexing()
+{
+    // multiplexing state is released with the sprite engine
+    if (!SPR_isInitialized())
+    {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+        KLog("SPR_enableMultiplexing failed: sprite engine not initialized !");
+#endif
+        return FALSE;
+    }
+
+    // already enabled
+    if (multiplexer) return TRUE;
+
+    multiplexer = MEM_alloc(sizeof(Multiplexer));
+
+    if (multiplexer == NULL)
+    {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+        KLog("SPR_enableMultiplexing failed: not enough memory !");
+#endif
+        return FALSE;
+    }
+
+    memset(multiplexer, 0, sizeof(Multiplexer));
+
+    return TRUE;
+}
+
+void SPR_disableMultiplexing()
+{
+    if (multiplexer)
+    {
+        // sprite engine not initialized --> pointer is stale (memory re-initialized on soft reset), don't release it
+        if (SPR_isInitialized()) MEM_free(multiplexer);
+        multiplexer = NULL;
+    }
+}
+
+void SPR_enableDeferredSorting()
+{
+    deferredSort = TRUE;
+}
+
+void SPR_disableDeferredSorting()
+{
+    // sort now to restore immediate sorting consistency
+    if (needSort) sortSprites();
+    deferredSort = FALSE;
+}
+
+u16 SPR_getOverflowSprites()
+{
+    return multiplexer ? multiplexer->overflowSprites : 0;
+}
+
+u16 SPR_getOverflowScanlines()
+{
+    return multiplexer ? multiplexer->overflowScanlines : 0;
+}
+
 NO_INLINE void SPR_defragVRAM()
 {
     START_PROFIL
@@ -545,12 +740,52 @@ NO_INLINE void SPR_defragVRAM()
     // and re-create it
     VRAM_createRegion(&vram, TILE_SPRITE_INDEX, spriteVramSize);
 
+    // re-allocate VRAM for shared tilesets first (can't fail here)
+    if (sharedTileSets)
+    {
+        SharedTileSet* shared = sharedTileSets;
+        u16 i = SHARED_TILESET_SIZE;
+
+        while(i--)
+        {
+            const TileSet* tileset = shared->tileset;
+
+            if (tileset && tileset->numTile)
+            {
+                const u16 ind = VRAM_alloc(&vram, tileset->numTile);
+
+                // VRAM allocation changed ? --> need to re upload tiles
+                if (shared->vramInd != ind)
+                {
+                    shared->vramInd = ind;
+                    shared->uploaded = FALSE;
+                }
+            }
+
+            shared++;
+        }
+    }
+
     // iterate over all sprites to re-allocate auto allocated VRAM
     sprite = firstSprite;
     while(sprite)
     {
         u16 status = sprite->status;
 
+        // sprite is using shared VRAM ? --> just get the shared tileset VRAM index
+        if (status & SPR_FLAG_SHARED_VRAM)
+        {
+            const u16 ind = findSharedTileSet(sprite->frame->tileset)->vramInd;
+            const u16 attr = sprite->attribut;
+
+            // VRAM allocation changed ? --> tiles are uploaded again from SPR_update()
+            if ((attr & TILE_INDEX_MASK) != ind)
+            {
+                sprite->attribut = ind | (attr & TILE_ATTR_MASK);
+                sprite->status = status | NEED_TILES_UPLOAD;
+            }
+        }
+
         // sprite is using auto VRAM allocation ?
         if (status & SPR_FLAG_AUTO_VRAM_ALLOC)
         {
@@ -886,10 +1121,34 @@ NO_INLINE bool SPR_setDefinition(Sprite* sprite, const SpriteDefinition* spriteD
 #endif // SPR_DEBUG
     }
 
+    // shared VRAM enabled --> switch to first frame tileset of new definition
+    if (status & SPR_FLAG_SHARED_VRAM)
+    {
+        AnimationFrame* frame = spriteDef->animations[0]->frames[0];
+        // acquire new tileset first so sprite stays unchanged on failure
+        SharedTileSet* shared = acquireSharedTileSet(frame->tileset);
+
+        // not enough VRAM --> return error
+        if (shared == NULL)
+        {
+            // revert back used VDP sprite
+            usedVDPSprite -= spriteDef->maxNumSprite;
+            usedVDPSprite += sprite->definition->maxNumSprite;
+
+            return FALSE;
+        }
+
+        releaseSharedTileSet(sprite->frame->tileset);
+
+        // preserve the attributes and just overwrite VRAM index
+        sprite->attribut = (sprite->attribut & TILE_ATTR_MASK) | shared->vramInd;
+        sprite->frame = frame;
+    }
+    else sprite->frame = NULL;
+
     sprite->definition = spriteDef;
 //    FIXME: not needed
 //    sprite->animation = NULL;
-    sprite->frame = NULL;
     sprite->animInd = -1;
     sprite->frameInd = -1;
 //    sprite->seqInd = -1;
@@ -1106,9 +1365,11 @@ void SPR_setDepth(Sprite* sprite, s16 value)
         KLog_U2("SPR_setDepth: #", getSpriteIndex(sprite), "  Depth=", value);
 #endif // SPR_DEBUG
 
-        // set depth and sort sprite (need to be done immediately to get consistent sort)
         sprite->depth = value;
-        sortSprite(sprite);
+        // deferred sorting ? --> full sort will be done on next SPR_update()
+        if (deferredSort) needSort = TRUE;
+        // sort sprite (need to be done immediately to get consistent sort)
+        else sortSprite(sprite);
     }
 
     END_PROFIL(PROFIL_SET_ATTRIBUTE)
@@ -1340,7 +1601,30 @@ bool SPR_setVRAMTileIndex(Sprite* sprite, s16 value)
     u16 status = sprite->status;
     u16 oldAttribut = sprite->attribut;
 
-    if (status & SPR_FLAG_AUTO_VRAM_ALLOC)
+    if (status & SPR_FLAG_SHARED_VRAM)
+    {
+        // pass to manual allocation
+        if (value != -1)
+        {
+            // remove shared VRAM flag and release current shared tileset
+            status &= ~SPR_FLAG_SHARED_VRAM;
+            releaseSharedTileSet(sprite->frame->tileset);
+            // set fixed VRAM index
+            newInd = value;
+
+#ifdef SPR_DEBUG
+            KLog_U2("SPR_setVRAMTileIndex: #", getSpriteIndex(sprite), " passed from shared to manual allocation, VRAM index =", value);
+#endif // SPR_DEBUG
+        }
+        // already automatic (shared) --> just return TRUE
+        else
+        {
+            END_PROFIL(PROFIL_SET_VRAM_IND)
+
+            return TRUE;
+        }
+    }
+    else if (status & SPR_FLAG_AUTO_VRAM_ALLOC)
     {
         // pass to manual allocation
         if (value != -1)
@@ -1430,6 +1714,15 @@ void SPR_setDelayedFrameUpdate(Sprite* sprite, bool value)
     else sprite->status |= SPR_FLAG_DISABLE_DELAYED_FRAME_UPDATE;
 }
 
+void SPR_setMultiplexPriority(Sprite* sprite, bool value)
+{
+    // for debug
+    checkSpriteValid(sprite, "SPR_setMultiplexPriority");
+
+    if (value) sprite->status |= SPR_FLAG_MULTIPLEX_PRIORITY;
+    else sprite->status &= ~SPR_FLAG_MULTIPLEX_PRIORITY;
+}
+
 void SPR_setFrameChangeCallback(Sprite* sprite, FrameChangeCallback* callback)
 {
     // for debug
@@ -1563,6 +1856,10 @@ void SPR_clear()
 NO_INLINE void SPR_update()
 {
     START_PROFIL
+    PROF_BEGIN(PROF_ZONE_SPRITE);
+
+    // deferred depth sorting ? --> sort whole list now
+    if (needSort) sortSprites();
 
     Sprite* sprite = firstSprite;
     // SAT pointer
@@ -1577,6 +1874,23 @@ NO_INLINE void SPR_update()
         vdpSprite->link = vdpSpriteInd++;
         vdpSprite++;
     }
+    // multiplexing needs a fixed list head as sprite order can change
+    else if (multiplexer)
+    {
+        // off screen
+        vdpSprite->y = 0;
+        vdpSprite->size = SPRITE_SIZE(1, 1);
+        vdpSprite->link = vdpSpriteInd++;
+        vdpSprite->attribut = 0;
+        vdpSprite->x = 0;
+        vdpSprite++;
+    }
+
+    if (multiplexer)
+    {
+        multiplexer->numGroup = 0;
+        multiplexer->numPrioGroup = 0;
+    }
 
 #ifdef SPR_DEBUG
     KLog_U1("----------------- SPR_update:  sprite number = ", SPR_getNumActiveSprite());
@@ -1586,6 +1900,8 @@ NO_INLINE void SPR_update()
     while(sprite)
     {
         s16 timer = sprite->timer;
+        // first SAT entry for this sprite
+        const u8 startInd = vdpSpriteInd;
 
 #ifdef SPR_DEBUG
         char str1[32];
@@ -1618,18 +1934,69 @@ NO_INLINE void SPR_update()
         // sprite visible and still allocated (can be released during updateFrame(..) with the frame change callback) with enough entry in SAT ?
         if (sprite->visibility && (status & ALLOCATED) && (vdpSpriteInd <= SAT_MAX_SIZE))
         {
-            if (status & NEED_TILES_UPLOAD)
+            AnimationFrame* frame = sprite->frame;
+            s8 numSprite = frame->numSprite;
+            // upload failure (DMA queue or temp buffer full) --> keep upload pending to retry on next update
+            u16 uploadRetry = 0;
+
+            // shared VRAM --> whole tileset is uploaded only once (by the first visible sprite using it)
+            if (status & SPR_FLAG_SHARED_VRAM)
+            {
+                if (status & NEED_TILES_UPLOAD)
+                {
+                    SharedTileSet* shared = findSharedTileSet(frame->tileset);
+
+                    if (!shared->uploaded)
+                    {
+                        if (loadTiles(sprite, visibilityMask[(numSprite < 0) ? 1 : (u8) numSprite])) shared->uploaded = TRUE;
+                        else uploadRetry = NEED_TILES_UPLOAD;
+                    }
+                }
+            }
+            else
             {
-                loadTiles(sprite);
-                // tiles upload and sprite table done
-                status &= ~NEED_TILES_UPLOAD;
+                const FrameTileDelta* delta = NULL;
+
+                // frame reached from previous frame which is still in VRAM ? --> only upload changed tiles
+                if (status & NEED_TILES_DELTA)
+                {
+                    const Animation* anim = sprite->animation;
+
+                    // VRAM location changed, frame update pending or resource without deltas ? --> can't use delta
+                    if (!(status & NEED_TILES_UPLOAD) && (sprite->definition->format >= RES_FORMAT_TILE_DELTA) && anim->deltas && (anim->frames[sprite->frameInd] == frame))
+                        delta = anim->deltas[sprite->frameInd];
+                    if (delta == NULL) status |= NEED_TILES_UPLOAD;
+                }
+
+                if (delta)
+                {
+                    // all tiles of frame are now in VRAM
+                    if (loadTileDelta(sprite, delta)) sprite->uploadVisibility = visibilityMask[(numSprite < 0) ? 1 : (u8) numSprite];
+                    // delta upload failed (DMA queue or temp buffer full) --> frame tiles aren't in VRAM, upload visible VDP sprites tiles below
+                    else sprite->uploadVisibility = 0;
+                }
+                // new frame or VRAM location --> need to upload all visible VDP sprite tiles
+                else if (status & NEED_TILES_UPLOAD) sprite->uploadVisibility = 0;
+                // upload tiles of visible VDP sprites not yet uploaded (a VDP sprite can become visible without frame change)
+                if (status & (SPR_FLAG_AUTO_TILE_UPLOAD | NEED_TILES_UPLOAD))
+                {
+                    const u16 toUpload = sprite->visibility & ~sprite->uploadVisibility & visibilityMask[(numSprite < 0) ? 1 : (u8) numSprite];
+
+                    if (toUpload)
+                    {
+                        if (loadTiles(sprite, toUpload)) sprite->uploadVisibility |= toUpload;
+                        // upload failed --> auto upload retries missing VDP sprites tiles on next update, otherwise keep upload pending
+                        else if (!(status & SPR_FLAG_AUTO_TILE_UPLOAD)) uploadRetry = NEED_TILES_UPLOAD;
+                    }
+                }
             }
+            // tiles upload done
+            status &= ~(NEED_TILES_UPLOAD | NEED_TILES_DELTA);
+            status |= uploadRetry;
 
             // update SAT now
-            AnimationFrame* frame = sprite->frame;
             FrameVDPSprite* frameSprite = frame->frameVDPSprites;
             u16 attr = sprite->attribut;
-            s8 numSprite = frame->numSprite;
 
             // special case of single VDP sprite with size aligned to sprite size (no offset, no flip calculation required)
             if (numSprite < 0)
@@ -1643,13 +2010,6 @@ NO_INLINE void SPR_update()
             }
             else
             {
-                static const u16 visibilityMask[17] =
-                {
-                    0x0000, 0x8000, 0xC000, 0xE000, 0xF000, 0xF800, 0xFC00, 0xFE00,
-                    0xFF00, 0xFF80, 0xFFC0, 0xFFE0, 0xFFF0, 0xFFF8, 0xFFFC, 0xFFFE,
-                    0xFFFF
-                };
-
                 // so visibility also allow to get the number of sprite
                 s16 visibility = (s16)(sprite->visibility & visibilityMask[(u8) numSprite]);
 
@@ -1766,6 +2126,19 @@ NO_INLINE void SPR_update()
             }
         }
 
+        // multiplexing enabled and sprite added some SAT entries ? --> store them as a group
+        if (multiplexer && (vdpSpriteInd != startInd))
+        {
+            MultiplexGroup* group;
+
+            if (status & SPR_FLAG_MULTIPLEX_PRIORITY) group = &multiplexer->prioGroups[multiplexer->numPrioGroup++];
+            else group = &multiplexer->groups[multiplexer->numGroup++];
+
+            // vdpSpriteInd is 1 ahead of SAT entry index
+            group->start = startInd - 1;
+            group->num = vdpSpriteInd - startInd;
+        }
+
         // processes done
         sprite->status = status;
         // next sprite
@@ -1788,6 +2161,9 @@ NO_INLINE void SPR_update()
         vdpSprite--;
         // mark as end
         vdpSprite->link = 0;
+
+        // multiplexing enabled ? --> measure scanlines usage and change sprite order if needed
+        if (multiplexer) updateMultiplexing(vdpSpriteInd);
         // send sprites to VRAM using DMA queue
         DMA_queueDmaFast(DMA_VRAM, vdpSpriteCache, VDP_SPRITE_TABLE, vdpSpriteInd * (sizeof(VDPSprite) / 2), 2);
     }
@@ -1801,6 +2177,7 @@ NO_INLINE void SPR_update()
         DMA_queueDmaFast(DMA_VRAM, vdpSpriteCache, VDP_SPRITE_TABLE, 1 * (sizeof(VDPSprite) / 2), 2);
     }
 
+    PROF_END(PROF_ZONE_SPRITE);
     END_PROFIL(PROFIL_UPDATE)
 }
 
@@ -1814,7 +2191,7 @@ void SPR_logProfil()
     KLog_U2x(4, "Set Def.=", profil_time[PROFIL_SET_DEF], " Set Attr.=", profil_time[PROFIL_SET_ATTRIBUTE]);
     KLog_U2x(4, "Set Anim & Frame=", profil_time[PROFIL_SET_ANIM_FRAME], " Set VRAM Ind=", profil_time[PROFIL_SET_VRAM_IND]);
     KLog_U2x(4, "Set Visibility=", profil_time[PROFIL_SET_VISIBILITY], "  Clear=", profil_time[PROFIL_CLEAR]);
-    KLog_U1x(4, "Sort Sprite list=", profil_time[PROFIL_SORT]);
+    KLog_U2x(4, "Sort Sprite list=", profil_time[PROFIL_SORT], " Multiplexing=", profil_time[PROFIL_MULTIPLEX]);
     KLog_U1x_(4, " Update all=", profil_time[PROFIL_UPDATE], " -------------");
     KLog_U2x(4, "Update visibility=", profil_time[PROFIL_UPDATE_VISIBILITY], "  Update frame=", profil_time[PROFIL_UPDATE_FRAME]);
     KLog_U2x(4, "Update vdp_spr_ind=", profil_time[PROFIL_UPDATE_VDPSPRIND], "  Update vis spr table=", profil_time[PROFIL_UPDATE_VISTABLE]);
@@ -2036,17 +2413,33 @@ static u16 updateFrame(Sprite* sprite, u16 status)
 #endif // SPR_DEBUG
 
     AnimationFrame* frame = sprite->animation->frames[sprite->frameInd];
+    const TileSet* tileset = frame->tileset;
+    // shared VRAM and tileset change ?
+    const bool sharedChange = (status & SPR_FLAG_SHARED_VRAM) && (sprite->frame->tileset != tileset);
+    SharedTileSet* shared = NULL;
+
+    // shared tileset already loaded ? --> no tiles data to transfer
+    if (status & SPR_FLAG_SHARED_VRAM)
+    {
+        shared = findSharedTileSet(tileset);
+        if (shared && !shared->uploaded) shared = NULL;
+    }
+
+    // frame reached from previous frame of animation sequence ? --> only changed tiles need to be uploaded
+    const FrameTileDelta* delta = getTileDelta(sprite, status);
 
     // we need to transfert tiles data for this sprite and frame delay is not disabled ?
-    if ((status & (SPR_FLAG_AUTO_TILE_UPLOAD | SPR_FLAG_DISABLE_DELAYED_FRAME_UPDATE)) == SPR_FLAG_AUTO_TILE_UPLOAD)
+    if ((shared == NULL) && ((status & (SPR_FLAG_AUTO_TILE_UPLOAD | SPR_FLAG_DISABLE_DELAYED_FRAME_UPDATE)) == SPR_FLAG_AUTO_TILE_UPLOAD))
     {
         // not enough DMA capacity to transfer sprite tile data ?
         const u16 dmaCapacity = DMA_getMaxTransferSize();
+        // only changed tiles are uploaded with delta
+        const u16 uploadSize = (delta ? delta->numTile : tileset->numTile) * 32;
 
-        if (dmaCapacity && ((DMA_getQueueTransferSize() + (frame->tileset->numTile * 32)) > dmaCapacity))
+        if (dmaCapacity && ((DMA_getQueueTransferSize() + uploadSize) > dmaCapacity))
         {
 #if (LIB_LOG_LEVEL >= LOG_LEVEL_WARNING)
-            KLog_U4_("Warning: sprite #", getSpriteIndex(sprite), " update delayed on frame #", vtimer, " - exceeding DMA capacity: ", DMA_getQueueTransferSize(), " bytes already queued and require ", frame->tileset->numTile * 32, " more bytes");
+            KLog_U4_("Warning: sprite #", getSpriteIndex(sprite), " update delayed on frame #", vtimer, " - exceeding DMA capacity: ", DMA_getQueueTransferSize(), " bytes already queued and require ", uploadSize, " more bytes");
 #endif // LIB_DEBUG
 
             // initial frame update ? --> better to set frame at least
@@ -2058,6 +2451,25 @@ static u16 updateFrame(Sprite* sprite, u16 status)
         }
     }
 
+    // shared VRAM --> switch to new frame tileset
+    if (sharedChange)
+    {
+        shared = acquireSharedTileSet(tileset);
+
+        // not enough VRAM --> delay frame update (when a shared tileset will be released)
+        if (shared == NULL)
+        {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_WARNING)
+            KLog_U2_("Warning: sprite #", getSpriteIndex(sprite), " update delayed on frame #", vtimer, " - not enough VRAM for shared tileset");
+#endif // LIB_DEBUG
+
+            return status;
+        }
+
+        releaseSharedTileSet(sprite->frame->tileset);
+        sprite->attribut = (sprite->attribut & TILE_ATTR_MASK) | shared->vramInd;
+    }
+
     // set frame
     sprite->frame = frame;
     // init timer for this frame *before* frame change callback so it can modify change it if needed.
@@ -2073,9 +2485,12 @@ static u16 updateFrame(Sprite* sprite, u16 status)
         status = sprite->status;
     }
 
-    // require tile data upload
+    // require tile data upload (only changed tiles if we have a delta)
     if (status & SPR_FLAG_AUTO_TILE_UPLOAD)
-        status |= NEED_TILES_UPLOAD;
+    {
+        if (delta) status |= NEED_TILES_DELTA;
+        else status = (status & ~NEED_TILES_DELTA) | NEED_TILES_UPLOAD;
+    }
     // require visibility update
     if (status & SPR_FLAG_AUTO_VISIBILITY)
         status |= NEED_VISIBILITY_UPDATE;
@@ -2088,56 +2503,413 @@ static u16 updateFrame(Sprite* sprite, u16 status)
     return status;
 }
 
-static void loadTiles(Sprite* sprite)
+static bool queueTiles(void* from, u16 vramInd, u16 numTile, bool fromRam)
+{
+#ifdef SPR_DEBUG
+    KLog_U3("  loadTiles - queue DMA: from=", (u32) from, " to=", vramInd * 32, " size in word=", numTile * 16);
+#endif // SPR_DEBUG
+
+    // we can use FAST version as source is located in RAM
+    if (fromRam) return DMA_queueDmaFast(DMA_VRAM, from, vramInd * 32, numTile * 16, 2);
+    return DMA_queueDma(DMA_VRAM, from, vramInd * 32, numTile * 16, 2);
+}
+
+static bool loadTiles(Sprite* sprite, u16 visibility)
 {
     START_PROFIL
 
-    TileSet* tileset = sprite->frame->tileset;
+    AnimationFrame* frame = sprite->frame;
+    TileSet* tileset = frame->tileset;
     u16 lenInWord = (tileset->numTile * 32) / 2;
+    bool result = TRUE;
 
     // need to test for empty tileset (blank frame)
     if (lenInWord)
     {
         u16 compression = tileset->compression;
-
-        // TODO: separate tileset per VDP sprite and only unpack/upload visible VDP sprite (using visibility) to VRAM
+        s8 numSprite = frame->numSprite;
+        u16 vramInd = sprite->attribut & TILE_INDEX_MASK;
+        u8* tiles;
 
         // need unpacking ?
         if (compression != COMPRESSION_NONE)
         {
-            // get buffer and send to DMA queue
-            u8* buf = DMA_allocateAndQueueDma(DMA_VRAM, (sprite->attribut & TILE_INDEX_MASK) * 32, lenInWord, 2);
+            // get temp buffer from DMA queue
+            tiles = DMA_allocateTemp(lenInWord);
 
-            // unpack in temp buffer obtained from DMA queue
-            if (buf) unpack(compression, (u8*) FAR_SAFE(tileset->tiles, lenInWord * 2), buf);
+            if (!tiles)
+            {
 #if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
-            else KLog("  loadTiles: unpack tileset failed (DMA temporary buffer is full)");
+                KLog("  loadTiles: unpack tileset failed (DMA temporary buffer is full)");
 #endif
+                END_PROFIL(PROFIL_LOADTILES)
+                return FALSE;
+            }
 
-#ifdef SPR_DEBUG
-            char str1[32];
-            char str2[8];
-
-            intToHex((u32) buf, str2, 4);
-            strcpy(str1, " at ");
-            strcat(str1, str2);
+            // unpack in temp buffer obtained from DMA queue (need to unpack whole tileset anyway)
+            unpack(compression, (u8*) FAR_SAFE(tileset->tiles, lenInWord * 2), tiles);
 
-            KLog_U1_("  loadTiles: unpack tileset, numTile= ", tileset->numTile, str1);
-            KLog_U2("    Queue DMA: to=", (sprite->attribut & TILE_INDEX_MASK) * 32, " size in word=", lenInWord);
+#ifdef SPR_DEBUG
+            KLog_U2("  loadTiles: unpack tileset, numTile= ", tileset->numTile, " at ", (u32) tiles);
 #endif // SPR_DEBUG
         }
+        else tiles = (u8*) FAR_SAFE(tileset->tiles, lenInWord * 2);
+
+        // all VDP sprites to upload ? --> single transfer for whole tileset
+        if ((numSprite < 0) || (visibility == visibilityMask[(u8) numSprite]))
+            result = queueTiles(tiles, vramInd, tileset->numTile, compression != COMPRESSION_NONE);
         else
         {
-            // just queue DMA operation to transfer tileset data to VRAM
-            DMA_queueDma(DMA_VRAM, FAR_SAFE(tileset->tiles, lenInWord * 2), (sprite->attribut & TILE_INDEX_MASK) * 32, lenInWord, 2);
+            // tileset is ordered by VDP sprite so each VDP sprite tiles are contiguous
+            FrameVDPSprite* frameSprite = frame->frameVDPSprites;
+            u16 tileInd = 0;
+            u16 startInd = 0;
+            u16 numTile = 0;
+
+            while(visibility)
+            {
+                // current VDP sprite need upload ? --> extend current block
+                if ((s16) visibility < 0)
+                {
+                    if (!numTile) startInd = tileInd;
+                    numTile += frameSprite->numTile;
+                }
+                // end of block ? --> queue it
+                else if (numTile)
+                {
+                    if (!queueTiles(tiles + (startInd * 32), vramInd + startInd, numTile, compression != COMPRESSION_NONE)) result = FALSE;
+                    numTile = 0;
+                }
+
+                tileInd += frameSprite->numTile;
+                // next
+                frameSprite++;
+                visibility <<= 1;
+            }
+
+            // last block
+            if (numTile)
+            {
+                if (!queueTiles(tiles + (startInd * 32), vramInd + startInd, numTile, compression != COMPRESSION_NONE)) result = FALSE;
+            }
+        }
+    }
+
+    END_PROFIL(PROFIL_LOADTILES)
+
+    return result;
+}
+
+static bool loadTileDelta(Sprite* sprite, const FrameTileDelta* delta)
+{
+    START_PROFIL
+
+    u16 numRange = delta->numRange;
+    bool result = TRUE;
+
+    // need to test for empty delta (same tiles)
+    if (numRange)
+    {
+        TileSet* tileset = sprite->frame->tileset;
+        u16 lenInWord = (tileset->numTile * 32) / 2;
+        u16 compression = tileset->compression;
+        u16 vramInd = sprite->attribut & TILE_INDEX_MASK;
+        const u16* range = delta->ranges;
+        u8* tiles;
+
+        // need unpacking ?
+        if (compression != COMPRESSION_NONE)
+        {
+            // get temp buffer from DMA queue
+            tiles = DMA_allocateTemp(lenInWord);
+
+            if (!tiles)
+            {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+                KLog("  loadTileDelta: unpack tileset failed (DMA temporary buffer is full)");
+#endif
+                END_PROFIL(PROFIL_LOADTILES)
+                return FALSE;
+            }
+
+            // unpack in temp buffer obtained from DMA queue (need to unpack whole tileset anyway)
+            unpack(compression, (u8*) FAR_SAFE(tileset->tiles, lenInWord * 2), tiles);
+        }
+        else tiles = (u8*) FAR_SAFE(tileset->tiles, lenInWord * 2);
+
+        while(numRange--)
+        {
+            const u16 ind = *range++;
+            const u16 num = *range++;
+
+            if (!queueTiles(tiles + (ind * 32), vramInd + ind, num, compression != COMPRESSION_NONE)) result = FALSE;
+        }
+    }
+
+    END_PROFIL(PROFIL_LOADTILES)
+
+    return result;
+}
+
+static const FrameTileDelta* getTileDelta(Sprite* sprite, u16 status)
+{
+    const AnimationFrame* prev = sprite->frame;
+
+    // resource built before tile deltas ? --> Animation doesn't have the deltas field
+    if (sprite->definition->format < RES_FORMAT_TILE_DELTA)
+        return NULL;
+
+    FrameTileDelta** deltas = sprite->animation->deltas;
+
+    // no delta, no previous frame, tiles upload still pending (VRAM doesn't contain previous frame) or shared VRAM ?
+    if ((deltas == NULL) || (prev == NULL) || (status & (NEED_TILES_UPLOAD | NEED_TILES_DELTA | SPR_FLAG_SHARED_VRAM)))
+        return NULL;
+
+    const FrameTileDelta* delta = deltas[sprite->frameInd];
+
+    // not reached from the delta source frame ? (random frame change)
+    if ((delta == NULL) || (delta->from != prev))
+        return NULL;
+
+    // source frame tiles should be fully uploaded
+    const s8 numSprite = prev->numSprite;
+    const u16 mask = visibilityMask[(numSprite < 0) ? 1 : (u8) numSprite];
+
+    if ((sprite->uploadVisibility & mask) != mask)
+        return NULL;
+
+    return delta;
+}
+
+static u16 getSharedTileSetSlot(const TileSet* tileset)
+{
+    // TileSet structures are 8 bytes long
+    const u32 adr = (u32) tileset;
+    return ((u16) (adr >> 3) ^ (u16) (adr >> 10)) & SHARED_TILESET_MASK;
+}
+
+static SharedTileSet* findSharedTileSet(const TileSet* tileset)
+{
+    u16 slot = getSharedTileSetSlot(tileset);
+
+    // linear probing
+    while(TRUE)
+    {
+        SharedTileSet* shared = &sharedTileSets[slot];
+        const TileSet* t = shared->tileset;
+
+        if (t == tileset) return shared;
+        if (t == NULL) return NULL;
+
+        slot = (slot + 1) & SHARED_TILESET_MASK;
+    }
+}
+
+static SharedTileSet* acquireSharedTileSet(const TileSet* tileset)
+{
+    u16 slot = getSharedTileSetSlot(tileset);
+    SharedTileSet* shared;
+
+    // find tileset or first free slot (table can't be full as we have more slots than sprites)
+    while(TRUE)
+    {
+        shared = &sharedTileSets[slot];
+
+        // already allocated --> just increment reference
+        if (shared->tileset == tileset)
+        {
+            shared->refCount++;
+            return shared;
+        }
+        if (shared->tileset == NULL) break;
+
+        slot = (slot + 1) & SHARED_TILESET_MASK;
+    }
+
+    const u16 numTile = tileset->numTile;
+    s16 ind = TILE_SPRITE_INDEX;
+
+    // empty tileset (blank frame) doesn't need any VRAM
+    if (numTile)
+    {
+        ind = VRAM_alloc(&vram, numTile);
+        // not enough VRAM
+        if (ind < 0) return NULL;
+    }
+
+    shared->tileset = tileset;
+    shared->vramInd = ind;
+    shared->refCount = 1;
+    // tiles will be uploaded by SPR_update()
+    shared->uploaded = FALSE;
+
+#ifdef SPR_DEBUG
+    KLog_U3("  allocated shared tileset ", numTile, " tiles in VRAM at ", ind, ", remaining VRAM: ", VRAM_getFree(&vram));
+#endif // SPR_DEBUG
+
+    return shared;
+}
+
+static void releaseSharedTileSet(const TileSet* tileset)
+{
+    SharedTileSet* shared = findSharedTileSet(tileset);
+
+    // still used by another sprite ? --> done
+    if (--shared->refCount) return;
+
+    if (tileset->numTile) VRAM_free(&vram, shared->vramInd);
 
 #ifdef SPR_DEBUG
-            KLog_U3("  loadTiles - queue DMA: from=", (u32) tileset->tiles, " to=", (sprite->attribut & TILE_INDEX_MASK) * 32, " size in word=", lenInWord);
+    KLog_U3("  released shared tileset ", tileset->numTile, " tiles in VRAM at ", shared->vramInd, ", remaining VRAM: ", VRAM_getFree(&vram));
 #endif // SPR_DEBUG
+
+    // remove entry with backward shift deletion so linear probing stays valid
+    u16 hole = shared - sharedTileSets;
+    u16 slot = hole;
+
+    while(TRUE)
+    {
+        slot = (slot + 1) & SHARED_TILESET_MASK;
+
+        const TileSet* t = sharedTileSets[slot].tileset;
+        // end of cluster --> done
+        if (t == NULL) break;
+
+        const u16 home = getSharedTileSetSlot(t);
+
+        // entry home slot is cyclically in ]hole, slot] ? --> can't move it
+        if ((hole <= slot) ? ((home > hole) && (home <= slot)) : ((home > hole) || (home <= slot)))
+            continue;
+
+        // move entry in hole
+        sharedTileSets[hole] = sharedTileSets[slot];
+        hole = slot;
+    }
+
+    sharedTileSets[hole].tileset = NULL;
+}
+
+static VDPSprite* linkMultiplexGroups(VDPSprite* last, const MultiplexGroup* group, u16 num)
+{
+    while(num--)
+    {
+        u16 ind = group->start;
+        u16 n = group->num;
+
+        while(n--)
+        {
+            last->link = ind;
+            last = &vdpSpriteCache[ind++];
         }
+
+        group++;
     }
 
-    END_PROFIL(PROFIL_LOADTILES)
+    return last;
+}
+
+static void updateMultiplexing(u16 numEntry)
+{
+    START_PROFIL
+
+    Multiplexer* mux = multiplexer;
+    u8* bandSprites = mux->bandSprites;
+    u16* bandPixels = mux->bandPixels;
+    const u16 sw = screenWidth;
+    const s16 sh = screenHeight;
+    // hardware limits
+    const u16 maxSprite = sw >> 2;
+    const u16 maxLineSprite = (sw == 320) ? 20 : 16;
+    const u16 maxLinePixel = sw;
+
+    memset(bandSprites, 0, sizeof(mux->bandSprites));
+    memset(bandPixels, 0, sizeof(mux->bandPixels));
+
+    // measure scanlines usage (by band of 8 scanlines)
+    VDPSprite* vdpSprite = vdpSpriteCache;
+    u16 i = numEntry;
+
+    while(i--)
+    {
+        const u16 size = vdpSprite->size;
+        s16 top = vdpSprite->y - 0x80;
+        s16 bottom = top + (((size & 3) + 1) * 8) - 1;
+
+        // clip to screen
+        if (top < 0) top = 0;
+        if (bottom >= sh) bottom = sh - 1;
+
+        if (top <= bottom)
+        {
+            const u16 w = (((size >> 2) & 3) + 1) * 8;
+            u16 band = top >> 3;
+            u16 n = (bottom >> 3) - band + 1;
+
+            while(n--)
+            {
+                bandSprites[band]++;
+                bandPixels[band] += w;
+                band++;
+            }
+        }
+
+        vdpSprite++;
+    }
+
+    // find worst overflow
+    u16 overflow = (numEntry > maxSprite) ? (numEntry - maxSprite) : 0;
+    u16 overflowBand = 0;
+
+    i = (sh + 7) >> 3;
+    while(i--)
+    {
+        const u16 ns = *bandSprites++;
+        const u16 np = *bandPixels++;
+        u16 ov = 0;
+
+        if (ns > maxLineSprite) ov = ns - maxLineSprite;
+        // convert pixels overflow to number of sprite (32 pixels wide sprites)
+        if (np > maxLinePixel)
+        {
+            const u16 pov = ((np - maxLinePixel) + 31) >> 5;
+            if (pov > ov) ov = pov;
+        }
+
+        if (ov)
+        {
+            overflowBand++;
+            if (ov > overflow) overflow = ov;
+        }
+    }
+
+    mux->overflowSprites = overflow;
+    mux->overflowScanlines = overflowBand * 8;
+
+    const u16 numGroup = mux->numGroup;
+
+    // no overflow (or nothing we can rotate) --> keep default order (preserve depth order)
+    if ((overflow == 0) || (numGroup == 0))
+    {
+        mux->offset = 0;
+
+        END_PROFIL(PROFIL_MULTIPLEX)
+        return;
+    }
+
+    // rotate by overflow amount so dropped sprites are displayed next frame
+    u16 offset = (mux->offset + overflow) % numGroup;
+    mux->offset = offset;
+
+    // rebuild links from list head (first SAT entry): priority sprites first then rotated sprites list
+    VDPSprite* last = vdpSpriteCache;
+
+    last = linkMultiplexGroups(last, mux->prioGroups, mux->numPrioGroup);
+    last = linkMultiplexGroups(last, &mux->groups[offset], numGroup - offset);
+    last = linkMultiplexGroups(last, mux->groups, offset);
+    // mark as end
+    last->link = 0;
+
+    END_PROFIL(PROFIL_MULTIPLEX)
 }
 
 static Sprite* sortSprite(Sprite* sprite)
@@ -2180,6 +2952,98 @@ static Sprite* sortSprite(Sprite* sprite)
     return prev;
 }
 
+static void sortSprites()
+{
+    START_PROFIL
+
+    Sprite* heads[SORT_BUCKET_NUM];
+    Sprite** tails[SORT_BUCKET_NUM];
+    Sprite* s;
+    u16 shift;
+
+    needSort = FALSE;
+
+    u16 diff = 0;
+    // empty list is considered sorted
+    bool sorted = TRUE;
+
+    s = firstSprite;
+    if (s)
+    {
+        // find which depth bits are changing and if list is already sorted
+        // (depth is converted to unsigned key by inverting sign bit)
+        const u16 firstKey = s->depth ^ 0x8000;
+        s16 prevDepth = s->depth;
+
+        s = s->next;
+        while(s)
+        {
+            const s16 depth = s->depth;
+
+            if (depth < prevDepth) sorted = FALSE;
+            diff |= (depth ^ 0x8000) ^ firstKey;
+            prevDepth = depth;
+            s = s->next;
+        }
+    }
+
+    if (sorted)
+    {
+        END_PROFIL(PROFIL_SORT)
+        return;
+    }
+
+    // LSD radix sort on 4 bits digit, stable so sprites with same depth keep their relative order.
+    // Digits which don't change over all sprites are skipped (Y sorted depth usually needs only 2 passes)
+    for(shift = 0; shift < 16; shift += 4)
+    {
+        u16 i;
+
+        // no change in this digit
+        if (((diff >> shift) & (SORT_BUCKET_NUM - 1)) == 0) continue;
+
+        for(i = 0; i < SORT_BUCKET_NUM; i++) tails[i] = &heads[i];
+
+        // dispatch in buckets
+        s = firstSprite;
+        while(s)
+        {
+            Sprite* next = s->next;
+            const u16 b = ((u16) (s->depth ^ 0x8000) >> shift) & (SORT_BUCKET_NUM - 1);
+
+            *tails[b] = s;
+            tails[b] = &s->next;
+            s = next;
+        }
+
+        // concatenate buckets
+        Sprite** tail = &firstSprite;
+        for(i = 0; i < SORT_BUCKET_NUM; i++)
+        {
+            // not empty ?
+            if (tails[i] != &heads[i])
+            {
+                *tail = heads[i];
+                tail = tails[i];
+            }
+        }
+        *tail = NULL;
+    }
+
+    // rebuild backward links
+    Sprite* prev = NULL;
+    s = firstSprite;
+    while(s)
+    {
+        s->prev = prev;
+        prev = s;
+        s = s->next;
+    }
+    lastSprite = prev;
+
+    END_PROFIL(PROFIL_SORT)
+}
+
 static void moveAfter(Sprite* pos, Sprite* sprite)
 {
     Sprite* prev = sprite->prev;
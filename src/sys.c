@@ -23,6 +23,7 @@
 #include "sprite_eng.h"
 #include "sprite_eng_legacy.h"
 #include "task.h"
+#include "profiler.h"
 
 #include "tools.h"
 #include "kdebug.h"
@@ -64,6 +65,7 @@ extern bool VDP_doVBlankScrollProcess(void);
 
 // we don't want to share that method
 extern void MEM_init();
+extern bool DMA_isFrameArenaCarried();
 
 // main function
 extern int main(bool hardReset);
@@ -623,6 +625,7 @@ static NO_INLINE void internal_reset()
     MEM_init();
     // need to be reseted before first DMA_init()
     dmaQueues = NULL;
+    dmaQueuePrios = NULL;
     dmaDataBuffer = NULL;
     DMA_init();
     DMA_setMaxTransferSizeToDefault();
@@ -632,6 +635,9 @@ static NO_INLINE void internal_reset()
     JOY_init();
     // reseting z80 also reset the ym2612
     Z80_init();
+#if (ENABLE_PROFILER != 0)
+    PROF_init();
+#endif
 
     // enable interrupts
     SYS_setInterruptMaskLevel(3);
@@ -678,7 +684,9 @@ NO_INLINE bool SYS_doVBlankProcessEx(VBlankProcessTime processTime)
 
         // delay enabled ? --> wait a bit to improve PCM playback (test on SOR2)
         if (Z80_getForceDelayDMA()) waitSubTick(10);
+        PROF_BEGIN(PROF_ZONE_DMA);
         DMA_flushQueue();
+        PROF_END(PROF_ZONE_DMA);
 
         // can disable bus protection
         Z80_disableBusProtection();
@@ -731,6 +739,13 @@ NO_INLINE bool SYS_doVBlankProcessEx(VBlankProcessTime processTime)
     // store back
     VBlankProcess = vbp;
 
+    // frame done (DMA queue flushed) --> release frame arena allocations (only when no delayed transfer still uses it)
+    if (!DMA_isFrameArenaCarried()) MEM_resetFrame();
+#if (ENABLE_PROFILER != 0)
+    // profiling frame aggregation
+    PROF_frame();
+#endif
+
     // user VBlank callback
     (*vblankCB)();
 
@@ -993,8 +993,18 @@ Map *allocateMap(const MapDefinition *mapDef)
     // use direct reference
     else blocksSize = 0;
 
+    // streamed blocks indexes
+    if (compression & MAP_STREAMING)
+    {
+        // chunk size (even size so each slot is word aligned)
+        u16 slotSize = (mapDef->w << ((compression >> 12) & 7)) * ((mapDef->numBlock > 256)?2:1);
+        slotSize = (slotSize + 1) & 0xFFFE;
+
+        // stream structure + cache slots + row offsets
+        blockIndexesSize = sizeof(MapStream) + (slotSize * MAP_STREAMING_SLOT) + (mapDef->h * 2);
+    }
     // blocks indexes data compression
-    if (((compression >> 8) & 0xF) != COMPRESSION_NONE)
+    else if (((compression >> 8) & 0xF) != COMPRESSION_NONE)
     {
         blockIndexesSize = mapDef->w * mapDef->hp;
         if (mapDef->numBlock > 256) blockIndexesSize *= 2;
@@ -1015,6 +1025,16 @@ Map *allocateMap(const MapDefinition *mapDef)
         result->blocks = (void*) (adr + baseSize + metaTilesSize);
         // allocate blockIndexes buffer
         result->blockIndexes = (void*) (adr + baseSize + metaTilesSize + blocksSize);
+
+        // streamed map ? --> stream structure first then cache slots and row offsets
+        if (compression & MAP_STREAMING)
+        {
+            result->stream = (MapStream*) result->blockIndexes;
+            result->stream->data = (void*) (adr + baseSize + metaTilesSize + blocksSize + sizeof(MapStream));
+            result->blockIndexes = result->stream->data;
+            result->blockRowOffsets = (u16*) (adr + baseSize + metaTilesSize + blocksSize + blockIndexesSize - (mapDef->h * 2));
+        }
+        else result->stream = NULL;
     }
 
     return result;
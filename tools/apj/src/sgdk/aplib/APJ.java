@@ -12,7 +12,8 @@ import java.util.Collections;
  */
 public class APJ
 {
-    static class Match
+    // inner class as cost depends on current encoder state (last offset)
+    class Match
     {
         final private byte[] data;
         private int index;
@@ -190,21 +191,27 @@ public class APJ
     }
 
     // stats
-    static long statMiss;
-    static long statLiteral;
-    static long statShortZero;
-    static long statRLE1;
-    static long statRLEShort;
-    static long statRLELong;
-    static long statTinyMatch;
-    static long statShortMatch;
-    static long statLongMatch;
-    static long statRepeatMatch;
-
-    static boolean wasMatch;
-    static int lastOffset;
-
-    private static Match findBestMatch(ByteMatchList[] byteMatches, byte[] data, int ind)
+    long statMiss;
+    long statLiteral;
+    long statShortZero;
+    long statRLE1;
+    long statRLEShort;
+    long statRLELong;
+    long statTinyMatch;
+    long statShortMatch;
+    long statLongMatch;
+    long statRepeatMatch;
+
+    // encoder state (per pack call so packing can be done concurrently)
+    boolean wasMatch;
+    int lastOffset;
+
+    private APJ()
+    {
+        super();
+    }
+
+    private Match findBestMatch(ByteMatchList[] byteMatches, byte[] data, int ind)
     {
         // nothing we can do
         if (ind < 1)
@@ -293,7 +300,7 @@ public class APJ
         return best;
     }
 
-    private static Match getMatch(byte[] data, int from, int ind)
+    private Match getMatch(byte[] data, int from, int ind)
     {
         int refOffset;
         int curOffset;
@@ -427,7 +434,7 @@ public class APJ
             stream.writeBit((value >> i) & 1);
     }
 
-    private static void writeLiteral(BitWriter stream, int data)
+    private void writeLiteral(BitWriter stream, int data)
     {
         stream.writeBit(0);
         stream.writeUByte(data);
@@ -435,7 +442,7 @@ public class APJ
         statLiteral++;
     }
 
-    private static void writeTinyBlock(BitWriter stream, int offset)
+    private void writeTinyBlock(BitWriter stream, int offset)
     {
         // should not be the case
         if ((offset < 0) || (offset > 15))
@@ -460,7 +467,7 @@ public class APJ
             statRLE1++;
     }
 
-    private static void writeShortBlock(BitWriter stream, int offset, int length)
+    private void writeShortBlock(BitWriter stream, int offset, int length)
     {
         // should not be the case
         if ((offset < 1) || (offset > 127))
@@ -490,7 +497,7 @@ public class APJ
             statRLEShort++;
     }
 
-    private static void writeBlock(BitWriter stream, int offset, int length)
+    private void writeBlock(BitWriter stream, int offset, int length)
     {
         // block signature
         stream.writeBit(1);
@@ -550,6 +557,11 @@ public class APJ
      *         Cannot be packed using previous data block (try to pack without previous data block)
      */
     public static byte[] pack(byte[] data, boolean ultra, boolean silent) throws IOException, IllegalArgumentException
+    {
+        return new APJ().doPack(data, ultra, silent);
+    }
+
+    private byte[] doPack(byte[] data, boolean ultra, boolean silent) throws IOException, IllegalArgumentException
     {
         // data length
         final int len = data.length;
@@ -758,6 +770,8 @@ public class APJ
         final BitReader source = new BitReader(data);
         final DynamicByteArray result = new DynamicByteArray();
         int offset, len;
+        int lastOffset;
+        boolean wasMatch;
         boolean done;
 
         lastOffset = 0;
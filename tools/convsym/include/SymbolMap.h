@@ -0,0 +1,149 @@
+/* ------------------------------------------------------------ *
+ * ConvSym utility version 2.13									*
+ * Symbol map ("map" output format) consumer API				*
+ * ------------------------------------------------------------	*
+ *
+ * Plain C header (also usable from C++) to query symbol map files
+ * without any parsing: map the file in memory, validate it with
+ * SymbolMap_init() and use the lookup functions directly on the
+ * mapped data. See docs/MAP_Format.txt for the file layout.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define SYMBOLMAP_MAGIC			"SMAP"
+#define SYMBOLMAP_VERSION		1
+#define SYMBOLMAP_HEADER_SIZE	32
+#define SYMBOLMAP_ENTRY_SIZE	8
+#define SYMBOLMAP_EMPTY_SLOT	0xFFFFFFFFu
+
+typedef struct {
+	const uint8_t * data;
+	uint32_t count;				/* number of symbols */
+	const uint8_t * symbols;	/* symbol entries, sorted by address */
+	uint32_t hashMask;			/* hash table size - 1 */
+	const uint8_t * hash;		/* name hash table (symbol indexes) */
+	const char * strings;		/* string pool */
+	uint32_t stringsSize;
+} SymbolMap;
+
+static inline uint32_t SymbolMap_readLong(const uint8_t * p) {
+	return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/* FNV-1a, used for the name hash table */
+static inline uint32_t SymbolMap_hash(const char * name) {
+	uint32_t h = 2166136261u;
+	while (*name) {
+		h ^= (uint8_t)*name++;
+		h *= 16777619u;
+	}
+	return h;
+}
+
+/**
+ * Validates symbol map data and initializes the map descriptor
+ * Every name offset and hash table entry is checked once here (O(n)), so lookups
+ * stay in bounds even on corrupted or untrusted data.
+ * Returns 0 on success, -1 if data isn't a valid symbol map
+ */
+static inline int SymbolMap_init(SymbolMap * map, const void * data, size_t size) {
+	const uint8_t * p = (const uint8_t *)data;
+	if (size < SYMBOLMAP_HEADER_SIZE || memcmp(p, SYMBOLMAP_MAGIC, 4) != 0 || SymbolMap_readLong(p + 4) != SYMBOLMAP_VERSION) {
+		return -1;
+	}
+
+	const uint32_t count = SymbolMap_readLong(p + 8);
+	const uint32_t symbolsOffset = SymbolMap_readLong(p + 12);
+	const uint32_t hashSize = SymbolMap_readLong(p + 16);
+	const uint32_t hashOffset = SymbolMap_readLong(p + 20);
+	const uint32_t stringsOffset = SymbolMap_readLong(p + 24);
+	const uint32_t stringsSize = SymbolMap_readLong(p + 28);
+
+	/* hash table size must be a power of 2 with free slots */
+	if (hashSize == 0 || (hashSize & (hashSize - 1)) != 0 || hashSize <= count ||
+		(uint64_t)symbolsOffset + (uint64_t)count * SYMBOLMAP_ENTRY_SIZE > size ||
+		(uint64_t)hashOffset + (uint64_t)hashSize * 4 > size ||
+		(uint64_t)stringsOffset + stringsSize > size || stringsSize == 0 || p[stringsOffset + stringsSize - 1] != 0) {
+		return -1;
+	}
+
+	/* name offsets must point inside the string pool (pool ends with a null terminator) */
+	for (uint32_t i = 0; i < count; i++) {
+		if (SymbolMap_readLong(p + symbolsOffset + i * SYMBOLMAP_ENTRY_SIZE + 4) >= stringsSize) {
+			return -1;
+		}
+	}
+
+	/* hash slots must be empty or hold a valid symbol index, at least one empty slot ends the probing */
+	uint32_t emptySlots = 0;
+	for (uint32_t i = 0; i < hashSize; i++) {
+		const uint32_t index = SymbolMap_readLong(p + hashOffset + i * 4);
+		if (index == SYMBOLMAP_EMPTY_SLOT) {
+			emptySlots++;
+		}
+		else if (index >= count) {
+			return -1;
+		}
+	}
+	if (emptySlots == 0) {
+		return -1;
+	}
+
+	map->data = p;
+	map->count = count;
+	map->symbols = p + symbolsOffset;
+	map->hashMask = hashSize - 1;
+	map->hash = p + hashOffset;
+	map->strings = (const char *)(p + stringsOffset);
+	map->stringsSize = stringsSize;
+	return 0;
+}
+
+static inline uint32_t SymbolMap_getAddress(const SymbolMap * map, uint32_t index) {
+	return SymbolMap_readLong(map->symbols + index * SYMBOLMAP_ENTRY_SIZE);
+}
+
+static inline const char * SymbolMap_getName(const SymbolMap * map, uint32_t index) {
+	return map->strings + SymbolMap_readLong(map->symbols + index * SYMBOLMAP_ENTRY_SIZE + 4);
+}
+
+/**
+ * Returns index of the symbol covering the address (last symbol with address <= given address),
+ * or -1 if address is below the first symbol. O(log n)
+ */
+static inline int32_t SymbolMap_findByAddress(const SymbolMap * map, uint32_t address) {
+	uint32_t low = 0, high = map->count;
+	while (low < high) {
+		const uint32_t mid = low + ((high - low) >> 1);
+		if (SymbolMap_getAddress(map, mid) <= address) {
+			low = mid + 1;
+		}
+		else {
+			high = mid;
+		}
+	}
+	return (int32_t)low - 1;
+}
+
+/**
+ * Returns index of the symbol with the given name (lowest address one if name is duplicated),
+ * or -1 if not found. O(1)
+ */
+static inline int32_t SymbolMap_findByName(const SymbolMap * map, const char * name) {
+	uint32_t slot = SymbolMap_hash(name) & map->hashMask;
+	for (;;) {
+		const uint32_t index = SymbolMap_readLong(map->hash + slot * 4);
+		if (index == SYMBOLMAP_EMPTY_SLOT) {
+			return -1;
+		}
+		if (strcmp(SymbolMap_getName(map, index), name) == 0) {
+			return (int32_t)index;
+		}
+		slot = (slot + 1) & map->hashMask;
+	}
+}
@@ -1,6 +1,6 @@
 
 /* ------------------------------------------------------------ *
- * ConvSym utility version 2.12									*
+ * ConvSym utility version 2.13									*
  * Main definitions file										*
  * (c) 2017-2018, 2020-2024, Vladikcomper						*
  * ------------------------------------------------------------	*/
@@ -31,7 +31,7 @@ int main (int argc, const char ** argv) {
 	/* Provide help if no sufficient arguments were passed */
 	if (argc<2) {
 		printf(
-			"ConvSym utility version 2.12.1\n"
+			"ConvSym utility version 2.13\n"
 			"(c) 2016-2024, vladikcomper\n"
 			"\n"
 			"Command line arguments:\n"
@@ -51,7 +51,7 @@ int main (int argc, const char ** argv) {
 			"\n"
 			"  -out [format]\n"
 			"  -output [format]\n"
-			"    Selects output file format. Supported formats: asm, deb1, deb2, log\n"
+			"    Selects output file format. Supported formats: asm, deb1, deb2, log, map\n"
 			"    Default: deb2\n"
 			"\n"
 			"  -inopt [options]\n"
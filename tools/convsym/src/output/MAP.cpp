@@ -0,0 +1,111 @@
+/* ------------------------------------------------------------ *
+ * ConvSym utility version 2.13									*
+ * Output wrapper for indexed binary symbol map					*
+ * ------------------------------------------------------------	*/
+
+#include <map>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <IO.hpp>
+#include <SymbolMap.h>
+
+#include "OutputWrapper.hpp"
+
+
+struct Output__Map : public OutputWrapper {
+
+	Output__Map() {};
+	~Output__Map() {};
+
+	/**
+	 * Main function that generates the output
+	 */
+	void parse(
+		std::multimap<uint32_t, std::string>& SymbolList,
+		const char * fileName,
+		uint32_t appendOffset = 0,
+		uint32_t pointerOffset = 0,
+		const char * opts = "",
+		bool alignOnAppend = true
+	) {
+		if (appendOffset || pointerOffset || !alignOnAppend) {
+			IO::Log(IO::warning, "Append options aren't supported by the \"map\" output parser.");
+		}
+		if (*opts) {
+			IO::Log(IO::warning, "Output options aren't supported by the \"map\" output parser.");
+		}
+
+		const uint32_t count = SymbolList.size();
+
+		// Hash table size: power of 2 with load factor <= 50%
+		uint32_t hashSize = 16;
+		while (hashSize < count * 2) {
+			hashSize <<= 1;
+		}
+
+		const uint32_t symbolsOffset = SYMBOLMAP_HEADER_SIZE;
+		const uint32_t hashOffset = symbolsOffset + count * SYMBOLMAP_ENTRY_SIZE;
+		const uint32_t stringsOffset = hashOffset + hashSize * 4;
+
+		std::vector<uint8_t> symbols;
+		std::vector<uint32_t> hash(hashSize, SYMBOLMAP_EMPTY_SLOT);
+		std::string strings;
+		symbols.reserve(count * SYMBOLMAP_ENTRY_SIZE);
+
+		// Symbols are already sorted by offset in the multimap, equal offsets keep their insertion order
+		uint32_t index = 0;
+		for (auto & symbol : SymbolList) {
+			putLong(symbols, symbol.first);
+			putLong(symbols, strings.size());
+			strings.append(symbol.second);
+			strings.push_back('\0');
+
+			// The first (lowest offset) symbol wins for duplicated names
+			uint32_t slot = SymbolMap_hash(symbol.second.c_str()) & (hashSize - 1);
+			while (hash[slot] != SYMBOLMAP_EMPTY_SLOT) {
+				slot = (slot + 1) & (hashSize - 1);
+			}
+			hash[slot] = index++;
+		}
+
+		std::vector<uint8_t> header;
+		header.insert(header.end(), SYMBOLMAP_MAGIC, SYMBOLMAP_MAGIC + 4);
+		putLong(header, SYMBOLMAP_VERSION);
+		putLong(header, count);
+		putLong(header, symbolsOffset);
+		putLong(header, hashSize);
+		putLong(header, hashOffset);
+		putLong(header, stringsOffset);
+		putLong(header, strings.size());
+
+		std::vector<uint8_t> hashData;
+		hashData.reserve(hashSize * 4);
+		for (auto & entry : hash) {
+			putLong(hashData, entry);
+		}
+
+		IO::FileOutput output = IO::FileOutput(fileName);
+		if (!output.good()) {
+			IO::Log(IO::fatal, "Couldn't open file \"%s\"", fileName);
+			throw "IO error";
+		}
+
+		output.writeData(header.data(), header.size());
+		output.writeData(symbols.data(), symbols.size());
+		output.writeData(hashData.data(), hashData.size());
+		output.writeData(strings.data(), strings.size());
+
+		IO::Log(IO::debug, "Symbol map: %d symbols, hash table size: %d, string pool size: %d", count, hashSize, (int)strings.size());
+	}
+
+private:
+	// All fields are little-endian, so the file can be mapped directly by host tools
+	static void putLong(std::vector<uint8_t>& buffer, uint32_t value) {
+		buffer.push_back(value);
+		buffer.push_back(value >> 8);
+		buffer.push_back(value >> 16);
+		buffer.push_back(value >> 24);
+	}
+};
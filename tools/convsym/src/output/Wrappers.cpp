@@ -1,6 +1,6 @@
 
 /* ------------------------------------------------------------ *
- * ConvSym utility version 2.12									*
+ * ConvSym utility version 2.13									*
  * Output formats base controller								*
  * ------------------------------------------------------------	*/
 
@@ -20,6 +20,7 @@
 #include "DEB2.cpp"
 #include "Log.cpp"
 #include "ASM.cpp"
+#include "MAP.cpp"
 
 
 /* Input wrappers map */
@@ -29,7 +30,8 @@ std::unique_ptr<OutputWrapper> getOutputWrapper( const std::string& name ) {
 		{ "deb1",	[]() { return std::unique_ptr<OutputWrapper>(new Output__Deb1());	} },
 		{ "deb2",	[]() { return std::unique_ptr<OutputWrapper>(new Output__Deb2());	} },
 		{ "log",	[]() { return std::unique_ptr<OutputWrapper>(new Output__Log());	} },
-		{ "asm",	[]() { return std::unique_ptr<OutputWrapper>(new Output__Asm());	} }
+		{ "asm",	[]() { return std::unique_ptr<OutputWrapper>(new Output__Asm());	} },
+		{ "map",	[]() { return std::unique_ptr<OutputWrapper>(new Output__Map());	} }
 	};
 
 	auto entry = wrapperTable.find(name);
@@ -0,0 +1,76 @@
+#!/bin/sh
+# Compare LZ4W packer output and packing time against a reference build.
+#
+# usage: compare.sh [-t <threads>] <new_classpath> <reference_jar> <file>...
+#
+#   -t threads      number of match search thread for the new packer (--threads option, default = number of CPU)
+#   new_classpath   classpath of the packer to test (build/classes/java/main or a jar)
+#   reference_jar   reference packer jar (ex: lz4w.jar built from previous revision or bin/lz4w.jar)
+#   file            files to pack (ex: ROM images, tileset or map binary data)
+#
+# Each file is packed by both packers (which both verify their own output by unpacking it).
+# Packed data can differ when the match finders select another match of same cost so the packed size
+# difference is reported. Exit code is 1 if any packer fails.
+
+NEW_OPTS=
+if [ "$1" = "-t" ]; then
+    NEW_OPTS="--threads $2"
+    shift 2
+fi
+
+if [ $# -lt 3 ]; then
+    echo "usage: $0 [-t <threads>] <new_classpath> <reference_jar> <file>..."
+    exit 2
+fi
+
+NEW_CP=$1
+REF_JAR=$2
+shift 2
+
+TMP=${TMPDIR:-/tmp}/lz4w_compare.$$
+mkdir -p "$TMP" || exit 2
+trap 'rm -rf "$TMP"' EXIT
+
+now_ms() {
+    echo $(( $(date +%s%N) / 1000000 ))
+}
+
+status=0
+total_ref=0
+total_new=0
+total_ref_size=0
+total_new_size=0
+
+printf "%-40s %10s %10s %10s %10s %10s  %s\n" "file" "size" "ref packed" "new packed" "ref (ms)" "new (ms)" "result"
+
+for f in "$@"; do
+    name=$(basename "$f")
+
+    t0=$(now_ms)
+    java -jar "$REF_JAR" p "$f" "$TMP/ref.bin" silent > /dev/null || { echo "$f: reference packer failed"; status=1; continue; }
+    t1=$(now_ms)
+    java -cp "$NEW_CP" sgdk.lz4w.Launcher $NEW_OPTS p "$f" "$TMP/new.bin" silent > /dev/null || { echo "$f: new packer failed"; status=1; continue; }
+    t2=$(now_ms)
+
+    ref_time=$((t1 - t0))
+    new_time=$((t2 - t1))
+    total_ref=$((total_ref + ref_time))
+    total_new=$((total_new + new_time))
+
+    ref_size=$(wc -c < "$TMP/ref.bin")
+    new_size=$(wc -c < "$TMP/new.bin")
+    total_ref_size=$((total_ref_size + ref_size))
+    total_new_size=$((total_new_size + new_size))
+
+    if cmp -s "$TMP/ref.bin" "$TMP/new.bin"; then
+        result="identical"
+    else
+        result=$(printf "%+d byte(s)" $((new_size - ref_size)))
+    fi
+
+    printf "%-40s %10d %10d %10d %10d %10d  %s\n" "$name" $(wc -c < "$f") $ref_size $new_size $ref_time $new_time "$result"
+done
+
+printf "%-40s %10s %10d %10d %10d %10d  %s\n" "total" "" $total_ref_size $total_new_size $total_ref $total_new "$(printf "%+d byte(s)" $((total_new_size - total_ref_size)))"
+
+exit $status
@@ -3,6 +3,13 @@ package sgdk.lz4w;
 import java.io.ByteArrayOutputStream;
 import java.io.IOException;
 import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.List;
+import java.util.concurrent.ExecutionException;
+import java.util.concurrent.ExecutorService;
+import java.util.concurrent.Executors;
+import java.util.concurrent.Future;
+import java.util.concurrent.atomic.AtomicInteger;
 
 public class LZ4W
 {
@@ -29,14 +36,20 @@ public class LZ4W
     final static int MATCH_OFFSET_MAX = 0x0FF + MATCH_MIN_OFFSET;
     final static int MATCH_LONG_OFFSET_MAX = 0x3FFF + MATCH_LONG_MIN_OFFSET;
 
-    // stats
-    static int[] statLiteralSize;
-    static int[] statMatchSize;
-    static int statNumSeg;
-    static long statMiss;
-    static long statLiteralLen;
-    static long statMatchLen;
-    static long statLongMatch;
+    // minimum input size (in word) to use parallel match search
+    final static int PARALLEL_MIN_SIZE = 0x4000;
+    // number of position searched per parallel work unit
+    final static int PARALLEL_BLOCK_SIZE = 0x400;
+
+    // number of bits of word pair hash (match chains)
+    final static int CHAIN_HASH_BITS = 16;
+    // maximum number of chain entries visited to find a match (bound search time, larger doesn't improve ratio on usual data)
+    final static int CHAIN_MAX_DEPTH = 256;
+
+    // number of thread used for match search
+    static volatile int numThread = Runtime.getRuntime().availableProcessors();
+    // match search thread pool, shared by all pack(..) calls so concurrent calls (rescomp) don't multiply threads
+    static ExecutorService threadPool = null;
 
     /**
      * Pack data using the LZ4W algorithm.
@@ -54,14 +67,8 @@ public class LZ4W
     {
         final DynamicByteArray result = new DynamicByteArray(data.length);
         final DynamicByteArray literal = new DynamicByteArray(1024);
-
-        statLiteralSize = new int[LITERAL_MAX_SIZE + 1];
-        statMatchSize = new int[MATCH_LONG_MAX_SIZE + 1];
-        statNumSeg = 0;
-        statMiss = 0;
-        statLiteralLen = 0;
-        statMatchLen = 0;
-        statLongMatch = 0;
+        // stats are local to the call as pack(..) can be called concurrently (rescomp)
+        final Stats stats = new Stats();
 
         // data length (in byte)
         final int len = data.length - start;
@@ -74,34 +81,13 @@ public class LZ4W
             // adjust offset to word data
             final int offset = start / 2;
 
-            // PASS 1: build the word matches table
-            final WordMatchList[] wordMatches = new WordMatchList[0x10000];
-            for (int i = 0; i < wordMatches.length; i++)
-                wordMatches[i] = new WordMatchList();
+            // PASS 1: build the word pair match chains
+            final MatchChain chain = new MatchChain(wdata, Math.max(offset - MATCH_LONG_OFFSET_MAX, 0));
 
-            // current offset to start counting word matches
-            int wmOffset = Math.max(offset - MATCH_LONG_OFFSET_MAX, 0);
-            while (wmOffset < wdata.length)
-            {
-                final int off = wmOffset;
-                final short val = wdata[wmOffset++];
-
-                int repeat = 0;
-                while ((wmOffset < wdata.length) && (wdata[wmOffset] == val))
-                {
-                    repeat++;
-                    wmOffset++;
-                }
-
-                // need to unsign val / add new word match
-                wordMatches[val & 0xFFFF].add(new WordMatch(off, repeat));
-            }
-
-            // PASS 2: get best match for each source position using the word matches table
+            // PASS 2: get best match for each source position using the match chains
             final Match[] matches = new Match[wdata.length - offset];
 
-            for (int i = 0; i < matches.length; i++)
-                matches[i] = findBestMatch(wordMatches, wdata, offset + i, start / 2);
+            findBestMatches(chain, wdata, offset, matches);
 
             // PASS 3: walk backward in matches and find optimal match length
             final int costs[] = new int[matches.length + 1];
@@ -145,7 +131,7 @@ public class LZ4W
                 if (match != null)
                 {
                     // add segment
-                    offAdj += addSegment(result, literal, match, offAdj);
+                    offAdj += addSegment(result, literal, match, offAdj, stats);
                     // adjust index
                     ind += match.length;
                     // and clear literal data
@@ -161,13 +147,13 @@ public class LZ4W
         if (literal.size() > 0)
         {
             // last segment
-            addSegment(result, literal, new Match(), 0);
+            addSegment(result, literal, new Match(), 0, stats);
             // and clear literal data
             literal.reset();
         }
 
         // mark end with empty literal and empty match
-        addSegment(result, literal, new Match(), 0);
+        addSegment(result, literal, new Match(), 0, stats);
 
         // don't forget the last byte...
         if ((len & 1) != 0)
@@ -184,22 +170,22 @@ public class LZ4W
         if (!silent)
         {
             System.out.println("Stats:");
-            System.out.println("  Num segment = " + statNumSeg + " - " + statLongMatch + " long match(es) - " + statMiss
+            System.out.println("  Num segment = " + stats.numSeg + " - " + stats.longMatch + " long match(es) - " + stats.miss
                     + " miss(es)");
             System.out.println("  Mean literal size = "
-                    + String.format("%.2g", Double.valueOf((double) statLiteralLen / (double) statNumSeg)));
+                    + String.format("%.2g", Double.valueOf((double) stats.literalLen / (double) stats.numSeg)));
             System.out.println("  Mean match size = "
-                    + String.format("%.2g", Double.valueOf((double) statMatchLen / (double) statNumSeg)));
+                    + String.format("%.2g", Double.valueOf((double) stats.matchLen / (double) stats.numSeg)));
 
             if (ENABLE_STATS_EXT)
             {
                 System.out.print("  Literal size stat = [");
-                for (int i = 0; i < statLiteralSize.length; i++)
-                    System.out.print(statLiteralSize[i] + ",");
+                for (int i = 0; i < stats.literalSize.length; i++)
+                    System.out.print(stats.literalSize[i] + ",");
                 System.out.println("]");
                 System.out.print("  Match size stat = [");
-                for (int i = 0; i < statMatchSize.length; i++)
-                    System.out.print(statMatchSize[i] + ",");
+                for (int i = 0; i < stats.matchSize.length; i++)
+                    System.out.print(stats.matchSize[i] + ",");
                 System.out.println("]");
             }
         }
@@ -307,150 +293,169 @@ public class LZ4W
         return resultWanted;
     }
 
-    private static Match findBestMatch(WordMatchList[] wordMatches, short[] wdata, int ind, int originStartOffset)
+    /**
+     * Set the number of thread used to search matches (PASS 2) on large input (0 = number of available processors)
+     */
+    public static synchronized void setNumThread(int value)
     {
-        // nothing we can do
-        if (ind < 1)
-            return null;
+        final int nt = (value <= 0) ? Runtime.getRuntime().availableProcessors() : value;
 
-        // get word matches for current word
-        final WordMatchList wml = wordMatches[wdata[ind] & 0xFFFF];
-        final int offMin = Math.max(0, ind - MATCH_LONG_OFFSET_MAX);
+        // release current thread pool (running searches can complete, new one will be created on next use)
+        if ((nt != numThread) && (threadPool != null))
+        {
+            threadPool.shutdown();
+            threadPool = null;
+        }
 
-        // not really useful (only for > 64KB file which rarely happen on Megadrive)
-        // int wmlInd = Collections.binarySearch(wml, new WordMatch(offMin, 0));
-        // if (wmlInd < 0)
-        // wmlInd = (-wmlInd) - 1;
+        numThread = nt;
+    }
 
-        // find starting index in word match list
-        int wmlInd = 0;
-        while (wmlInd < wml.size())
+    private static synchronized ExecutorService getThreadPool()
+    {
+        if (threadPool == null)
         {
-            final WordMatch wm = wml.get(wmlInd);
+            final AtomicInteger threadNum = new AtomicInteger();
+
+            threadPool = Executors.newFixedThreadPool(numThread, r -> {
+                final Thread result = new Thread(r, "LZ4W match finder #" + threadNum.getAndIncrement());
+                // don't prevent application exit
+                result.setDaemon(true);
+                return result;
+            });
+        }
 
-            // accepted offset ? --> start here
-            if ((wm.offset + wm.repeat) >= offMin)
-                break;
+        return threadPool;
+    }
+
+    public static int getNumThread()
+    {
+        return numThread;
+    }
 
-            wmlInd++;
+    private static void findBestMatches(MatchChain chain, short[] wdata, int offset, Match[] matches)
+    {
+        // small input (or single thread) ? --> direct search
+        if ((numThread <= 1) || (matches.length < PARALLEL_MIN_SIZE))
+        {
+            for (int i = 0; i < matches.length; i++)
+                matches[i] = findBestMatch(chain, wdata, offset + i, offset);
+            return;
         }
 
-        // get number of repeat for current byte
-        final int curRepeat = getRepeat(wdata, ind);
+        // each position is searched independently so we can dispatch blocks of positions to several threads (result is identical)
+        final ExecutorService pool = getThreadPool();
+        final List<Future<?>> blocks = new ArrayList<>();
+
+        for (int block = 0; block < matches.length; block += PARALLEL_BLOCK_SIZE)
+        {
+            final int start = block;
+            final int end = Math.min(matches.length, block + PARALLEL_BLOCK_SIZE);
+
+            blocks.add(pool.submit(() -> {
+                for (int i = start; i < end; i++)
+                    matches[i] = findBestMatch(chain, wdata, offset + i, offset);
+            }));
+        }
+
+        try
+        {
+            // wait for completion (also make matches[] written by other threads visible)
+            for (Future<?> f : blocks)
+                f.get();
+        }
+        catch (InterruptedException e)
+        {
+            for (Future<?> f : blocks)
+                f.cancel(true);
+
+            Thread.currentThread().interrupt();
+            throw new RuntimeException("LZ4W match search interrupted", e);
+        }
+        catch (ExecutionException e)
+        {
+            for (Future<?> f : blocks)
+                f.cancel(true);
+
+            // propagate search error
+            final Throwable cause = e.getCause();
+            if (cause instanceof RuntimeException)
+                throw (RuntimeException) cause;
+            if (cause instanceof Error)
+                throw (Error) cause;
+
+            throw new RuntimeException(cause);
+        }
+    }
+
+    private static Match findBestMatch(MatchChain chain, short[] wdata, int ind, int originStartOffset)
+    {
+        // nothing we can do (we need a word pair to save at least 1 word)
+        if ((ind < 1) || (ind >= (wdata.length - 1)))
+            return null;
+
+        final int offMin = Math.max(0, ind - MATCH_LONG_OFFSET_MAX);
+        final short value = wdata[ind];
+        final short next = wdata[ind + 1];
+        // get number of repeat for current word
+        final int curRepeat = chain.getRepeat(ind);
 
         Match best = null;
         // we want 1 saved word at least
-        int savedWord = 1;
+        int savedWord = 0;
 
-        // for all accepted word matches
-        while (wmlInd < wml.size())
+        // inside a run ? --> previous position gives the remaining run at the shortest offset
+        if ((curRepeat > 0) && ((ind - 1) >= offMin) && (wdata[ind - 1] == value))
         {
-            final WordMatch wm = wml.get(wmlInd);
+            final Match match = findBestMatchInternal(wdata, ind - 1, ind, originStartOffset);
+
+            if (match.savedWord > savedWord)
+            {
+                best = match;
+                savedWord = match.savedWord;
 
-            int off = wm.offset;
-            int repeat = wm.repeat;
+                // maximum saved ? --> don't continue
+                if (savedWord == Match.MAX_SAVED_WORD)
+                    return best;
+            }
+        }
 
-            // raised current offset ? --> stop now
-            if (off >= ind)
+        // then walk previous positions having the same word pair (nearest first)
+        int depth = CHAIN_MAX_DEPTH;
+        int off = chain.getPrevious(ind);
+        while ((off >= 0) && (depth > 0))
+        {
+            final int repeat = chain.getRepeat(off);
+
+            // out of offset range (even for end of run) ? --> stop
+            if ((off + repeat) < offMin)
                 break;
 
-            // need to adjust start ?
-            if (off < offMin)
-            {
-                repeat -= offMin - off;
-                off = offMin;
-            }
+            depth--;
 
-            // can optimize repeat ?
-            if ((off >= originStartOffset) || ((off + repeat) < originStartOffset))
+            // not an hash collision ?
+            if ((wdata[off] == value) && (wdata[off + 1] == next))
             {
-                // less repeat on match
-                if (repeat < curRepeat)
-                {
-                    final Match match = new Match(ind, off, Math.min(MATCH_LONG_MAX_SIZE, repeat + 1),
-                            off < originStartOffset);
-
-                    // we use >= as we always prefer shorter offset
-                    if (match.savedWord >= savedWord)
-                    {
-                        best = match;
-                        savedWord = match.savedWord;
-
-                        // maximum saved ? --> don't continue
-                        if (savedWord == Match.MAX_SAVED_WORD)
-                            return best;
-                    }
-                }
-                else
-                {
-                    // more repeat on match ?
-                    if (repeat > curRepeat)
-                    {
-                        // bypass extras repeats on match
-                        int delta = repeat - curRepeat;
-                        // fix maximum delta to not raise ind
-                        if ((off + delta) >= ind)
-                            delta = (ind - off) - 1;
-
-                        off += delta;
-                        repeat -= delta;
-                    }
-
-                    Match match;
-
-                    // still some repeat ?
-                    if (repeat > 0)
-                    {
-                        // we raised ind ? --> limit start offset to (ind - 1)
-                        if ((off + repeat) >= ind)
-                            repeat = (ind - off) - 1;
-
-                        // easy optimization (start comparing after repeat)
-                        match = findBestMatchInternal(wdata, off + repeat, ind + repeat, originStartOffset);
-                        // then fix the match
-                        match = new Match(match.curOffset - repeat, match.refOffset - repeat,
-                                Math.min(MATCH_LONG_MAX_SIZE, match.length + repeat),
-                                (match.refOffset - repeat) < originStartOffset);
-                    }
-                    else
-                        match = findBestMatchInternal(wdata, off, ind, originStartOffset);
-
-                    // we use >= as we always prefer short offset
-                    if (match.savedWord >= savedWord)
-                    {
-                        best = match;
-                        savedWord = match.savedWord;
-
-                        // maximum saved ? --> don't continue
-                        if (savedWord == Match.MAX_SAVED_WORD)
-                            return best;
-                    }
-                }
-            }
-            else
-            {
-                // for each repeated word
-                while ((repeat-- >= 0) && (off < ind))
-                {
-                    final Match match = findBestMatchInternal(wdata, off, ind, originStartOffset);
+                int from = off;
 
-                    // we use >= as we always prefer short offset
-                    if (match.savedWord >= savedWord)
-                    {
-                        best = match;
-                        savedWord = match.savedWord;
+                // start of a run --> align its end on end of current run (longest match in this run)
+                if (curRepeat > 0)
+                    from = Math.max(offMin, (off + repeat) - Math.min(curRepeat, repeat));
 
-                        // maximum saved ? --> don't continue
-                        if (savedWord == Match.MAX_SAVED_WORD)
-                            return best;
-                    }
+                final Match match = findBestMatchInternal(wdata, from, ind, originStartOffset);
 
-                    off++;
+                // we use > as we always prefer shorter offset (visited first)
+                if (match.savedWord > savedWord)
+                {
+                    best = match;
+                    savedWord = match.savedWord;
+
+                    // maximum saved ? --> don't continue
+                    if (savedWord == Match.MAX_SAVED_WORD)
+                        return best;
                 }
             }
 
-            // next word match
-            wmlInd++;
+            off = chain.getPrevious(off);
         }
 
         return best;
@@ -479,18 +484,7 @@ public class LZ4W
         return new Match(ind, from, len, from < originStart);
     }
 
-    private static int getRepeat(short[] wdata, int ind)
-    {
-        final short value = wdata[ind];
-
-        int off = ind + 1;
-        while ((off < wdata.length) && (wdata[off] == value))
-            off++;
-
-        return (off - ind) - 1;
-    }
-
-    private static int addSegment(DynamicByteArray result, DynamicByteArray literal, Match match, int offsetDiff)
+    private static int addSegment(DynamicByteArray result, DynamicByteArray literal, Match match, int offsetDiff, Stats stats)
             throws IllegalArgumentException
     {
         byte[] literalArray = literal.toByteArray();
@@ -501,11 +495,11 @@ public class LZ4W
         // literal size overflow
         while (literalLength > LITERAL_MAX_SIZE)
         {
-            statNumSeg++;
-            statMiss++;
-            statLiteralLen += LITERAL_MAX_SIZE;
-            statLiteralSize[LITERAL_MAX_SIZE]++;
-            statMatchSize[0]++;
+            stats.numSeg++;
+            stats.miss++;
+            stats.literalLen += LITERAL_MAX_SIZE;
+            stats.literalSize[LITERAL_MAX_SIZE]++;
+            stats.matchSize[0]++;
 
             // 1 word spent in encoding literal block
             offsetAdj++;
@@ -526,7 +520,7 @@ public class LZ4W
 
         if ((matchLength > 0) || (literalLength > 0))
         {
-            statNumSeg++;
+            stats.numSeg++;
 
             if (match.longMatch)
             {
@@ -541,9 +535,9 @@ public class LZ4W
                 result.write(matchLength - MATCH_LONG_MIN_SIZE);
                 // we write extended offset after literal data block
 
-                statMatchLen += matchLength;
-                statMatchSize[matchLength - MATCH_LONG_MIN_SIZE]++;
-                statLongMatch++;
+                stats.matchLen += matchLength;
+                stats.matchSize[matchLength - MATCH_LONG_MIN_SIZE]++;
+                stats.longMatch++;
             }
             else
             {
@@ -568,12 +562,12 @@ public class LZ4W
                     result.write(0);
                 }
 
-                statMatchLen += matchLength;
-                statMatchSize[matchLength]++;
+                stats.matchLen += matchLength;
+                stats.matchSize[matchLength]++;
             }
 
-            statLiteralLen += literalLength;
-            statLiteralSize[literalLength]++;
+            stats.literalLen += literalLength;
+            stats.literalSize[literalLength]++;
 
             // write literal data (as byte so need to multiply by 2)
             result.write(literalArray, literalOffset, literalLength * 2);
@@ -682,6 +676,17 @@ public class LZ4W
         dst.write(value >> 8);
     }
 
+    static class Stats
+    {
+        final int[] literalSize = new int[LITERAL_MAX_SIZE + 1];
+        final int[] matchSize = new int[MATCH_LONG_MAX_SIZE + 1];
+        int numSeg;
+        long miss;
+        long literalLen;
+        long matchLen;
+        long longMatch;
+    }
+
     static class Match
     {
         final static int MAX_SAVED_WORD = (MATCH_LONG_MAX_SIZE - 2);
@@ -753,38 +758,72 @@ public class LZ4W
         }
     }
 
-    @SuppressWarnings("serial")
-    static class WordMatchList extends ArrayList<WordMatch>
+    /**
+     * Word pair hash chains: each position is linked to the previous position starting with the same word pair (hash).<br>
+     * All positions inside a run of identical words are linked to the previous run start so a run is visited only once.
+     */
+    static class MatchChain
     {
-        WordMatchList()
+        // first chained position
+        final int from;
+        // previous position with same word pair hash (-1 = end of chain), indexed by (position - from)
+        final int[] previous;
+        // number of following identical words, indexed by (position - from)
+        final int[] repeat;
+
+        public MatchChain(short[] wdata, int from)
         {
             super();
-        }
-    }
 
-    static class WordMatch implements Comparable<WordMatch>
-    {
-        final int offset;
-        final int repeat;
+            final int len = wdata.length - from;
+            final int[] head = new int[1 << CHAIN_HASH_BITS];
 
-        public WordMatch(int offset, int repeat)
-        {
-            super();
+            this.from = from;
+            previous = new int[len];
+            repeat = new int[len];
+
+            // compute repeats backward
+            for (int i = len - 2; i >= 0; i--)
+                if (wdata[from + i] == wdata[from + i + 1])
+                    repeat[i] = repeat[i + 1] + 1;
+
+            Arrays.fill(head, -1);
+            // last position doesn't have word pair
+            if (len > 0)
+                previous[len - 1] = -1;
+
+            for (int i = 0; i < (len - 1); i++)
+            {
+                final int off = from + i;
 
-            this.offset = offset;
-            this.repeat = repeat;
+                // inside a run (not its start) ? --> same link than previous position
+                if ((i > 0) && (repeat[i] > 0) && (wdata[off - 1] == wdata[off]))
+                    previous[i] = previous[i - 1];
+                else
+                {
+                    final int key = ((wdata[off] & 0xFFFF) << 16) | (wdata[off + 1] & 0xFFFF);
+                    final int hash = (key * 0x9E3779B1) >>> (32 - CHAIN_HASH_BITS);
+
+                    previous[i] = head[hash];
+                    head[hash] = off;
+                }
+            }
         }
 
-        @Override
-        public String toString()
+        /**
+         * Returns previous position (before current run if inside a run) having the same word pair hash (-1 if none)
+         */
+        int getPrevious(int off)
         {
-            return "Off=" + offset + " - Repeat=" + repeat;
+            return previous[off - from];
         }
 
-        @Override
-        public int compareTo(WordMatch wm)
+        /**
+         * Returns number of following identical words at given position
+         */
+        int getRepeat(int off)
         {
-            return Integer.compare(offset, wm.offset);
+            return repeat[off - from];
         }
     }
 
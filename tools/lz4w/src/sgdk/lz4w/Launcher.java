@@ -4,15 +4,48 @@ import java.io.IOException;
 import java.nio.file.Files;
 import java.nio.file.Path;
 import java.nio.file.Paths;
+import java.util.ArrayList;
 import java.util.Arrays;
+import java.util.List;
 
 public class Launcher
 {
     /**
      * Launch the application.
      */
-    public static void main(String[] args)
+    public static void main(String[] argsIn)
     {
+        final List<String> argList = new ArrayList<>();
+
+        // extract options
+        for (int i = 0; i < argsIn.length; i++)
+        {
+            final String arg = argsIn[i];
+
+            if (arg.equalsIgnoreCase("--threads") || arg.equalsIgnoreCase("-threads"))
+            {
+                if ((i + 1) >= argsIn.length)
+                {
+                    showUsage();
+                    System.exit(2);
+                }
+
+                try
+                {
+                    LZ4W.setNumThread(Integer.parseInt(argsIn[++i]));
+                }
+                catch (NumberFormatException e)
+                {
+                    System.err.println("Invalid number of thread: " + argsIn[i]);
+                    System.exit(2);
+                }
+            }
+            else
+                argList.add(arg);
+        }
+
+        final String[] args = argList.toArray(new String[0]);
+
         if (args.length < 2)
         {
             showUsage();
@@ -166,6 +199,9 @@ public class Launcher
         System.out.println("  Unpack:   java -jar lz4w.jar u <input_file> <output_file>");
         System.out.println("            java -jar lz4w.jar u <prev_file>&<input_file> <output_file>");
         System.out.println();
+        System.out.println("Options:");
+        System.out.println("  --threads <n>   number of thread used for match search on large input (default = number of CPU, 1 = no multithreading)");
+        System.out.println();
         System.out.println("Tip: using an extra parameter after <output_file> will act as 'silent mode' switch");
     }
 
@@ -18,6 +18,10 @@ import java.util.HashSet;
 import java.util.List;
 import java.util.Map;
 import java.util.Set;
+import java.util.concurrent.CopyOnWriteArrayList;
+import java.util.concurrent.ExecutorService;
+import java.util.concurrent.Future;
+import java.util.function.Predicate;
 import java.util.jar.JarEntry;
 import java.util.jar.JarFile;
 
@@ -49,10 +53,13 @@ import sgdk.rescomp.resource.internal.Collision;
 import sgdk.rescomp.resource.internal.SpriteAnimation;
 import sgdk.rescomp.resource.internal.SpriteFrame;
 import sgdk.rescomp.resource.internal.VDPSprite;
+import sgdk.rescomp.tool.ElfWriter;
+import sgdk.rescomp.tool.ResourceCache;
 import sgdk.rescomp.type.Basics.Compression;
 import sgdk.rescomp.type.TMX;
 import sgdk.tool.FileUtil;
 import sgdk.tool.StringUtil;
+import sgdk.tool.SystemUtil;
 
 public class Compiler
 {
@@ -60,7 +67,10 @@ public class Compiler
     // private final static String REGEX_LETTERS = "[a-zA-Z]";
     // private final static String REGEX_ID = "\\b([A-Za-z][A-Za-z0-9_]*)\\b";
 
-    private final static List<Processor> resourceProcessors = new ArrayList<>();
+    // can be accessed from worker threads (parallel mode) while extensions are loaded
+    private final static List<Processor> resourceProcessors = new CopyOnWriteArrayList<>();
+    // built-in processors
+    private final static List<Processor> builtinProcessors = new ArrayList<>();
 
     static
     {
@@ -82,6 +92,8 @@ public class Compiler
         resourceProcessors.add(new WavProcessor());
         resourceProcessors.add(new XgmProcessor());
         resourceProcessors.add(new Xgm2Processor());
+
+        builtinProcessors.addAll(resourceProcessors);
     }
 
     // shared directory informations
@@ -102,6 +114,11 @@ public class Compiler
     public static boolean DAGame = false;
 
     public static boolean compile(String fileName, String fileNameOut, boolean asm, boolean header, String depTarget)
+    {
+        return compile(fileName, fileNameOut, asm, header, depTarget, false);
+    }
+
+    public static boolean compile(String fileName, String fileNameOut, boolean asm, boolean header, String depTarget, boolean parallel)
     {
         // get application directory
         // currentDir = new File("").getAbsolutePath();
@@ -128,12 +145,11 @@ public class Compiler
             return false;
         }
 
+        // resource lines (and their line number)
+        final List<String> resLines = new ArrayList<>();
+        final List<Integer> resLineNums = new ArrayList<>();
         int lineCnt = 0;
-        int align = -1;
-        boolean group = true;
-        boolean near = false;
-        
-        // process input resource file line by line
+
         for (String l : lines)
         {
             // cleanup the text
@@ -148,47 +164,89 @@ public class Compiler
             if (line.startsWith("//") || line.startsWith("#"))
                 continue;
 
-            // execute and get resource
-            final Resource resource = execute(line);
+            resLines.add(line);
+            resLineNums.add(Integer.valueOf(lineCnt));
+        }
 
-            // can't get resource ? --> error happened, stop here..
-            if (resource == null)
-            {
-                System.err.println(fileName + ": error on line " + lineCnt);
-                return false;
-            }
+        int align = -1;
+        boolean group = true;
+        boolean near = false;
 
-            // ALIGN function (not a real resource so handle it specifically)
-            if (resource instanceof Align)
-            {
-                align = ((Align) resource).align;
-                System.out.println();
-            }
-            // UNGROUP function (not a real resource so handle it specifically)
-            else if (resource instanceof Ungroup)
-            {
-                // disable resource export grouping by type
-                group = false;
-                System.out.println();
-            }
-            // NEAR function (not a real resource so handle it specifically)
-            else if (resource instanceof Near)
-            {
-                // enable forced near resource export
-                near = true;
-                System.out.println();
-            }
-            // just store resource
-            else
+        final ExecutorService executor = parallel ? ResourceSandbox.start(SystemUtil.getNumberOfCPUs()) : null;
+
+        try
+        {
+            // parallel mode ? --> execute resources in isolation on worker threads (committed below in line order)
+            final List<Future<ResourceSandbox>> sandboxes = parallel ? ResourceSandbox.executeAll(executor, resLines, builtinProcessors) : null;
+
+            // process input resource file line by line
+            for (int i = 0; i < resLines.size(); i++)
             {
-                addResource(resource);
-                // show raw size
-                System.out.println(" '" + resource.id + "' raw size: " + resource.totalSize() + " bytes");
-                // show more infos for MAP type resource
-                if (resource instanceof sgdk.rescomp.resource.Map)
-                    System.out.println(resource.toString());
+                final String line = resLines.get(i);
+                Resource resource = null;
+
+                if (sandboxes != null)
+                {
+                    final ResourceSandbox sandbox = ResourceSandbox.get(sandboxes.get(i));
+
+                    // sandbox execution can be committed ? --> get its resource
+                    if ((sandbox != null) && sandbox.commit())
+                        resource = sandbox.result;
+                }
+
+                // execute and get resource (if not already done)
+                if (resource == null)
+                    resource = execute(line);
+
+                // can't get resource ? --> error happened, stop here..
+                if (resource == null)
+                {
+                    System.err.println(fileName + ": error on line " + resLineNums.get(i));
+                    return false;
+                }
+
+                // ALIGN function (not a real resource so handle it specifically)
+                if (resource instanceof Align)
+                {
+                    align = ((Align) resource).align;
+                    System.out.println();
+                }
+                // UNGROUP function (not a real resource so handle it specifically)
+                else if (resource instanceof Ungroup)
+                {
+                    // disable resource export grouping by type
+                    group = false;
+                    System.out.println();
+                }
+                // NEAR function (not a real resource so handle it specifically)
+                else if (resource instanceof Near)
+                {
+                    // enable forced near resource export
+                    near = true;
+                    System.out.println();
+                }
+                // just store resource
+                else
+                {
+                    addResource(resource);
+                    // show raw size
+                    System.out.println(" '" + resource.id + "' raw size: " + resource.totalSize() + " bytes");
+                    // show more infos for MAP type resource
+                    if (resource instanceof sgdk.rescomp.resource.Map)
+                        System.out.println(resource.toString());
+                }
             }
         }
+        catch (IOException e)
+        {
+            System.err.println(e.getMessage());
+            return false;
+        }
+        finally
+        {
+            if (parallel)
+                ResourceSandbox.stop(executor);
+        }
 
         // Cross-checking all SObjects and resolving object field references
         TMX.TMXObjects.resolveObjectsReferencesInResourceList(resourcesList);
@@ -196,6 +254,11 @@ public class Compiler
         // separate output
         System.out.println();
 
+        // direct ELF object output ?
+        final boolean elf = StringUtil.equals(FileUtil.getFileExtension(fileNameOut, false).toLowerCase(), "o");
+        if (elf)
+            ElfWriter.begin();
+
         // define output files
         final StringBuilder outS = new StringBuilder(1024);
         final StringBuilder outH = new StringBuilder(1024);
@@ -215,6 +278,14 @@ public class Compiler
             outH.append("#ifndef _" + headerName + "_H_\n");
             outH.append("#define _" + headerName + "_H_\n\n");
 
+            // sprite engine must support the sprite resources format (library older than rescomp)
+            if (!getResources(Sprite.class).isEmpty())
+            {
+                outH.append("#if !defined(SPR_RES_FORMAT) || (SPR_RES_FORMAT < " + SpriteAnimation.FORMAT + ")\n");
+                outH.append("#error \"sprite resources were built for a newer SGDK version\"\n");
+                outH.append("#endif\n\n");
+            }
+
             // -- BINARY SECTION --
 
             // get "near" BIN resources
@@ -377,11 +448,15 @@ public class Compiler
 
             final int totalSize = unpackedSize + packedSize + spriteMetaSize + miscMetaSize;
             System.out.println("Total: " + totalSize + " bytes (" + Math.round(totalSize / 1024d) + " KB)");
+
+            if (ResourceCache.isEnabled())
+                System.out.println("Cache: " + ResourceCache.getHit() + " hit(s) - " + ResourceCache.getMiss() + " miss(es)");
         }
         catch (Throwable t)
         {
             System.err.println(t.getMessage());
             t.printStackTrace();
+            ElfWriter.end();
             return false;
         }
 
@@ -389,8 +464,11 @@ public class Compiler
 
         try
         {
+            // save .o file
+            if (asm && elf)
+                Files.write(Paths.get(fileNameOut), ElfWriter.assemble(outS.toString()));
             // save .s file
-            if (asm)
+            else if (asm)
             {
 	            out = new BufferedWriter(new FileWriter(fileNameOut));
 	            out.write(outS.toString());
@@ -412,12 +490,16 @@ public class Compiler
                 out.close();
             }
         }
-        catch (IOException e)
+        catch (IOException | IllegalArgumentException e)
         {
             System.err.println("Couldn't create output file:");
             System.err.println(e.getMessage());
             return false;
         }
+        finally
+        {
+            ElfWriter.end();
+        }
 
         return true;
     }
@@ -636,6 +718,10 @@ public class Compiler
 
     public static List<Resource> getResources(Class<? extends Resource> resourceType)
     {
+        final ResourceSandbox sandbox = ResourceSandbox.current();
+        if (sandbox != null)
+            return sandbox.getResources(resourceType);
+
         final List<Resource> result = new ArrayList<>();
 
         for (Resource resource : resourcesList)
@@ -745,11 +831,35 @@ public class Compiler
 
     public static Resource findResource(Resource resource)
     {
+        final ResourceSandbox sandbox = ResourceSandbox.current();
+        if (sandbox != null)
+            return sandbox.findResource(resource);
+
         return resources.get(resource);
     }
 
+    /**
+     * Returns the first resource of given type matching the specified predicate (null if not found)
+     */
+    public static <T extends Resource> T findResource(Class<T> resourceType, Predicate<T> predicate)
+    {
+        final ResourceSandbox sandbox = ResourceSandbox.current();
+        if (sandbox != null)
+            return sandbox.findResource(resourceType, predicate);
+
+        for (Resource resource : resourcesList)
+            if (resourceType.isInstance(resource) && predicate.test(resourceType.cast(resource)))
+                return resourceType.cast(resource);
+
+        return null;
+    }
+
     public static Resource addResource(Resource resource, boolean internal)
     {
+        final ResourceSandbox sandbox = ResourceSandbox.current();
+        if (sandbox != null)
+            return sandbox.addResource(resource, internal);
+
         // internal resource ?
         if (internal)
         {
@@ -781,7 +891,11 @@ public class Compiler
 
     public static void addResourceFile(String file)
     {
-        resourcesFile.add(file);
+        final ResourceSandbox sandbox = ResourceSandbox.current();
+        if (sandbox != null)
+            sandbox.addResourceFile(file);
+        else
+            resourcesFile.add(file);
     }
 
     public static Resource getResourceById(String id)
@@ -789,6 +903,10 @@ public class Compiler
         if (StringUtil.equals(id, "NULL"))
             return null;
 
+        final ResourceSandbox sandbox = ResourceSandbox.current();
+        if (sandbox != null)
+            return sandbox.getResourceById(id);
+
         for (Resource resource : resourcesList)
             if (resource.id.equals(id))
                 return resource;
@@ -796,17 +914,24 @@ public class Compiler
         return null;
     }
 
-    private static Resource execute(String input)
+    static String[] getFields(String input)
+    {
+        // regex pattern to properly separate quoted string
+        final String pattern = " +(?=(([^\"]*\"){2})*[^\"]*$)";
+        // split on space character and preserve quoted parts
+        final String[] fields = input.split(pattern);
+        // remove quotes
+        for (int f = 0; f < fields.length; f++)
+            fields[f] = fields[f].replaceAll("\"", "");
+
+        return fields;
+    }
+
+    static Resource execute(String input)
     {
         try
         {
-            // regex pattern to properly separate quoted string
-            final String pattern = " +(?=(([^\"]*\"){2})*[^\"]*$)";
-            // split on space character and preserve quoted parts
-            final String[] fields = input.split(pattern);
-            // remove quotes
-            for (int f = 0; f < fields.length; f++)
-                fields[f] = fields[f].replaceAll("\"", "");
+            final String[] fields = getFields(input);
 
             // get resource type
             final String type = fields[0];
@@ -1,5 +1,6 @@
 package sgdk.rescomp;
 
+import sgdk.rescomp.tool.ResourceCache;
 import sgdk.tool.FileUtil;
 
 public class Launcher
@@ -13,6 +14,8 @@ public class Launcher
         boolean asm = true;
         boolean header = true;
         boolean dep = false;
+        boolean parallel = false;
+        String cacheDir = null;
 
         // parse parameters
         for (int i = 0; i < args.length; i++)
@@ -25,6 +28,10 @@ public class Launcher
                 header = false;
             else if (param.equalsIgnoreCase("-dep"))
                 dep = true;
+            else if (param.equalsIgnoreCase("-parallel"))
+                parallel = true;
+            else if (param.equalsIgnoreCase("-cache") && ((i + 1) < args.length))
+                cacheDir = args[++i];
             else if (fileName == null)
                 fileName = param;
             else if (fileNameOut == null)
@@ -40,16 +47,22 @@ public class Launcher
             System.out.println("Error: missing the input file.");
             System.out.println();
             System.out.println("Usage:");
-            System.out.println("  rescomp input [output] [-noasm] [-noheader] [-dep <target_file>]");
+            System.out.println("  rescomp input [output] [-noasm] [-noheader] [-dep <target_file>] [-parallel] [-cache <dir>]");
             System.out.println("    input: the input resource file (.res)");
             System.out.println("    output: the asm output filename (same name is used for the include file)");
+            System.out.println("      use .o extension to directly generate the m68k ELF object file instead of the asm file");
             System.out.println("    -noasm: specify that we don't want to generate the assembly file (.s)");
 			System.out.println("    -noheader: specify that we don't want to generate the header file (.h)");
             System.out.println("    -dep: generate dependencies file (.d) for makefile");
             System.out.println("      <target_file> allow to specify the target filename in the .d file (not the destination of the .d file itself)");
+            System.out.println("    -parallel: process resources on all available CPU cores (output is identical to default serial processing)");
+            System.out.println("    -cache: store sprite cutting and compression results in <dir> and re-use them on next builds");
             System.out.println("  Ex: rescomp resources.res outres.s");
             System.out.println("  Ex: rescomp resources.res outres.s -noheader -dep");
             System.out.println("  Ex: rescomp resources.res outres.s -dep out/res/gfx.o");
+            System.out.println("  Ex: rescomp resources.res outres.s -parallel");
+            System.out.println("  Ex: rescomp resources.res outres.s -cache .rescomp_cache");
+            System.out.println("  Ex: rescomp resources.res outres.o");
 
             // stop here with error code 1
             System.exit(1);
@@ -65,8 +78,11 @@ public class Launcher
         if (dep && (depTarget == null))
             depTarget = fileNameOut;
 
+        // enable cache if asked
+        ResourceCache.setDirectory(cacheDir);
+
         // compile resources
-        boolean result = Compiler.compile(fileName, fileNameOut, asm, header, depTarget);
+        boolean result = Compiler.compile(fileName, fileNameOut, asm, header, depTarget, parallel);
 
         if (result)
             System.exit(0);
@@ -0,0 +1,375 @@
+package sgdk.rescomp;
+
+import java.io.ByteArrayOutputStream;
+import java.io.IOException;
+import java.io.OutputStream;
+import java.io.PrintStream;
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.HashMap;
+import java.util.HashSet;
+import java.util.List;
+import java.util.Map;
+import java.util.Set;
+import java.util.concurrent.ExecutionException;
+import java.util.concurrent.ExecutorService;
+import java.util.concurrent.Executors;
+import java.util.concurrent.Future;
+import java.util.function.Predicate;
+
+/**
+ * Isolated resource registry used to execute a resource line on a worker thread (parallel mode).<br>
+ * Resources and resource files added during execution are recorded locally then committed to the {@link Compiler}
+ * global state, in original line order, only if execution didn't depend on a resource from a previous line.<br>
+ * When that's not the case the line is simply executed again on the main thread so the output is always identical
+ * to a serial compilation.
+ */
+public class ResourceSandbox
+{
+    // resource types which should never be executed in parallel (shared temporary files or global ids)
+    private final static Set<String> SERIAL_TYPES = new HashSet<>(Arrays.asList("OBJECTS", "XGM", "XGM2"));
+
+    private final static ThreadLocal<ResourceSandbox> current = new ThreadLocal<>();
+
+    private static PrintStream sysOut = null;
+    private static PrintStream sysErr = null;
+
+    private static class Lookup<T extends Resource>
+    {
+        final Class<T> resourceType;
+        final Predicate<T> predicate;
+
+        Lookup(Class<T> resourceType, Predicate<T> predicate)
+        {
+            super();
+
+            this.resourceType = resourceType;
+            this.predicate = predicate;
+        }
+
+        boolean matchIn(List<Resource> resources)
+        {
+            for (Resource resource : resources)
+                if (resourceType.isInstance(resource) && predicate.test(resourceType.cast(resource)))
+                    return true;
+
+            return false;
+        }
+    }
+
+    /**
+     * Output stream dispatching to the sandbox capture buffer of the current thread if any
+     */
+    private static class SandboxOutputStream extends OutputStream
+    {
+        final PrintStream out;
+        final boolean err;
+
+        SandboxOutputStream(PrintStream out, boolean err)
+        {
+            super();
+
+            this.out = out;
+            this.err = err;
+        }
+
+        private OutputStream getTarget()
+        {
+            final ResourceSandbox sandbox = current.get();
+
+            if (sandbox == null)
+                return out;
+
+            return err ? sandbox.err : sandbox.out;
+        }
+
+        @Override
+        public void write(int b) throws IOException
+        {
+            getTarget().write(b);
+        }
+
+        @Override
+        public void write(byte[] b, int off, int len) throws IOException
+        {
+            getTarget().write(b, off, len);
+        }
+
+        @Override
+        public void flush() throws IOException
+        {
+            getTarget().flush();
+        }
+    }
+
+    final String line;
+
+    final Map<Resource, Resource> resources;
+    final List<Resource> resourcesList;
+    final Set<String> resourcesFile;
+    // resources searched in the registry (should not exist in the global registry)
+    final List<Resource> searched;
+    // custom searches (should not match any resource in the global registry)
+    final List<Lookup<?>> lookups;
+    // execution used resource(s) from previous line(s)
+    boolean dependent;
+
+    // captured output
+    final ByteArrayOutputStream out;
+    final ByteArrayOutputStream err;
+
+    Resource result;
+
+    ResourceSandbox(String line)
+    {
+        super();
+
+        this.line = line;
+
+        resources = new HashMap<>();
+        resourcesList = new ArrayList<>();
+        resourcesFile = new HashSet<>();
+        searched = new ArrayList<>();
+        lookups = new ArrayList<>();
+        dependent = false;
+
+        out = new ByteArrayOutputStream();
+        err = new ByteArrayOutputStream();
+
+        result = null;
+    }
+
+    /**
+     * Returns the sandbox attached to the current thread (null if we are not executing in a sandbox)
+     */
+    public static ResourceSandbox current()
+    {
+        return current.get();
+    }
+
+    /**
+     * Returns true if the given resource type can be safely executed in a sandbox
+     */
+    static boolean isParallelSafe(String type, List<Processor> builtinProcessors)
+    {
+        if (SERIAL_TYPES.contains(type.toUpperCase()))
+            return false;
+
+        // only allow built-in processors (we don't know how extensions behave)
+        for (Processor p : builtinProcessors)
+            if (type.equalsIgnoreCase(p.getId()))
+                return true;
+
+        return false;
+    }
+
+    /**
+     * Execute all given resource lines in their own sandbox using a worker pool.<br>
+     * Returned list contains a <code>null</code> future for lines which need to be executed serially.
+     */
+    static List<Future<ResourceSandbox>> executeAll(ExecutorService executor, List<String> lines, List<Processor> builtinProcessors)
+    {
+        final List<Future<ResourceSandbox>> result = new ArrayList<>();
+
+        for (String line : lines)
+        {
+            if (!isParallelSafe(Compiler.getFields(line)[0], builtinProcessors))
+            {
+                result.add(null);
+                continue;
+            }
+
+            result.add(executor.submit(() -> {
+                final ResourceSandbox sandbox = new ResourceSandbox(line);
+
+                current.set(sandbox);
+                try
+                {
+                    sandbox.result = Compiler.execute(line);
+                }
+                finally
+                {
+                    current.remove();
+                }
+
+                return sandbox;
+            }));
+        }
+
+        return result;
+    }
+
+    /**
+     * Create the worker pool and install the output dispatcher (captures sandbox output)
+     */
+    static ExecutorService start(int numThread)
+    {
+        if (sysOut == null)
+        {
+            sysOut = System.out;
+            sysErr = System.err;
+
+            System.setOut(new PrintStream(new SandboxOutputStream(sysOut, false), true));
+            System.setErr(new PrintStream(new SandboxOutputStream(sysErr, true), true));
+        }
+
+        return Executors.newFixedThreadPool(numThread);
+    }
+
+    /**
+     * Stop the worker pool and restore default output
+     */
+    static void stop(ExecutorService executor)
+    {
+        if (executor != null)
+            executor.shutdownNow();
+
+        if (sysOut != null)
+        {
+            System.out.flush();
+            System.err.flush();
+            System.setOut(sysOut);
+            System.setErr(sysErr);
+            sysOut = null;
+            sysErr = null;
+        }
+    }
+
+    /**
+     * Wait for sandbox execution completion (returns null if execution failed)
+     */
+    static ResourceSandbox get(Future<ResourceSandbox> future)
+    {
+        if (future == null)
+            return null;
+
+        try
+        {
+            return future.get();
+        }
+        catch (InterruptedException | ExecutionException e)
+        {
+            return null;
+        }
+    }
+
+    Resource findResource(Resource resource)
+    {
+        searched.add(resource);
+        return resources.get(resource);
+    }
+
+    <T extends Resource> T findResource(Class<T> resourceType, Predicate<T> predicate)
+    {
+        lookups.add(new Lookup<>(resourceType, predicate));
+
+        for (Resource resource : resourcesList)
+            if (resourceType.isInstance(resource) && predicate.test(resourceType.cast(resource)))
+                return resourceType.cast(resource);
+
+        return null;
+    }
+
+    Resource addResource(Resource resource, boolean internal)
+    {
+        // internal resource ?
+        if (internal)
+        {
+            // check if we already have this resource
+            final Resource result = findResource(resource);
+
+            // return it if already exists
+            if (result != null)
+            {
+                System.out.println("Info: '" + resource.id + "' has same content as '" + result.id + "'");
+                return result;
+            }
+
+            // mark as not global (internal)
+            resource.global = false;
+        }
+
+        // add resource
+        resources.put(resource, resource);
+        resourcesList.add(resource);
+
+        return resource;
+    }
+
+    void addResourceFile(String file)
+    {
+        resourcesFile.add(file);
+    }
+
+    Resource getResourceById(String id)
+    {
+        // we need resource from a previous line --> can't commit
+        dependent = true;
+
+        for (Resource resource : resourcesList)
+            if (resource.id.equals(id))
+                return resource;
+
+        return null;
+    }
+
+    List<Resource> getResources(Class<? extends Resource> resourceType)
+    {
+        // we need resources from previous lines --> can't commit
+        dependent = true;
+
+        final List<Resource> result = new ArrayList<>();
+
+        for (Resource resource : resourcesList)
+            if ((resourceType == null) || resourceType.isInstance(resource))
+                result.add(resource);
+
+        return result;
+    }
+
+    /**
+     * Returns true if sandbox execution gives the same result as a serial execution would have given with the current
+     * global state.
+     */
+    boolean isValid()
+    {
+        // execution failed or depends from previous resources
+        if ((result == null) || dependent)
+            return false;
+
+        // serial execution would have found an existing resource
+        for (Resource resource : searched)
+            if (Compiler.resources.get(resource) != null)
+                return false;
+        for (Lookup<?> lookup : lookups)
+            if (lookup.matchIn(Compiler.resourcesList))
+                return false;
+
+        return true;
+    }
+
+    /**
+     * Commit sandbox resources and captured output to the global state (should be called from main thread).
+     *
+     * @return <code>false</code> if the sandbox cannot be committed (line need to be executed again serially)
+     */
+    boolean commit() throws IOException
+    {
+        if (!isValid())
+            return false;
+
+        // display captured output
+        out.writeTo(System.out);
+        err.writeTo(System.err);
+
+        // add resources in original order
+        for (Resource resource : resourcesList)
+        {
+            Compiler.resources.put(resource, resource);
+            Compiler.resourcesList.add(resource);
+        }
+        Compiler.resourcesFile.addAll(resourcesFile);
+
+        return true;
+    }
+}
@@ -28,7 +28,7 @@ public class MapProcessor implements Processor
         if (fields.length < 4)
         {
             System.out.println("Wrong MAP definition");
-            System.out.println("MAP name \"img_file\" tileset_id [compression [map_base]]");
+            System.out.println("MAP name \"img_file\" tileset_id [compression [map_base [streaming]]]");
             System.out.println("  name          Map variable name");
             System.out.println("  img_file      path of the input image file (BMP or PNG image file)");
             System.out.println("  tileset_id    base tileset resource to use (allow to share tileset along several maps)");
@@ -39,8 +39,10 @@ public class MapProcessor implements Processor
             System.out.println("                    2 / FAST / LZ4W = custom lz4 compression (average compression ratio but fast)");
             System.out.println("  map_base      define the base tilemap value, useful to set a default priority, palette and base tile index offset");
             System.out.println("                    using a base tile index offset (static tile allocation) allow to use faster MAP decoding function internally.");
+            System.out.println("  streaming     set to TRUE to store block indexes as small independently packed chunks unpacked on demand (FALSE by default)");
+            System.out.println("                    it greatly reduces memory usage for large compressed map (only used when compression is enabled).");
             System.out.println();
-            System.out.println("MAP name \"tmx_file\" \"layer_id\" [ts_compression [map_compression [map_base [ordering]]]]");
+            System.out.println("MAP name \"tmx_file\" \"layer_id\" [ts_compression [map_compression [map_base [ordering [streaming]]]]]");
             System.out.println("  name              Map variable name");
             System.out.println("  tmx_file          path of the input TMX file (TMX Tiled file)");
             System.out.println("  layer_id          layer name we want to extract map data from.");
@@ -55,6 +57,7 @@ public class MapProcessor implements Processor
             System.out.println("  ordering          define the map process order, accepted values:");
             System.out.println("                        ROW             = process per row (default)");
             System.out.println("                        COLUMN          = process per column");
+            System.out.println("  streaming         set to TRUE to store block indexes as small independently packed chunks unpacked on demand (FALSE by default)");
 
             return null;
         }
@@ -87,12 +90,16 @@ public class MapProcessor implements Processor
             TileOrdering order = TileOrdering.ROW;
             if (fields.length >= 8)
                 order = Util.getTileOrdering(fields[7]);
+            // get streaming
+            boolean streaming = false;
+            if (fields.length >= 9)
+                streaming = StringUtil.parseBoolean(fields[8], false);
 
             // build TMX map
             final TMXMap tmxMap = new TMXMap(fileIn, layerName);
             // then build MAP from TMX Map
             return new Map(id, tmxMap.getMapImage(), tmxMap.w * tmxMap.tileSize, tmxMap.h * tmxMap.tileSize, mapBase, 2,
-                           tmxMap.getTilesets(id, tileSetCompression, false, order), mapCompression, true);
+                           tmxMap.getTilesets(id, tileSetCompression, false, order), mapCompression, true, streaming);
         }
 
         // image file
@@ -111,9 +118,13 @@ public class MapProcessor implements Processor
             int mapBase = 0;
             if (fields.length >= 6)
                 mapBase = StringUtil.parseInt(fields[5], 0);
+            // get streaming
+            boolean streaming = false;
+            if (fields.length >= 7)
+                streaming = StringUtil.parseBoolean(fields[6], false);
 
             // build MAP from an image
-            return Map.getMap(id, fileIn, mapBase, 2, Util.asList(tileset), compression, true);
+            return Map.getMap(id, fileIn, mapBase, 2, Util.asList(tileset), compression, true, streaming);
         }
     }
 }
@@ -62,18 +62,12 @@ public class Xgm2Processor implements Processor
             else fileIns.add(FileUtil.adjustPath(Compiler.resDir, field));
         }
 
-        // convert VGM to bin
-        if (!Util.xgm2tool(fileIns, "out.xgc", options))
-            throw new IOException("Error while compiling file(s) '" + String.join(" ", fileIns) + "' to BIN format");
-
-        // read data from binary file
-        final byte[] data = Util.in("out.xgc");
-        // clean temp file
-        FileUtil.delete("out.xgc", false);
+        // convert VGM to bin (in memory when possible)
+        final byte[] data = Util.xgm2tool(fileIns, options);
 
-        // error while reading data
+        // error while converting data
         if (data == null)
-            throw new IOException("Can't read data from result file !");
+            throw new IOException("Error while compiling file(s) '" + String.join(" ", fileIns) + "' to BIN format");
 
         // add resource file (used for deps generation)
         fileIns.forEach((fileIn) -> Compiler.addResourceFile(fileIn));
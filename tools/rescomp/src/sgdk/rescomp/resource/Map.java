@@ -3,23 +3,32 @@ package sgdk.rescomp.resource;
 import java.io.ByteArrayOutputStream;
 import java.util.ArrayList;
 import java.util.Arrays;
+import java.util.HashMap;
 import java.util.List;
 
 import sgdk.rescomp.Resource;
 import sgdk.rescomp.tool.Util;
 import sgdk.rescomp.type.Basics.Compression;
+import sgdk.rescomp.type.Basics.PackedData;
 import sgdk.rescomp.type.Basics.TileEquality;
 import sgdk.rescomp.type.Basics.TileOptimization;
 import sgdk.rescomp.type.Basics.TileOrdering;
 import sgdk.rescomp.type.MapBlock;
 import sgdk.rescomp.type.Metatile;
 import sgdk.rescomp.type.Tile;
+import sgdk.tool.ArrayUtil;
 import sgdk.tool.ImageUtil;
 import sgdk.tool.ImageUtil.BasicImageInfo;
 
 public class Map extends Resource
 {
     public static Map getMap(String id, String imgFile, int mapBase, int metatileSize, List<Tileset> tilesets, Compression compression, boolean addTileset) throws Exception
+    {
+        return getMap(id, imgFile, mapBase, metatileSize, tilesets, compression, addTileset, false);
+    }
+
+    public static Map getMap(String id, String imgFile, int mapBase, int metatileSize, List<Tileset> tilesets, Compression compression, boolean addTileset,
+            boolean streaming) throws Exception
     {
         // get 8bpp pixels and also check image dimension is aligned to tile
         final byte[] image = ImageUtil.getImageAs8bpp(imgFile, true, true);
@@ -45,12 +54,24 @@ public class Map extends Resource
         // we determine 'h' from data length and 'w' as we can crop image vertically to remove palette data
         final int h = image.length / w;
 
-        return new Map(id, image, w, h, mapBase, metatileSize, tilesets, compression, addTileset);
+        return new Map(id, image, w, h, mapBase, metatileSize, tilesets, compression, addTileset, streaming);
     }
 
+    // minimum size (in byte) of a streamed block indexes chunk
+    final static int STREAM_CHUNK_MIN_SIZE = 256;
+    // maximum chunk row shift (3 bits in MapDefinition.compression)
+    final static int STREAM_CHUNK_MAX_SFT = 7;
+    // number of chunk cache slot (should match MAP_STREAMING_SLOT in map.h)
+    final static int STREAM_SLOT = 4;
+    // size of MapStream structure allocated for streamed map (should match MAP_STREAM_SIZE in map.h)
+    final static int STREAM_STRUCT_SIZE = (2 * 4) + (5 * 2) + (STREAM_SLOT * 2 * 2) + 4;
+
     public final int wb;
     public final int hb;
     public final Compression compression;
+    public final boolean streaming;
+    // number of block row per streamed chunk (shift)
+    final int chunkRowSft;
     final int hc;
 
     public final List<Metatile> metatiles;
@@ -65,8 +86,18 @@ public class Map extends Resource
     public final Bin mapBlockIndexesBin;
     public final Bin mapBlockRowOffsetsBin;
 
+    // fast index lookup (same as Tileset.tileIndexesMap)
+    final private java.util.Map<Metatile, Integer> metatileIndexesMap;
+    final private java.util.Map<MapBlock, Integer> mapBlockIndexesMap;
+
     public Map(String id, byte[] image8bpp, int imageWidth, int imageHeight, int mapBase, int metatileSize, List<Tileset> tilesets, Compression compression,
             boolean addTileset) throws IllegalArgumentException
+    {
+        this(id, image8bpp, imageWidth, imageHeight, mapBase, metatileSize, tilesets, compression, addTileset, false);
+    }
+
+    public Map(String id, byte[] image8bpp, int imageWidth, int imageHeight, int mapBase, int metatileSize, List<Tileset> tilesets, Compression compression,
+            boolean addTileset, boolean streaming) throws IllegalArgumentException
     {
         super(id);
 
@@ -99,6 +130,8 @@ public class Map extends Resource
 
         // store compression
         this.compression = compression;
+        // streaming is only useful with compressed block indexes
+        this.streaming = streaming && (compression != Compression.NONE);
 
         // get size in block
         wb = (wt + 15) / 16;
@@ -110,6 +143,8 @@ public class Map extends Resource
         metatiles = new ArrayList<>();
         // build MAPBLOCKS
         mapBlocks = new ArrayList<>();
+        metatileIndexesMap = new HashMap<>();
+        mapBlockIndexesMap = new HashMap<>();
         // build block indexes
         mapBlockIndexes = new ArrayList<>();
         // build block row offsets
@@ -198,6 +233,7 @@ public class Map extends Resource
                             mtIndex = metatiles.size();
                             // add to MetaTiles list
                             metatiles.add(mt);
+                            metatileIndexesMap.put(mt, Integer.valueOf(mtIndex));
                         }
 
                         // set block attributes (metatile index only here)
@@ -217,6 +253,7 @@ public class Map extends Resource
                     mbIndex = mapBlocks.size();
                     // add to MapBlock list
                     mapBlocks.add(mb);
+                    mapBlockIndexesMap.put(mb, Integer.valueOf(mbIndex));
                 }
 
                 // store MapBlock index (we can't have more than 65536 blocks)
@@ -289,26 +326,38 @@ public class Map extends Resource
         }
 
         // require 16 bit index ? --> directly use mapBlockIndexes map
-        if (mapBlocks.size() > 256)
+        final boolean index16 = mapBlocks.size() > 256;
+        // size of a block index row (in byte)
+        final int rowSize = wb * (index16 ? 2 : 1);
+        final byte[] mbiData = new byte[mapBlockIndexes.size() * rowSize];
+
+        offset = 0;
+        for (short[] rowIndexes : mapBlockIndexes)
         {
-            // 16 bit index
-            final short[] mbiData = new short[mapBlockIndexes.size() * wb];
-            offset = 0;
-            for (short[] rowIndexes : mapBlockIndexes)
-                for (short ind : rowIndexes)
-                    mbiData[offset++] = ind;
+            for (short ind : rowIndexes)
+            {
+                // 16 bit index (big endian)
+                if (index16)
+                    mbiData[offset++] = (byte) (ind >> 8);
+                mbiData[offset++] = (byte) ind;
+            }
+        }
 
-            // build BIN (mapBlockIndexes data)
-            mapBlockIndexesBin = (Bin) addInternalResource(new Bin(id + "_mapBlockIndexes", mbiData, compression));
+        if (this.streaming)
+        {
+            // choose number of row per chunk so chunk is large enough to be worth packing
+            int sft = 0;
+            while ((sft < STREAM_CHUNK_MAX_SFT) && ((rowSize << sft) < STREAM_CHUNK_MIN_SIZE) && ((1 << sft) < mapBlockIndexes.size()))
+                sft++;
+            chunkRowSft = sft;
+
+            // build BIN (streamed mapBlockIndexes data) - chunks are already packed
+            mapBlockIndexesBin = (Bin) addInternalResource(
+                    new Bin(id + "_mapBlockIndexes", buildStreamedBlockIndexes(mbiData, rowSize, mapBlockIndexes.size(), sft, compression), Compression.NONE));
         }
         else
         {
-            // 8 bit index
-            final byte[] mbiData = new byte[mapBlockIndexes.size() * wb];
-            offset = 0;
-            for (short[] rowIndexes : mapBlockIndexes)
-                for (short ind : rowIndexes)
-                    mbiData[offset++] = (byte) ind;
+            chunkRowSft = 0;
 
             // build BIN (mapBlockIndexes data)
             mapBlockIndexesBin = (Bin) addInternalResource(new Bin(id + "_mapBlockIndexes", mbiData, compression));
@@ -331,6 +380,13 @@ public class Map extends Resource
                 // add metatiles definition RAW size
                 ts += metatiles.size() * 4 * 2;
             }
+            // streamed block indexes are never fully unpacked, only the chunk cache is allocated
+            if (this.streaming)
+            {
+                ts -= mapBlockIndexesBin.totalSize();
+                // cache slots + row offsets + MapStream structure
+                ts += ((((rowSize << chunkRowSft) + 1) & ~1) * STREAM_SLOT) + (hb * 2) + STREAM_STRUCT_SIZE;
+            }
 
             // above 48 KB ? --> error
             if (ts > (48 * 1024))
@@ -348,22 +404,24 @@ public class Map extends Resource
 
     public int getMetaTileIndex(Metatile metatile)
     {
-        for (int ind = 0; ind < metatiles.size(); ind++)
-        {
-            final Metatile mt = metatiles.get(ind);
-
-            // we found a matching metatile --> return its index
-            if (mt.equals(metatile))
-                return ind;
-        }
+        final Integer result = metatileIndexesMap.get(metatile);
 
         // not found
-        return -1;
+        if (result == null)
+            return -1;
+
+        return result.intValue();
     }
 
     private int getBlockIndex(MapBlock mapBlock)
     {
-        return mapBlocks.indexOf(mapBlock);
+        final Integer result = mapBlockIndexesMap.get(mapBlock);
+
+        // not found
+        if (result == null)
+            return -1;
+
+        return result.intValue();
     }
 
     /**
@@ -382,10 +440,55 @@ public class Map extends Resource
         return hb;
     }
 
+    /**
+     * Build streamed block indexes data: chunk table (one entry per chunk + end entry, b31-b24 = compression, b23-b0 =
+     * offset from data start) followed by the chunks, each chunk containing (1 << sft) rows packed independently so
+     * it can be unpacked on demand.
+     */
+    private static byte[] buildStreamedBlockIndexes(byte[] data, int rowSize, int numRow, int sft, Compression compression)
+    {
+        final int chunkRows = 1 << sft;
+        final int numChunk = (numRow + (chunkRows - 1)) / chunkRows;
+        final int[] chunkTable = new int[numChunk + 1];
+        final ByteArrayOutputStream chunks = new ByteArrayOutputStream();
+        final int headerSize = chunkTable.length * 4;
+
+        for (int c = 0; c < numChunk; c++)
+        {
+            final int start = c * chunkRows * rowSize;
+            final int end = Math.min(data.length, start + (chunkRows * rowSize));
+            // pack chunk independently (no previous data window)
+            final PackedData packed = Util.pack(Arrays.copyOfRange(data, start, end), compression, null);
+
+            chunkTable[c] = ((packed.compression.ordinal() - 1) << 24) | (headerSize + chunks.size());
+            chunks.write(packed.data, 0, packed.data.length);
+            // keep chunk word aligned
+            if ((chunks.size() & 1) != 0)
+                chunks.write(0);
+        }
+        // end entry (total size)
+        chunkTable[numChunk] = headerSize + chunks.size();
+
+        final byte[] header = ArrayUtil.intToByte(chunkTable);
+        final byte[] result = new byte[header.length + chunks.size()];
+
+        System.arraycopy(header, 0, result, 0, header.length);
+        System.arraycopy(chunks.toByteArray(), 0, result, header.length, chunks.size());
+
+        return result;
+    }
+
     private int getCompression()
     {
         int result = 0;
 
+        if (streaming)
+        {
+            // streaming flag and chunk row shift
+            result += 8 + chunkRowSft;
+            result <<= 4;
+        }
+
         result += (mapBlockIndexesBin.packedData.compression.ordinal() - 1);
         result <<= 4;
         result += (mapBlocksBin.packedData.compression.ordinal() - 1);
@@ -468,6 +571,7 @@ public class Map extends Resource
     {
         // display info about map encoding
         return "MAP '" + id + "' details: " + tilesets.size() + " tilesets, " + metatiles.size() + " metatiles, " + mapBlocks.size()
-                + " blocks, block grid size = " + wb + " x " + hb + " - optimized = " + wb + " x " + mapBlockIndexes.size();
+                + " blocks, block grid size = " + wb + " x " + hb + " - optimized = " + wb + " x " + mapBlockIndexes.size()
+                + (streaming ? (" - streamed (" + (1 << chunkRowSft) + " rows per chunk)") : "");
     }
 }
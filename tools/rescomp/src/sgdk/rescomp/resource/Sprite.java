@@ -228,9 +228,12 @@ public class Sprite extends Resource
         // set maximum number of tile used by a single animation frame (used for VRAM tile space
         // allocation)
         outS.append("    dc.w    " + maxNumTile + "\n");
+        // set resource format (tells the sprite engine Animation has the deltas field, older rescomp
+        // stored 0 here as high byte of maxNumSprite)
+        outS.append("    dc.b    " + SpriteAnimation.FORMAT + "\n");
         // set maximum number of VDP sprite used by a single animation frame (used for VDP sprite
         // allocation)
-        outS.append("    dc.w    " + maxNumSprite + "\n");
+        outS.append("    dc.b    " + maxNumSprite + "\n");
 
         outS.append("\n");
     }
@@ -14,7 +14,6 @@ import java.util.List;
 import sgdk.rescomp.Resource;
 import sgdk.rescomp.tool.Util;
 import sgdk.rescomp.type.Basics.Compression;
-import sgdk.rescomp.type.Basics.TileEquality;
 import sgdk.rescomp.type.Basics.TileOptimization;
 import sgdk.rescomp.type.Basics.TileOrdering;
 import sgdk.rescomp.type.Tile;
@@ -79,7 +78,7 @@ public class Tileset extends Resource
     // internals
     final boolean isDuplicate;
     final private java.util.Map<Tile, Integer> tileIndexesMap;
-    final private java.util.Map<Integer, List<Tile>> tileByHashcodeMap;
+    final private java.util.Map<Tile.FlipKey, Tile> tileByFlipKeyMap;
 
     // special constructor for TSX (can have several tilesets for a single map)
     public Tileset(List<Tileset> tilesets)
@@ -88,7 +87,7 @@ public class Tileset extends Resource
 
         tiles = new ArrayList<>();
         tileIndexesMap = new HashMap<>();
-        tileByHashcodeMap = new HashMap<>();
+        tileByFlipKeyMap = new HashMap<>();
         isDuplicate = false;
 
         // !! don't optimize tilesets (important to preserve tile indexes here) !!
@@ -120,7 +119,7 @@ public class Tileset extends Resource
 
         tiles = new ArrayList<>();
         tileIndexesMap = new HashMap<>();
-        tileByHashcodeMap = new HashMap<>();
+        tileByFlipKeyMap = new HashMap<>();
         isDuplicate = false;
 
         // dummy bin
@@ -136,7 +135,7 @@ public class Tileset extends Resource
 
         tiles = new ArrayList<>();
         tileIndexesMap = new HashMap<>();
-        tileByHashcodeMap = new HashMap<>();
+        tileByFlipKeyMap = new HashMap<>();
         isDuplicate = false;
 
         final int[] data;
@@ -175,7 +174,7 @@ public class Tileset extends Resource
 
         tiles = new ArrayList<>();
         tileIndexesMap = new HashMap<>();
-        tileByHashcodeMap = new HashMap<>();
+        tileByFlipKeyMap = new HashMap<>();
 
         // important to always use the **same loop order** when building Tileset and Tilemap/Map object
         if (order == TileOrdering.ROW)
@@ -262,7 +261,7 @@ public class Tileset extends Resource
 
         tiles = new ArrayList<>();
         tileIndexesMap = new HashMap<>();
-        tileByHashcodeMap = new HashMap<>();
+        tileByFlipKeyMap = new HashMap<>();
 
         for (Rectangle rect : sprites)
         {
@@ -337,16 +336,8 @@ public class Tileset extends Resource
         // if (!tileIndexesMap.containsKey(tile))
         tileIndexesMap.put(tile, Integer.valueOf(tiles.size()));
 
-        final Integer hashKey = Integer.valueOf(tile.hashCode());
-        List<Tile> hashTiles = tileByHashcodeMap.get(hashKey);
-
-        if (hashTiles == null)
-        {
-            hashTiles = new ArrayList<>();
-            tileByHashcodeMap.put(hashKey, hashTiles);
-        }
-
-        hashTiles.add(tile);
+        // keep first tile for a given flip key (first flipped match)
+        tileByFlipKeyMap.putIfAbsent(tile.getFlipKey(), tile);
     }
 
     public int getTileIndex(Tile tile, TileOptimization opt)
@@ -364,20 +355,12 @@ public class Tileset extends Resource
         // allow flip ?
         if (opt == TileOptimization.ALL)
         {
-            // get all tiles with same hash code
-            final List<Tile> hashTiles = tileByHashcodeMap.get(Integer.valueOf(tile.hashCode()));
+            // get tile sharing the same flip invariant key (no perfect match so it's necessary a flipped version)
+            final Tile t = tileByFlipKeyMap.get(tile.getFlipKey());
 
-            // have some ?
-            if (hashTiles != null)
-            {
-                for (Tile t : hashTiles)
-                {
-                    // flipped version ?
-                    if (t.getFlipEquality(tile) != TileEquality.NONE)
-                        // return index of the original tile
-                        return tileIndexesMap.get(t).intValue();
-                }
-            }
+            // found ? --> return index of the original tile
+            if (t != null)
+                return tileIndexesMap.get(t).intValue();
         }
 
         // // always do a first pass for direct matching (preferred choice if possible)
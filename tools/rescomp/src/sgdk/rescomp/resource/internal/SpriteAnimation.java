@@ -22,6 +22,11 @@ import sgdk.tool.ImageUtil;
 
 public class SpriteAnimation extends Resource
 {
+    // sprite resource binary format version stored in SpriteDefinition.format, must match SPR_RES_FORMAT in sprite_eng.h (2 = animation tile deltas)
+    public final static int FORMAT = 2;
+    // max number of tile range for a frame tile delta (each range requires a DMA transfer)
+    final static int MAX_DELTA_RANGE = 8;
+
     public final List<SpriteFrame> frames;
     public final Set<SpriteFrame> frameSet;
     public int loopIndex;
@@ -128,15 +133,7 @@ public class SpriteAnimation extends Resource
 
     private SpriteFrame findMatchingSpriteFrameMask(byte[] frameImage, Dimension dimension)
     {
-        for (Resource res : Compiler.getResources(SpriteFrame.class))
-        {
-            final SpriteFrame spriteFrame = (SpriteFrame) res;
-
-            if (checkMaskEqual(spriteFrame, frameImage, dimension))
-                return spriteFrame;
-        }
-
-        return null;
+        return Compiler.findResource(SpriteFrame.class, spriteFrame -> checkMaskEqual(spriteFrame, frameImage, dimension));
     }
 
     private boolean checkMaskEqual(SpriteFrame spriteFrame, byte[] frameImage, Dimension dimension)
@@ -180,6 +177,59 @@ public class SpriteAnimation extends Resource
         return result;
     }
 
+    /**
+     * Returns index of the frame preceding the given frame index when animation is played sequentially (-1 if none)
+     */
+    public int getPreviousFrameIndex(int index)
+    {
+        // loop frame is reached from last frame (most frequent transition)
+        if (index == loopIndex)
+            return (frames.size() > 1) ? frames.size() - 1 : -1;
+
+        return index - 1;
+    }
+
+    /**
+     * Computes the tile ranges (first tile index, number of tile) of <i>to</i> frame which differ from <i>from</i> frame.<br>
+     * These are the only tiles to upload when going from <i>from</i> frame to <i>to</i> frame (assuming <i>from</i> tiles are
+     * still in VRAM).<br>
+     * Returns <code>null</code> if a delta upload doesn't save anything compared to a full frame upload.
+     */
+    static List<int[]> computeTileDelta(SpriteFrame from, SpriteFrame to)
+    {
+        final int numTile = to.getNumTile();
+        final int fromNumTile = from.getNumTile();
+        final List<int[]> result = new ArrayList<>();
+        int changed = 0;
+
+        for (int t = 0; t < numTile; t++)
+        {
+            // same tile at same position --> nothing to upload
+            if ((t < fromNumTile) && Arrays.equals(from.tileset.get(t).data, to.tileset.get(t).data))
+                continue;
+
+            final int[] last = result.isEmpty() ? null : result.get(result.size() - 1);
+
+            // extend last range (we also merge single unchanged tile gap as a DMA transfer costs more than a tile)
+            if ((last != null) && ((last[0] + last[1] + 1) >= t))
+            {
+                changed += t - (last[0] + last[1]) + 1;
+                last[1] = (t - last[0]) + 1;
+            }
+            else
+            {
+                changed++;
+                result.add(new int[] {t, 1});
+            }
+        }
+
+        // no gain or too many transfers --> use full upload
+        if ((changed >= numTile) || (result.size() > MAX_DELTA_RANGE))
+            return null;
+
+        return result;
+    }
+
     public int getMaxNumSprite()
     {
         int result = 0;
@@ -223,7 +273,27 @@ public class SpriteAnimation extends Resource
     @Override
     public int shallowSize()
     {
-        return (frames.size() * 4) + 1 + 1 + 4;
+        int result = (frames.size() * 4) + 1 + 1 + 4 + 4;
+        int deltaSize = 0;
+
+        for (int i = 0; i < frames.size(); i++)
+        {
+            final int prev = getPreviousFrameIndex(i);
+
+            if (prev != -1)
+            {
+                final List<int[]> ranges = computeTileDelta(frames.get(prev), frames.get(i));
+
+                if (ranges != null)
+                    deltaSize += 4 + 2 + 2 + (ranges.size() * 4);
+            }
+        }
+
+        // deltas pointer table only exists if we have at least one delta
+        if (deltaSize > 0)
+            result += deltaSize + (frames.size() * 4);
+
+        return result;
     }
 
     @Override
@@ -250,12 +320,58 @@ public class SpriteAnimation extends Resource
 
         outS.append("\n");
 
+        // FrameTileDelta structures (tiles to upload when reaching frame from previous frame)
+        final String[] deltaIds = new String[frames.size()];
+        boolean hasDelta = false;
+
+        for (int i = 0; i < frames.size(); i++)
+        {
+            final int prev = getPreviousFrameIndex(i);
+            if (prev == -1)
+                continue;
+
+            final SpriteFrame from = frames.get(prev);
+            final List<int[]> ranges = computeTileDelta(from, frames.get(i));
+            if (ranges == null)
+                continue;
+
+            int numTile = 0;
+            for (int[] range : ranges)
+                numTile += range[1];
+
+            deltaIds[i] = id + "_delta" + i;
+            hasDelta = true;
+
+            Util.decl(outS, outH, null, deltaIds[i], 2, false);
+            // source frame
+            outS.append("    dc.l    " + from.id + "\n");
+            // total number of tile and number of range
+            outS.append("    dc.w    " + numTile + ", " + ranges.size() + "\n");
+            // ranges (first tile index, number of tile)
+            for (int[] range : ranges)
+                outS.append("    dc.w    " + range[0] + ", " + range[1] + "\n");
+
+            outS.append("\n");
+        }
+
+        // deltas pointer table
+        if (hasDelta)
+        {
+            Util.decl(outS, outH, null, id + "_deltas", 2, false);
+            for (String deltaId : deltaIds)
+                outS.append("    dc.l    " + ((deltaId != null) ? deltaId : "0") + "\n");
+
+            outS.append("\n");
+        }
+
         // Animation structure
         Util.decl(outS, outH, "Animation", id, 2, global);
         // set number of frame and loop info
         outS.append("    dc.w    " + ((frames.size() << 8) | ((loopIndex << 0) & 0xFF)) + "\n");
         // set frames pointer
         outS.append("    dc.l    " + id + "_frames\n");
+        // set frame tile deltas pointer
+        outS.append("    dc.l    " + (hasDelta ? (id + "_deltas") : "0") + "\n");
 
         outS.append("\n");
     }
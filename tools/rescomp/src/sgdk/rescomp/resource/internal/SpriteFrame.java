@@ -11,6 +11,7 @@ import java.util.List;
 import sgdk.rescomp.Resource;
 import sgdk.rescomp.resource.Bin;
 import sgdk.rescomp.resource.Tileset;
+import sgdk.rescomp.tool.ResourceCache;
 import sgdk.rescomp.tool.SpriteCutter;
 import sgdk.rescomp.tool.Util;
 import sgdk.rescomp.type.Basics;
@@ -20,6 +21,7 @@ import sgdk.rescomp.type.Basics.Compression;
 import sgdk.rescomp.type.SpriteCell;
 import sgdk.rescomp.type.SpriteCell.OptimizationLevel;
 import sgdk.rescomp.type.SpriteCell.OptimizationType;
+import sgdk.tool.ArrayUtil;
 import sgdk.tool.ImageUtil;
 
 public class SpriteFrame extends Resource
@@ -146,6 +148,71 @@ public class SpriteFrame extends Resource
     }
     
     static List<SpriteCell> computeSpriteCutting(String id, byte[] frameImage8bpp, int wf, int hf, OptimizationType optType, OptimizationLevel optLevel) throws UnsupportedOperationException
+    {
+        // cache disabled or no optimization ? --> directly compute sprite cutting
+        if (!ResourceCache.isEnabled() || (optType == OptimizationType.NONE))
+            return doComputeSpriteCutting(id, frameImage8bpp, wf, hf, optType, optLevel);
+
+        final String key = ResourceCache.getKey("sprite", frameImage8bpp, Integer.valueOf(wf), Integer.valueOf(hf), optType, optLevel);
+        final byte[] cached = ResourceCache.get("sprite", key);
+
+        // cache hit ? (x, y, width, height, optimization type for each sprite)
+        if (cached != null)
+        {
+            final List<SpriteCell> result = getCachedSpriteCutting(cached);
+
+            if (result != null)
+                return result;
+
+            // invalid entry --> remove it and compute again
+            ResourceCache.invalidate("sprite", key);
+        }
+
+        final List<SpriteCell> result = doComputeSpriteCutting(id, frameImage8bpp, wf, hf, optType, optLevel);
+
+        // store in cache
+        final int[] values = new int[result.size() * 5];
+        int ind = 0;
+        for (SpriteCell sprite : result)
+        {
+            values[ind++] = sprite.x;
+            values[ind++] = sprite.y;
+            values[ind++] = sprite.width;
+            values[ind++] = sprite.height;
+            values[ind++] = sprite.opt.ordinal();
+        }
+        ResourceCache.put("sprite", key, ArrayUtil.intToByte(values));
+
+        return result;
+    }
+
+    /**
+     * Returns sprite cutting from a cache entry (<code>null</code> if entry is not valid)
+     */
+    private static List<SpriteCell> getCachedSpriteCutting(byte[] entry)
+    {
+        // 5 int values per sprite (empty frame gives an empty entry)
+        if ((entry.length % (5 * 4)) != 0)
+            return null;
+
+        final int[] values = ArrayUtil.byteToInt(entry);
+        final List<SpriteCell> result = new ArrayList<>();
+
+        for (int i = 0; i < values.length; i += 5)
+        {
+            final int opt = values[i + 4];
+
+            if ((opt < 0) || (opt >= OptimizationType.values().length))
+                return null;
+
+            result.add(new SpriteCell(values[i + 0], values[i + 1], values[i + 2], values[i + 3], OptimizationType.values()[opt]));
+        }
+
+        return result;
+    }
+
+    private static List<SpriteCell> doComputeSpriteCutting(String id, byte[] frameImage8bpp, int wf, int hf, OptimizationType optType, OptimizationLevel optLevel)
+            throws UnsupportedOperationException
     {
         List<SpriteCell> sprites;
         final Dimension frameDim = new Dimension(wf * 8, hf * 8);
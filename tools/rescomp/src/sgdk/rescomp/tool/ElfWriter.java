@@ -0,0 +1,624 @@
+package sgdk.rescomp.tool;
+
+import java.io.ByteArrayOutputStream;
+import java.io.DataOutputStream;
+import java.io.IOException;
+import java.nio.charset.StandardCharsets;
+import java.util.ArrayList;
+import java.util.LinkedHashMap;
+import java.util.List;
+import java.util.Map;
+
+/**
+ * Direct m68k ELF relocatable object writer.<br>
+ * It assembles the (small) subset of GAS syntax generated by the resource exporters (sections, alignment, labels,
+ * <code>dc.x</code> data, <code>.asciz</code> and size symbols) so we don't need to call the assembler anymore.<br>
+ * Binary data blocks are not converted to text at all when ELF output is enabled: {@link Util#outS(StringBuilder, byte[], int)}
+ * only emits a reference to the raw data block (see {@link #addBinaryBlock(byte[])}).
+ */
+public class ElfWriter
+{
+    // ELF constants
+    final static int EM_68K = 4;
+    final static int ET_REL = 1;
+    final static int EF_M68K_M68000 = 0x01000000;
+    final static int SHT_PROGBITS = 1;
+    final static int SHT_SYMTAB = 2;
+    final static int SHT_STRTAB = 3;
+    final static int SHT_RELA = 4;
+    final static int SHF_ALLOC = 0x2;
+    final static int SHF_INFO_LINK = 0x40;
+    final static int SHN_UNDEF = 0;
+    final static int SHN_ABS = 0xFFF1;
+    final static int STB_LOCAL = 0;
+    final static int STB_GLOBAL = 1;
+    final static int STT_NOTYPE = 0;
+    final static int STT_SECTION = 3;
+    final static int R_68K_32 = 1;
+
+    final static String BINARY_BLOCK_DIRECTIVE = ".binblock";
+
+    // binary data blocks (null when ELF output is disabled)
+    private static List<byte[]> binaryBlocks = null;
+
+    static class Section
+    {
+        final String name;
+        final ByteArrayOutputStream data;
+        final List<Relocation> relocations;
+        int align;
+        // section header index
+        int index;
+        // section symbol index
+        int symIndex;
+
+        Section(String name)
+        {
+            super();
+
+            this.name = name;
+            data = new ByteArrayOutputStream();
+            relocations = new ArrayList<>();
+            align = 2;
+        }
+    }
+
+    static class Symbol
+    {
+        final String name;
+        // null for undefined or absolute symbol
+        Section section;
+        int value;
+        boolean absolute;
+        boolean defined;
+        boolean global;
+        // symbol table index
+        int index;
+
+        Symbol(String name)
+        {
+            super();
+
+            this.name = name;
+            section = null;
+            value = 0;
+            absolute = false;
+            defined = false;
+            global = false;
+        }
+    }
+
+    static class Relocation
+    {
+        final int offset;
+        final Symbol symbol;
+        final int addend;
+
+        Relocation(int offset, Symbol symbol, int addend)
+        {
+            super();
+
+            this.offset = offset;
+            this.symbol = symbol;
+            this.addend = addend;
+        }
+    }
+
+    final Map<String, Section> sections;
+    final Map<String, Symbol> symbols;
+    Section current;
+    int lineNum;
+
+    ElfWriter()
+    {
+        super();
+
+        sections = new LinkedHashMap<>();
+        symbols = new LinkedHashMap<>();
+        current = null;
+        lineNum = 0;
+    }
+
+    /**
+     * Enable ELF output (raw binary data blocks are recorded from now)
+     */
+    public static void begin()
+    {
+        binaryBlocks = new ArrayList<>();
+    }
+
+    /**
+     * Disable ELF output and release binary data blocks
+     */
+    public static void end()
+    {
+        binaryBlocks = null;
+    }
+
+    public static boolean isEnabled()
+    {
+        return binaryBlocks != null;
+    }
+
+    /**
+     * Register a raw binary data block and returns the assembly line referencing it.
+     */
+    public static String addBinaryBlock(byte[] data)
+    {
+        binaryBlocks.add(data);
+        return "    " + BINARY_BLOCK_DIRECTIVE + " " + (binaryBlocks.size() - 1) + "\n";
+    }
+
+    /**
+     * Assemble the given rescomp assembly text and returns the ELF relocatable object data.
+     *
+     * @throws IllegalArgumentException
+     *         if the assembly text contains an unsupported construction
+     */
+    public static byte[] assemble(String asm) throws IOException, IllegalArgumentException
+    {
+        final ElfWriter writer = new ElfWriter();
+
+        for (String line : asm.split("\n"))
+        {
+            writer.lineNum++;
+            writer.parseLine(line);
+        }
+
+        return writer.build();
+    }
+
+    private IllegalArgumentException error(String message)
+    {
+        return new IllegalArgumentException("ELF output - line " + lineNum + ": " + message);
+    }
+
+    private Symbol getSymbol(String name)
+    {
+        Symbol result = symbols.get(name);
+
+        if (result == null)
+        {
+            result = new Symbol(name);
+            symbols.put(name, result);
+        }
+
+        return result;
+    }
+
+    private Section getCurrentSection()
+    {
+        // default section
+        if (current == null)
+            setSection(".text");
+
+        return current;
+    }
+
+    private void setSection(String name)
+    {
+        current = sections.get(name);
+
+        if (current == null)
+        {
+            current = new Section(name);
+            sections.put(name, current);
+        }
+    }
+
+    private static String removeComment(String line)
+    {
+        boolean quoted = false;
+
+        for (int i = 0; i < line.length() - 1; i++)
+        {
+            final char c = line.charAt(i);
+
+            if (c == '"')
+                quoted = !quoted;
+            else if (quoted && (c == '\\'))
+                i++;
+            else if (!quoted && (c == '/') && (line.charAt(i + 1) == '/'))
+                return line.substring(0, i);
+        }
+
+        return line;
+    }
+
+    private void parseLine(String l) throws IOException
+    {
+        final String line = removeComment(l).trim();
+
+        if (line.isEmpty())
+            return;
+
+        // symbol definition (label)
+        if (line.endsWith(":") && (line.indexOf(' ') == -1))
+        {
+            defineLabel(line.substring(0, line.length() - 1));
+            return;
+        }
+
+        // symbol assignment (only "name = .-label" form is supported)
+        final int equalInd = line.indexOf('=');
+        if ((equalInd != -1) && !line.startsWith(".asciz"))
+        {
+            final String name = line.substring(0, equalInd).trim();
+            final String expr = line.substring(equalInd + 1).replace(" ", "");
+
+            if (!expr.startsWith(".-"))
+                throw error("unsupported expression '" + expr + "'");
+
+            final Symbol ref = symbols.get(expr.substring(2));
+            if ((ref == null) || !ref.defined || (ref.section != getCurrentSection()))
+                throw error("'" + expr.substring(2) + "' should be defined in current section");
+
+            final Symbol symbol = getSymbol(name);
+            symbol.absolute = true;
+            symbol.defined = true;
+            symbol.value = current.data.size() - ref.value;
+            return;
+        }
+
+        final String[] parts = line.split("\\s+", 2);
+        final String directive = parts[0];
+        final String args = (parts.length > 1) ? parts[1].trim() : "";
+
+        switch (directive)
+        {
+            case ".section":
+                setSection(args.split("[\\s,]+")[0]);
+                break;
+
+            case ".align":
+                align(Integer.decode(args).intValue());
+                break;
+
+            case ".global":
+            case ".globl":
+                getSymbol(args).global = true;
+                break;
+
+            case ".asciz":
+                writeString(args);
+                break;
+
+            case "dc.b":
+                writeValues(args, 1);
+                break;
+
+            case "dc.w":
+                writeValues(args, 2);
+                break;
+
+            case "dc.l":
+                writeValues(args, 4);
+                break;
+
+            case BINARY_BLOCK_DIRECTIVE:
+                getCurrentSection().data.write(binaryBlocks.get(Integer.parseInt(args)));
+                break;
+
+            default:
+                throw error("unsupported directive '" + directive + "'");
+        }
+    }
+
+    private void defineLabel(String name)
+    {
+        final Symbol symbol = getSymbol(name);
+
+        if (symbol.defined)
+            throw error("symbol '" + name + "' is already defined");
+
+        symbol.section = getCurrentSection();
+        symbol.value = current.data.size();
+        symbol.defined = true;
+    }
+
+    private void align(int align)
+    {
+        final Section section = getCurrentSection();
+
+        if (align > section.align)
+            section.align = align;
+
+        while ((section.data.size() % align) != 0)
+            section.data.write(0);
+    }
+
+    private void writeString(String args)
+    {
+        if ((args.length() < 2) || !args.startsWith("\"") || !args.endsWith("\""))
+            throw error("invalid string " + args);
+
+        final String str = args.substring(1, args.length() - 1);
+        final ByteArrayOutputStream data = getCurrentSection().data;
+
+        for (int i = 0; i < str.length(); i++)
+        {
+            char c = str.charAt(i);
+
+            if ((c == '\\') && ((i + 1) < str.length()))
+            {
+                c = str.charAt(++i);
+
+                switch (c)
+                {
+                    case 'n':
+                        c = '\n';
+                        break;
+                    case 't':
+                        c = '\t';
+                        break;
+                    case 'r':
+                        c = '\r';
+                        break;
+                    case '0':
+                        c = 0;
+                        break;
+                    default:
+                        break;
+                }
+            }
+
+            data.write(c);
+        }
+
+        // null terminated
+        data.write(0);
+    }
+
+    private void writeValues(String args, int size)
+    {
+        final ByteArrayOutputStream data = getCurrentSection().data;
+
+        for (String v : args.split(","))
+        {
+            final String value = v.trim();
+            long numValue;
+
+            try
+            {
+                numValue = Long.decode(value).longValue();
+            }
+            catch (NumberFormatException e)
+            {
+                // symbol reference (optionally with an offset)
+                if (size != 4)
+                    throw error("symbol reference '" + value + "' requires 32 bit data");
+
+                int sepInd = Math.max(value.lastIndexOf('+'), value.lastIndexOf('-'));
+                String name = value;
+                int addend = 0;
+
+                if (sepInd > 0)
+                {
+                    name = value.substring(0, sepInd).trim();
+                    addend = Integer.decode(value.substring(sepInd + 1).trim()).intValue();
+                    if (value.charAt(sepInd) == '-')
+                        addend = -addend;
+                }
+
+                current.relocations.add(new Relocation(data.size(), getSymbol(name), addend));
+                numValue = 0;
+            }
+
+            for (int i = size - 1; i >= 0; i--)
+                data.write((int) (numValue >> (i * 8)) & 0xFF);
+        }
+    }
+
+    private static int addString(ByteArrayOutputStream strtab, String str) throws IOException
+    {
+        final int result = strtab.size();
+
+        strtab.write(str.getBytes(StandardCharsets.UTF_8));
+        strtab.write(0);
+
+        return result;
+    }
+
+    private static void pad(ByteArrayOutputStream out, int align)
+    {
+        while ((out.size() % align) != 0)
+            out.write(0);
+    }
+
+    private static void writeSectionHeader(DataOutputStream out, int name, int type, int flags, int offset, int size, int link, int info,
+            int align, int entSize) throws IOException
+    {
+        out.writeInt(name);
+        out.writeInt(type);
+        out.writeInt(flags);
+        // address
+        out.writeInt(0);
+        out.writeInt(offset);
+        out.writeInt(size);
+        out.writeInt(link);
+        out.writeInt(info);
+        out.writeInt(align);
+        out.writeInt(entSize);
+    }
+
+    private byte[] build() throws IOException
+    {
+        final List<Section> sectionList = new ArrayList<>(sections.values());
+        final List<Section> relocSections = new ArrayList<>();
+
+        // assign section indexes (0 is reserved)
+        int index = 1;
+        for (Section section : sectionList)
+            section.index = index++;
+        for (Section section : sectionList)
+            if (!section.relocations.isEmpty())
+                relocSections.add(section);
+
+        final int relaBaseIndex = index;
+        final int symtabIndex = relaBaseIndex + relocSections.size();
+        final int strtabIndex = symtabIndex + 1;
+        final int shstrtabIndex = strtabIndex + 1;
+        final int numSection = shstrtabIndex + 1;
+
+        // build symbol table: null symbol, section symbols, local symbols then global symbols
+        final List<Symbol> localSymbols = new ArrayList<>();
+        final List<Symbol> globalSymbols = new ArrayList<>();
+
+        for (Symbol symbol : symbols.values())
+        {
+            // undefined symbols are always global (external reference)
+            if (symbol.global || !symbol.defined)
+                globalSymbols.add(symbol);
+            else
+                localSymbols.add(symbol);
+        }
+
+        int symIndex = 1;
+        for (Section section : sectionList)
+            section.symIndex = symIndex++;
+        for (Symbol symbol : localSymbols)
+            symbol.index = symIndex++;
+        final int firstGlobal = symIndex;
+        for (Symbol symbol : globalSymbols)
+            symbol.index = symIndex++;
+
+        final ByteArrayOutputStream strtab = new ByteArrayOutputStream();
+        final ByteArrayOutputStream symtab = new ByteArrayOutputStream();
+        final DataOutputStream symOut = new DataOutputStream(symtab);
+
+        strtab.write(0);
+
+        // null symbol
+        symOut.write(new byte[16]);
+        // section symbols
+        for (Section section : sectionList)
+        {
+            symOut.writeInt(0);
+            symOut.writeInt(0);
+            symOut.writeInt(0);
+            symOut.writeByte((STB_LOCAL << 4) | STT_SECTION);
+            symOut.writeByte(0);
+            symOut.writeShort(section.index);
+        }
+        // local and global symbols
+        final List<Symbol> allSymbols = new ArrayList<>(localSymbols);
+        allSymbols.addAll(globalSymbols);
+        for (Symbol symbol : allSymbols)
+        {
+            final int shndx;
+
+            if (!symbol.defined)
+                shndx = SHN_UNDEF;
+            else if (symbol.absolute)
+                shndx = SHN_ABS;
+            else
+                shndx = symbol.section.index;
+
+            symOut.writeInt(addString(strtab, symbol.name));
+            symOut.writeInt(symbol.value);
+            symOut.writeInt(0);
+            symOut.writeByte(((symbol.global || !symbol.defined) ? (STB_GLOBAL << 4) : (STB_LOCAL << 4)) | STT_NOTYPE);
+            symOut.writeByte(0);
+            symOut.writeShort(shndx);
+        }
+
+        // section header string table
+        final ByteArrayOutputStream shstrtab = new ByteArrayOutputStream();
+        shstrtab.write(0);
+        final int[] sectionNames = new int[sectionList.size()];
+        final int[] relaNames = new int[relocSections.size()];
+        for (int i = 0; i < sectionList.size(); i++)
+            sectionNames[i] = addString(shstrtab, sectionList.get(i).name);
+        for (int i = 0; i < relocSections.size(); i++)
+            relaNames[i] = addString(shstrtab, ".rela" + relocSections.get(i).name);
+        final int symtabName = addString(shstrtab, ".symtab");
+        final int strtabName = addString(shstrtab, ".strtab");
+        final int shstrtabName = addString(shstrtab, ".shstrtab");
+
+        // build file body (everything after ELF header)
+        final ByteArrayOutputStream body = new ByteArrayOutputStream();
+        final int headerSize = 52;
+        final int[] sectionOffsets = new int[sectionList.size()];
+        final int[] relaOffsets = new int[relocSections.size()];
+
+        for (int i = 0; i < sectionList.size(); i++)
+        {
+            final Section section = sectionList.get(i);
+
+            pad(body, section.align);
+            sectionOffsets[i] = headerSize + body.size();
+            section.data.writeTo(body);
+        }
+        for (int i = 0; i < relocSections.size(); i++)
+        {
+            final Section section = relocSections.get(i);
+            final DataOutputStream relOut = new DataOutputStream(body);
+
+            pad(body, 4);
+            relaOffsets[i] = headerSize + body.size();
+
+            for (Relocation reloc : section.relocations)
+            {
+                relOut.writeInt(reloc.offset);
+                relOut.writeInt((reloc.symbol.index << 8) | R_68K_32);
+                relOut.writeInt(reloc.addend);
+            }
+        }
+
+        pad(body, 4);
+        final int symtabOffset = headerSize + body.size();
+        symtab.writeTo(body);
+        final int strtabOffset = headerSize + body.size();
+        strtab.writeTo(body);
+        final int shstrtabOffset = headerSize + body.size();
+        shstrtab.writeTo(body);
+        pad(body, 4);
+        final int shOffset = headerSize + body.size();
+
+        final ByteArrayOutputStream result = new ByteArrayOutputStream();
+        final DataOutputStream out = new DataOutputStream(result);
+
+        // ELF header (32 bit, big endian, current version)
+        out.write(new byte[] {0x7F, 'E', 'L', 'F', 1, 2, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0});
+        out.writeShort(ET_REL);
+        out.writeShort(EM_68K);
+        // version
+        out.writeInt(1);
+        // entry, program header offset
+        out.writeInt(0);
+        out.writeInt(0);
+        out.writeInt(shOffset);
+        out.writeInt(EF_M68K_M68000);
+        // header size, program header entry size and number
+        out.writeShort(headerSize);
+        out.writeShort(0);
+        out.writeShort(0);
+        // section header entry size, number and string table index
+        out.writeShort(40);
+        out.writeShort(numSection);
+        out.writeShort(shstrtabIndex);
+
+        body.writeTo(result);
+
+        // section headers
+        writeSectionHeader(out, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+        for (int i = 0; i < sectionList.size(); i++)
+        {
+            final Section section = sectionList.get(i);
+            writeSectionHeader(out, sectionNames[i], SHT_PROGBITS, SHF_ALLOC, sectionOffsets[i], section.data.size(), 0, 0, section.align, 0);
+        }
+        for (int i = 0; i < relocSections.size(); i++)
+        {
+            final Section section = relocSections.get(i);
+            writeSectionHeader(out, relaNames[i], SHT_RELA, SHF_INFO_LINK, relaOffsets[i], section.relocations.size() * 12, symtabIndex,
+                    section.index, 4, 12);
+        }
+        writeSectionHeader(out, symtabName, SHT_SYMTAB, 0, symtabOffset, symtab.size(), strtabIndex, firstGlobal, 4, 16);
+        writeSectionHeader(out, strtabName, SHT_STRTAB, 0, strtabOffset, strtab.size(), 0, 0, 1, 0);
+        writeSectionHeader(out, shstrtabName, SHT_STRTAB, 0, shstrtabOffset, shstrtab.size(), 0, 0, 1, 0);
+
+        out.flush();
+
+        return result.toByteArray();
+    }
+}
@@ -0,0 +1,89 @@
+package sgdk.rescomp.tool;
+
+import java.util.ArrayList;
+import java.util.List;
+import java.util.Random;
+
+import sgdk.rescomp.resource.Map;
+import sgdk.rescomp.resource.Tileset;
+import sgdk.rescomp.type.Basics.Compression;
+import sgdk.rescomp.type.Basics.TileOptimization;
+import sgdk.rescomp.type.Basics.TileOrdering;
+
+/**
+ * MAP resource build benchmark: builds a synthetic 4096x4096 pixels map and reports build time.<br>
+ * Usage: java -cp rescomp.jar sgdk.rescomp.tool.MapBenchmark [size_in_pixel] [num_run]
+ */
+public class MapBenchmark
+{
+    // number of unique tiles / metatiles used to build the map
+    final static int NUM_TILE = 1024;
+    final static int NUM_METATILE = 8192;
+
+    static byte[] buildImage(int size, Random random)
+    {
+        final int sizeTile = size / 8;
+        final byte[] result = new byte[size * size];
+        final byte[][] tiles = new byte[NUM_TILE][64];
+        final int[][] metatiles = new int[NUM_METATILE][4];
+
+        // random tiles (palette 0, low priority)
+        for (byte[] tile : tiles)
+            for (int i = 0; i < tile.length; i++)
+                tile[i] = (byte) random.nextInt(16);
+        // random metatiles
+        for (int[] metatile : metatiles)
+            for (int i = 0; i < metatile.length; i++)
+                metatile[i] = random.nextInt(NUM_TILE);
+
+        for (int mj = 0; mj < (sizeTile / 2); mj++)
+        {
+            for (int mi = 0; mi < (sizeTile / 2); mi++)
+            {
+                final int[] metatile = metatiles[random.nextInt(NUM_METATILE)];
+
+                for (int t = 0; t < 4; t++)
+                {
+                    final byte[] tile = tiles[metatile[t]];
+                    final int tx = ((mi * 2) + (t & 1)) * 8;
+                    final int ty = ((mj * 2) + (t >> 1)) * 8;
+
+                    for (int y = 0; y < 8; y++)
+                        System.arraycopy(tile, y * 8, result, ((ty + y) * size) + tx, 8);
+                }
+            }
+        }
+
+        return result;
+    }
+
+    public static void main(String[] args)
+    {
+        final int size = (args.length > 0) ? Integer.parseInt(args[0]) : 4096;
+        final int numRun = (args.length > 1) ? Integer.parseInt(args[1]) : 3;
+
+        final byte[] image = buildImage(size, new Random(0));
+
+        System.out.println("MAP benchmark - " + size + "x" + size + " pixels map");
+
+        for (int run = 0; run < numRun; run++)
+        {
+            long time = System.currentTimeMillis();
+
+            final Tileset tileset = new Tileset("bench_tileset", image, size, size, 0, 0, size / 8, size / 8, TileOptimization.ALL, Compression.NONE,
+                    true, true, TileOrdering.ROW);
+            final List<Tileset> tilesets = new ArrayList<>();
+            tilesets.add(tileset);
+
+            final long tilesetTime = System.currentTimeMillis() - time;
+            time = System.currentTimeMillis();
+
+            final Map map = new Map("bench_map", image, size, size, 0, 2, tilesets, Compression.NONE, false);
+
+            final long mapTime = System.currentTimeMillis() - time;
+
+            System.out.println("Run #" + run + ": tileset = " + tilesetTime + " ms (" + tileset.getNumTile() + " tiles) - map = " + mapTime + " ms ("
+                    + map.metatiles.size() + " metatiles, " + map.mapBlocks.size() + " blocks)");
+        }
+    }
+}
@@ -0,0 +1,185 @@
+package sgdk.rescomp.tool;
+
+import java.io.File;
+import java.io.IOException;
+import java.nio.charset.StandardCharsets;
+import java.nio.file.Files;
+import java.nio.file.StandardCopyOption;
+import java.security.MessageDigest;
+import java.security.NoSuchAlgorithmException;
+import java.util.concurrent.atomic.AtomicInteger;
+
+import sgdk.tool.ArrayUtil;
+
+/**
+ * Persistent content-addressed cache for expensive resource processing results (sprite cutting, data packing...).<br>
+ * Each entry is stored in its own file and identified by a hash of all the inputs used to compute it, so an entry
+ * never needs to be invalidated: when inputs change a new key is simply computed.
+ */
+public class ResourceCache
+{
+    // increase it when cached data format or processing algorithms change
+    private final static int VERSION = 1;
+
+    private static File cacheDir = null;
+
+    private final static AtomicInteger hit = new AtomicInteger();
+    private final static AtomicInteger miss = new AtomicInteger();
+
+    /**
+     * Set cache directory (<code>null</code> to disable cache)
+     */
+    public static void setDirectory(String dir)
+    {
+        if (dir == null)
+            cacheDir = null;
+        else
+            cacheDir = new File(dir);
+
+        hit.set(0);
+        miss.set(0);
+    }
+
+    public static boolean isEnabled()
+    {
+        return cacheDir != null;
+    }
+
+    /**
+     * Compute the entry key from the given category and inputs.<br>
+     * Accepted input types are <code>byte[]</code>, <code>null</code> and any object with a stable
+     * <code>toString()</code> implementation (String, Number, Boolean, Enum...).
+     */
+    public static String getKey(String category, Object... inputs)
+    {
+        final MessageDigest digest;
+
+        try
+        {
+            digest = MessageDigest.getInstance("SHA-256");
+        }
+        catch (NoSuchAlgorithmException e)
+        {
+            // should never happen (SHA-256 is always available)
+            throw new RuntimeException(e);
+        }
+
+        digest.update((category + ":" + VERSION).getBytes(StandardCharsets.UTF_8));
+
+        for (Object input : inputs)
+        {
+            final byte[] data;
+
+            if (input instanceof byte[])
+                data = (byte[]) input;
+            else if (input == null)
+                data = new byte[0];
+            else
+                data = input.toString().getBytes(StandardCharsets.UTF_8);
+
+            // prefix with length so different inputs split can't give the same key
+            digest.update(ArrayUtil.intToByte(new int[] {data.length}));
+            digest.update(data);
+        }
+
+        final StringBuilder result = new StringBuilder(64);
+        for (byte b : digest.digest())
+            result.append(String.format("%02x", Integer.valueOf(b & 0xFF)));
+
+        return result.toString();
+    }
+
+    private static File getFile(String category, String key)
+    {
+        return new File(new File(cacheDir, category), key + ".bin");
+    }
+
+    /**
+     * Returns cached data for the given entry (<code>null</code> if cache is disabled or entry doesn't exist)
+     */
+    public static byte[] get(String category, String key)
+    {
+        if (cacheDir == null)
+            return null;
+
+        final File file = getFile(category, key);
+
+        if (file.exists())
+        {
+            try
+            {
+                final byte[] result = Files.readAllBytes(file.toPath());
+
+                hit.incrementAndGet();
+                return result;
+            }
+            catch (IOException e)
+            {
+                // corrupted entry ? --> just consider it as missing
+            }
+        }
+
+        miss.incrementAndGet();
+        return null;
+    }
+
+    /**
+     * Store data for the given entry (does nothing if cache is disabled)
+     */
+    public static void put(String category, String key, byte[] data)
+    {
+        if (cacheDir == null)
+            return;
+
+        final File file = getFile(category, key);
+
+        try
+        {
+            file.getParentFile().mkdirs();
+
+            // write in a temporary file first then rename it so a concurrent reader never see a partial entry
+            final File tmpFile = File.createTempFile(key, ".tmp", file.getParentFile());
+            Files.write(tmpFile.toPath(), data);
+            Files.move(tmpFile.toPath(), file.toPath(), StandardCopyOption.REPLACE_EXISTING, StandardCopyOption.ATOMIC_MOVE);
+        }
+        catch (IOException e)
+        {
+            // cache is only an optimization, we can ignore the error
+            System.err.println("Warning: cannot write cache entry '" + file.getPath() + "': " + e.getMessage());
+        }
+    }
+
+    /**
+     * Remove an invalid entry returned by {@link #get(String, String)} (unknown format, truncated...) so it is
+     * recomputed and stored again. The entry is then counted as a miss.
+     */
+    public static void invalidate(String category, String key)
+    {
+        if (cacheDir == null)
+            return;
+
+        final File file = getFile(category, key);
+
+        try
+        {
+            Files.deleteIfExists(file.toPath());
+        }
+        catch (IOException e)
+        {
+            // entry will be replaced by next put(..) anyway
+        }
+
+        hit.decrementAndGet();
+        miss.incrementAndGet();
+    }
+
+    public static int getHit()
+    {
+        return hit.get();
+    }
+
+    public static int getMiss()
+    {
+        return miss.get();
+    }
+}
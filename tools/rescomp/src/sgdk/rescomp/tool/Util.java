@@ -2,7 +2,12 @@ package sgdk.rescomp.tool;
 
 import java.awt.Color;
 import java.io.ByteArrayOutputStream;
+import java.io.File;
 import java.io.IOException;
+import java.lang.reflect.InvocationTargetException;
+import java.lang.reflect.Method;
+import java.net.URL;
+import java.net.URLClassLoader;
 import java.util.ArrayList;
 import java.util.Arrays;
 import java.util.List;
@@ -279,6 +284,23 @@ public class Util
 
     public static void outS(StringBuilder out, byte[] data, int intSize)
     {
+        // direct ELF output ? --> only reference raw data (avoid the costly text conversion)
+        if (ElfWriter.isEnabled())
+        {
+            // keep complete integers only
+            final int len = (data.length / intSize) * intSize;
+            // better to pad data to word
+            final byte[] raw = new byte[((intSize == 1) && ((len & 1) != 0)) ? len + 1 : len];
+
+            // integers are stored in little endian in source data (same as text output)
+            for (int i = 0; i < len; i += intSize)
+                for (int j = 0; j < intSize; j++)
+                    raw[i + j] = data[i + (intSize - (j + 1))];
+
+            out.append(ElfWriter.addBinaryBlock(raw));
+            return;
+        }
+
         int offset = 0;
         int remain = data.length;
 
@@ -462,12 +484,86 @@ public class Util
         return Math.round((compressedSize * 100f) / uncompressedSize) <= maxPourcentage;
     }
 
+    // maximum amount of previous data (in byte) which can be referenced by LZ4W compression
+    final static int LZ4W_PREV_WINDOW = 0x8004;
+
     public static PackedData pack(byte[] data, Compression compression, ByteArrayOutputStream bin, boolean forceSelectedCompression)
     {
         // nothing to do
         if (compression == Compression.NONE)
             return new PackedData(data, Compression.NONE);
+        // cache disabled ? --> directly pack
+        if (!ResourceCache.isEnabled())
+            return doPack(data, compression, bin, forceSelectedCompression);
+
+        byte[] prevWindow = null;
+
+        // LZ4W can use previous data block so it's part of the key (only the part which can be referenced)
+        if ((bin != null) && ((compression == Compression.AUTO) || (compression == Compression.LZ4W)))
+        {
+            final byte[] prev = bin.toByteArray();
+            int keep = Math.min(prev.length, LZ4W_PREV_WINDOW);
+            // preserve word alignment of previous data
+            if (((prev.length - keep) & 1) != 0)
+                keep++;
+
+            prevWindow = Arrays.copyOfRange(prev, prev.length - keep, prev.length);
+        }
+
+        final String key = ResourceCache.getKey("pack", data, compression, Boolean.valueOf(forceSelectedCompression), prevWindow);
+        final byte[] cached = ResourceCache.get("pack", key);
+
+        // cache hit ? (first byte = compression, followed by packed data)
+        if (cached != null)
+        {
+            final Compression comp = getCachedCompression(cached);
+
+            if (comp == Compression.NONE)
+                return new PackedData(data, Compression.NONE);
+            if (comp != null)
+                return new PackedData(Arrays.copyOfRange(cached, 1, cached.length), comp);
+
+            // invalid entry --> remove it and pack again
+            ResourceCache.invalidate("pack", key);
+        }
+
+        final PackedData result = doPack(data, compression, bin, forceSelectedCompression);
+
+        // store in cache
+        final byte[] entry = new byte[(result.compression == Compression.NONE) ? 1 : result.data.length + 1];
+        entry[0] = (byte) result.compression.ordinal();
+        if (result.compression != Compression.NONE)
+            System.arraycopy(result.data, 0, entry, 1, result.data.length);
+        ResourceCache.put("pack", key, entry);
+
+        return result;
+    }
+
+    /**
+     * Returns compression method of a packed data cache entry (<code>null</code> if entry is not valid)
+     */
+    private static Compression getCachedCompression(byte[] entry)
+    {
+        if (entry.length == 0)
+            return null;
+
+        final int ordinal = entry[0];
+
+        // AUTO is never stored
+        if ((ordinal <= Compression.AUTO.ordinal()) || (ordinal >= Compression.values().length))
+            return null;
+
+        final Compression result = Compression.values()[ordinal];
+
+        // NONE has no data while others always have some
+        if ((result == Compression.NONE) != (entry.length == 1))
+            return null;
+
+        return result;
+    }
 
+    private static PackedData doPack(byte[] data, Compression compression, ByteArrayOutputStream bin, boolean forceSelectedCompression)
+    {
         // we need to have a proper defined compression
         if (forceSelectedCompression && (compression == Compression.AUTO))
             throw new IllegalArgumentException("Cannot use AUTO compression !");
@@ -729,6 +825,110 @@ public class Util
         return FileUtil.exists(fout);
     }
 
+    // xgm2tool in-process conversion method (null if not available)
+    private static Method xgm2toolConvert = null;
+    private static boolean xgm2toolLookupDone = false;
+
+    /**
+     * Returns xgm2tool in-process conversion method if xgm2tool is available on classpath or next to rescomp
+     * (xgm2tool.jar), <code>null</code> otherwise.
+     */
+    private static synchronized Method getXgm2toolConvert()
+    {
+        if (!xgm2toolLookupDone)
+        {
+            xgm2toolLookupDone = true;
+
+            try
+            {
+                Class<?> launcher;
+
+                try
+                {
+                    // already on classpath ?
+                    launcher = Class.forName("sgdk.xgm2tool.Launcher");
+                }
+                catch (ClassNotFoundException e)
+                {
+                    final File jar = new File(FileUtil.adjustPath(sgdk.rescomp.Compiler.currentDir, "xgm2tool.jar"));
+
+                    if (!jar.exists())
+                        return null;
+
+                    // load it from xgm2tool.jar (class loader is kept for next calls)
+                    launcher = Class.forName("sgdk.xgm2tool.Launcher", true,
+                            new URLClassLoader(new URL[] {jar.toURI().toURL()}, Util.class.getClassLoader()));
+                }
+
+                xgm2toolConvert = launcher.getMethod("convert", List.class, boolean.class, List.class);
+            }
+            catch (Throwable t)
+            {
+                // old xgm2tool version or incompatible jar --> use external process
+                xgm2toolConvert = null;
+                System.out.println("Info: xgm2tool.jar doesn't provide in memory conversion, using external process (rebuild xgm2tool.jar to enable it)");
+            }
+        }
+
+        return xgm2toolConvert;
+    }
+
+    /**
+     * Convert VGM file(s) to XGC (packed XGM2) data using xgm2tool.<br>
+     * Conversion is done in memory when xgm2tool classes can be loaded, otherwise we fall back on launching
+     * xgm2tool.jar in a new process (using a temporary output file).
+     *
+     * @return converted XGC data or <code>null</code> if conversion failed
+     */
+    public static byte[] xgm2tool(List<String> fins, String options) throws IOException
+    {
+        final Method convert = getXgm2toolConvert();
+
+        if (convert != null)
+        {
+            final List<String> opts = new ArrayList<>();
+
+            if (!StringUtil.isEmpty(options))
+                for (String opt : options.trim().split("\\s+"))
+                    opts.add(opt);
+            opts.add("-s");
+
+            try
+            {
+                return (byte[]) convert.invoke(null, fins, Boolean.TRUE, opts);
+            }
+            catch (InvocationTargetException e)
+            {
+                final Throwable cause = e.getCause();
+
+                if (cause instanceof IOException)
+                    throw (IOException) cause;
+
+                System.err.println("xgm2tool error: " + cause);
+                return null;
+            }
+            catch (IllegalAccessException e)
+            {
+                // should not happen (public method) --> use external process
+            }
+        }
+
+        // use a unique temporary file so concurrent builds don't overwrite each other
+        final File tmp = File.createTempFile("xgm2tool", ".xgc");
+
+        try
+        {
+            if (!xgm2tool(fins, tmp.getAbsolutePath(), options))
+                return null;
+
+            return in(tmp.getAbsolutePath());
+        }
+        finally
+        {
+            FileUtil.delete(tmp.getAbsolutePath(), false);
+        }
+    }
+
     public static boolean xgm2tool(List<String> fins, String fout, String options)
     {
         // better to remove output file
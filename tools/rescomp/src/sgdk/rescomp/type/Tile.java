@@ -286,6 +286,43 @@ public class Tile implements Comparable<Tile>
         return new Tile(data, size, pal, prio != 0, plain ? plainCol : -1);
     }
 
+    /**
+     * Flip invariant tile key: built from the smallest (lexicographic order) of the 4 H/V flipped versions of the tile
+     * data so a tile and all its flipped versions share the same key.
+     */
+    public static class FlipKey
+    {
+        final int[] data;
+        final int hc;
+
+        FlipKey(int[] data)
+        {
+            super();
+
+            this.data = data;
+            hc = Arrays.hashCode(data);
+        }
+
+        @Override
+        public int hashCode()
+        {
+            return hc;
+        }
+
+        @Override
+        public boolean equals(Object obj)
+        {
+            if (obj instanceof FlipKey)
+            {
+                final FlipKey key = (FlipKey) obj;
+
+                return (hc == key.hc) && Arrays.equals(data, key.data);
+            }
+
+            return super.equals(obj);
+        }
+    }
+
     public final int[] data;
     public final int size;
     public final int pal;
@@ -298,6 +335,7 @@ public class Tile implements Comparable<Tile>
     final int[] hvFlip;
 
     final int hc;
+    final FlipKey flipKey;
 
     public Tile(int[] data, int size, int pal, boolean prio, int plain)
     {
@@ -331,6 +369,16 @@ public class Tile implements Comparable<Tile>
         hvFlip = getFlipped(true, true);
 
         hc = getHash(data) + getHash(hFlip) + getHash(vFlip) + getHash(hvFlip);
+
+        // canonical form = min of all flipped versions
+        int[] canonical = data;
+        if (compareData(hFlip, canonical) < 0)
+            canonical = hFlip;
+        if (compareData(vFlip, canonical) < 0)
+            canonical = vFlip;
+        if (compareData(hvFlip, canonical) < 0)
+            canonical = hvFlip;
+        flipKey = new FlipKey(canonical);
     }
 
     public Tile(byte[] pixel8bpp, int size, int pal, boolean prio, int plain)
@@ -338,6 +386,22 @@ public class Tile implements Comparable<Tile>
         this(ArrayUtil.byteToInt(ImageUtil.convertTo4bpp(pixel8bpp, 8)), size, pal, prio, plain);
     }
 
+    /**
+     * Lexicographic comparison of 2 tile data arrays (same as Arrays.compare(int[], int[]) which requires Java 9)
+     */
+    private static int compareData(int[] a, int[] b)
+    {
+        final int len = Math.min(a.length, b.length);
+
+        for (int i = 0; i < len; i++)
+        {
+            if (a[i] != b[i])
+                return (a[i] < b[i]) ? -1 : 1;
+        }
+
+        return a.length - b.length;
+    }
+
     public int getHash(int[] array)
     {
         int result = 0;
@@ -347,6 +411,14 @@ public class Tile implements Comparable<Tile>
         return result;
     }
 
+    /**
+     * Returns the flip invariant key of this tile (same key for all H/V flipped versions of the tile)
+     */
+    public FlipKey getFlipKey()
+    {
+        return flipKey;
+    }
+
     public boolean isBlank()
     {
         return empty;
@@ -58,7 +58,8 @@ using std::flush;
 
 #define LINEMAX 300
 #define LABMAX 70
-#define LABTABSIZE 32771
+#define LABTABSIZE 4096
+#define HASHTABINIT 256
 #define FUNTABSIZE 4497
 #define aint long
 
@@ -167,15 +167,39 @@ labtabentrycls::labtabentrycls() {
 
 labtabcls::labtabcls() {
   nextlocation=1;
+  hashsize=labtabsize=LABTABSIZE;
+  hashtable=new int[hashsize];
+  for (int i=0; i<hashsize; hashtable[i++]=0);
+  labtab=new labtabentrycls[labtabsize];
+}
+
+void labtabcls::grow() {
+  int i,tr;
+  // entries keep their index so listings stay in definition order
+  if (nextlocation>=labtabsize) {
+    labtabentrycls *nlabtab=new labtabentrycls[labtabsize*2];
+    for (i=1; i<nextlocation; ++i) nlabtab[i]=labtab[i];
+    delete[] labtab; labtab=nlabtab; labtabsize*=2;
+  }
+  if (nextlocation>=hashsize*2/3) {
+    delete[] hashtable;
+    hashsize*=2; hashtable=new int[hashsize];
+    for (i=0; i<hashsize; hashtable[i++]=0);
+    for (i=1; i<nextlocation; ++i) {
+      tr=hashnaam(labtab[i].name)&(hashsize-1);
+      while (hashtable[tr]) if (++tr>=hashsize) tr=0;
+      hashtable[tr]=i;
+    }
+  }
 }
 
 int labtabcls::insert(char *nname,aint nvalue) {
-  if (nextlocation>=LABTABSIZE*2/3) error("Label table full",0,FATAL);
+  if (nextlocation>=hashsize*2/3 || nextlocation>=labtabsize) grow();
   int tr,htr;
-  tr=hash(nname);
+  tr=hashnaam(nname)&(hashsize-1);
   while(htr=hashtable[tr]) {
     if (!strcmp((labtab[htr].name),nname)) return 0;
-    else if (++tr>=LABTABSIZE) tr=0;
+    else if (++tr>=hashsize) tr=0;
   }
   hashtable[tr]=nextlocation;
   labtab[nextlocation].name=strdup(nname); 
@@ -186,12 +210,12 @@ int labtabcls::insert(char *nname,aint nvalue) {
 
 int labtabcls::zoek(char *nname,aint &nvalue) {
   int tr,htr,otr;
-  otr=tr=hash(nname);
+  otr=tr=hashnaam(nname)&(hashsize-1);
   while(htr=hashtable[tr]) {
     if (!strcmp((labtab[htr].name),nname)) { 
       nvalue=labtab[htr].value; if (pass==2) ++labtab[htr].used; return 1; 
     }
-    if (++tr>=LABTABSIZE) tr=0;
+    if (++tr>=hashsize) tr=0;
     if (tr==otr) break;
   }
   labelnotfound=1;
@@ -199,14 +223,14 @@ int labtabcls::zoek(char *nname,aint &nvalue) {
   return 0;
 }
 
-int labtabcls::hash(char* s) {
-  char *ss=s;
-  unsigned int h=0,g;
-  for (;*ss!='\0';ss++) {
-    h=(h<<4)+ *ss;
-    if (g=h & 0xf0000000) { h^=g>>24; h^=g; }
+// FNV-1a, tables use power of 2 sizes so all bits have to be mixed
+unsigned int hashnaam(char* s) {
+  unsigned int h=2166136261u;
+  for (;*s!='\0';s++) {
+    h^=(unsigned char)*s;
+    h*=16777619u;
   }
-  return h % LABTABSIZE;
+  return h;
 }
 
 void labtabcls::dump() {
@@ -333,44 +357,35 @@ definetabentrycls::definetabentrycls(char *nnaam,char *nvervanger, definetabentr
   vervanger=new char[strlen(nvervanger)+1];
   s1=vervanger; s2=nvervanger; skipblanks(s2);
   while (*s2 && *s2!='\n' && *s2!='\r') { *s1=*s2; ++s1; ++s2; } *s1=0;
-  next=nnext;
+  next=nnext; hnext=NULL;
 }
 
 void definetabcls::init() {
-  for (int i=0; i<128; defs[i++]=0);
+  defs.init();
 }
 
 void definetabcls::add(char *naam, char *vervanger) {
   if (bestaat(naam)) error("Duplicate define",naam);
-  defs[*naam]=new definetabentrycls(naam,vervanger,defs[*naam]);
+  defs.add(new definetabentrycls(naam,vervanger,NULL));
 }
 
 char *definetabcls::getverv(char *naam) {
-  definetabentrycls *p=defs[*naam];
-  while (p) {
-    if (!strcmp(naam,p->naam)) return p->vervanger;
-    p=p->next;
-  }
-  return NULL;
+  definetabentrycls *p=defs.zoek(naam);
+  return p?p->vervanger:NULL;
 }
 
 int definetabcls::bestaat(char *naam) {
-  definetabentrycls *p=defs[*naam];
-  while (p) {
-    if (!strcmp(naam,p->naam)) return 1;
-    p=p->next;
-  }
-  return 0;
+  return defs.zoek(naam)!=NULL;
 }
 
 void macdefinetabcls::init() {
   defs=NULL;
-  for (int i=0; i<128; used[i++]=0);
+  index.init();
 }
 
 void macdefinetabcls::macroadd(char *naam, char *vervanger) {
   defs=new definetabentrycls(naam,vervanger,defs);
-  used[*naam]=1;
+  index.add(defs);
 }
 
 definetabentrycls *macdefinetabcls::getdefs() {
@@ -378,27 +393,18 @@ definetabentrycls *macdefinetabcls::getdefs() {
 }
 
 void macdefinetabcls::setdefs(definetabentrycls *ndefs) {
+  // drop arguments of the ended macro, this unhides the shadowed outer ones
+  while (defs && defs!=ndefs) { index.remove(defs); defs=defs->next; }
   defs=ndefs;
 }
 
 char *macdefinetabcls::getverv(char *naam) {
-  definetabentrycls *p=defs;
-  if (!used[*naam]) return NULL;
-  while (p) {
-    if (!strcmp(naam,p->naam)) return p->vervanger;
-    p=p->next;
-  }
-  return NULL;
+  definetabentrycls *p=index.zoek(naam);
+  return p?p->vervanger:NULL;
 }
 
 int macdefinetabcls::bestaat(char *naam) {
-  definetabentrycls *p=defs;
-  if (!used[*naam]) return 0;
-  while (p) {
-    if (!strcmp(naam,p->naam)) return 1;
-    p=p->next;
-  }
-  return 0;
+  return index.zoek(naam)!=NULL;
 }
 
 stringlst::stringlst(char*nstring,stringlst*nnext) {
@@ -407,22 +413,16 @@ stringlst::stringlst(char*nstring,stringlst*nnext) {
 }
 
 macrotabentrycls::macrotabentrycls(char *nnaam,macrotabentrycls *nnext) {
-  naam=nnaam; next=nnext; args=body=NULL;
+  naam=nnaam; next=nnext; hnext=NULL; args=body=NULL;
 }
 
 void macrotabcls::init() {
   macs=NULL;
-  for (int i=0; i<128; used[i++]=0);
+  index.init();
 }
 
 int macrotabcls::bestaat(char *naam) {
-  macrotabentrycls *p=macs;
-  if (!used[*naam]) return 0;
-  while (p) {
-    if (!strcmp(naam,p->naam)) return 1;
-    p=p->next;
-  }
-  return 0;
+  return index.zoek(naam)!=NULL;
 }
 
 void macrotabcls::add(char *nnaam,char *&p) {
@@ -430,7 +430,7 @@ void macrotabcls::add(char *nnaam,char *&p) {
   stringlst *s,*l=NULL,*f=NULL;
   if (bestaat(nnaam)) error("Duplicate macroname",0,PASS1);
   macs=new macrotabentrycls(nnaam,macs);
-  used[*nnaam]=1;
+  index.add(macs);
   skipblanks(p);
   while (*p) {
     if (!(n=getid(p))) { error("Illegal macro argument",p,PASS1); break; }
@@ -448,14 +448,9 @@ void macrotabcls::add(char *nnaam,char *&p) {
 int macrotabcls::emit(char *naam, char *&p) {
   stringlst *a,*olijstp;
   char *n,labnr[LINEMAX],ml[LINEMAX],*omacrolabp;
-  macrotabentrycls *m=macs;
+  macrotabentrycls *m=index.zoek(naam);
   definetabentrycls *odefs;
   int olistmacro,olijst;
-  if (!used[*naam]) return 0;
-  while (m) {
-    if (!strcmp(naam,m->naam)) break;
-    m=m->next;
-  }
   if (!m) return 0;
   omacrolabp=macrolabp;
   sprintf(labnr,"%d",macronummer++);
@@ -35,6 +35,60 @@ int getLocaleLabelValue(char *&op,aint &val);
 void PoolData();
 #endif
 
+unsigned int hashnaam(char*);
+
+// name indexed hash table of entries chained through their 'hnext' member,
+// grows when load reaches 3/4 (newest entry found first for duplicate names)
+template <class T> class hashtabcls {
+public:
+  hashtabcls() { size=count=0; buckets=NULL; }
+  void init() {
+    if (!buckets) { size=HASHTABINIT; buckets=new T*[size]; }
+    for (unsigned int i=0; i<size; buckets[i++]=NULL);
+    count=0;
+  }
+  T *zoek(char *naam) {
+    T *p=buckets[hashnaam(naam)&(size-1)];
+    while (p) {
+      if (!strcmp(naam,p->naam)) return p;
+      p=p->hnext;
+    }
+    return NULL;
+  }
+  void add(T *e) {
+    if (count>=size-(size>>2)) grow();
+    T **b=&buckets[hashnaam(e->naam)&(size-1)];
+    e->hnext=*b; *b=e; ++count;
+  }
+  void remove(T *e) {
+    T **b=&buckets[hashnaam(e->naam)&(size-1)];
+    while (*b) {
+      if (*b==e) { *b=e->hnext; --count; return; }
+      b=&(*b)->hnext;
+    }
+  }
+private:
+  T **buckets;
+  unsigned int size,count;
+  void grow() {
+    T **ob=buckets,*p,*n,**t;
+    unsigned int osize=size,i;
+    size<<=1; buckets=new T*[size];
+    for (i=0; i<size; buckets[i++]=NULL);
+    // append to keep chain order (shadowed names stay behind the newest one)
+    for (i=0; i<osize; ++i) {
+      p=ob[i];
+      while (p) {
+        n=p->hnext; p->hnext=NULL;
+        t=&buckets[hashnaam(p->naam)&(size-1)];
+        while (*t) t=&(*t)->hnext;
+        *t=p; p=n;
+      }
+    }
+    delete[] ob;
+  }
+};
+
 class labtabentrycls {
 public:
   char *name;
@@ -50,9 +104,9 @@ public:
   void dump();
   void dumpsym();
 private:
-  int hashtable[LABTABSIZE],nextlocation;
-  labtabentrycls labtab[LABTABSIZE];
-  int hash(char*);
+  int *hashtable,hashsize,nextlocation,labtabsize;
+  labtabentrycls *labtab;
+  void grow();
 };
 
 class funtabentrycls {
@@ -93,7 +147,7 @@ private:
 class definetabentrycls {
 public:
   char *naam, *vervanger;
-  definetabentrycls *next;
+  definetabentrycls *next,*hnext;
   definetabentrycls(char*,char*,definetabentrycls*);
 };
 
@@ -105,7 +159,7 @@ public:
   int bestaat(char*);
   definetabcls() { init(); }
 private:
-  definetabentrycls *defs[128];
+  hashtabcls<definetabentrycls> defs;
 };
 
 class macdefinetabcls {
@@ -118,8 +172,8 @@ public:
   int bestaat(char*);
   macdefinetabcls() { init(); }
 private:
-  int used[128];
   definetabentrycls *defs;
+  hashtabcls<definetabentrycls> index;
 };
 
 class adrlst {
@@ -142,7 +196,7 @@ class macrotabentrycls {
 public:
   char *naam;
   stringlst *args, *body;
-  macrotabentrycls *next;
+  macrotabentrycls *next,*hnext;
   macrotabentrycls(char*,macrotabentrycls*);
 };
 
@@ -154,8 +208,8 @@ public:
   void init();
   macrotabcls() { init(); }
 private:
-  int used[128];
   macrotabentrycls *macs;
+  hashtabcls<macrotabentrycls> index;
 };
 
 class structmembncls {
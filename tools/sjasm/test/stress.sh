@@ -0,0 +1,83 @@
+#!/bin/sh
+# Sjasm label / define / macro tables stress test.
+#
+# usage: stress.sh <sjasm_binary> [num_label] [num_define] [num_macro]
+#
+# Generates a source with a large number of labels (EQU), defines and macros, assembles it
+# and checks the output binary against the expected values:
+# - labels and defines are referenced before they are defined (forward references between passes)
+# - a word is emitted for every REF_STEP label (label + define value)
+# - every macro is invoked once and emits its index
+#
+# Default counts (200000 labels, 30000 defines, 2000 macros) are far above the old fixed table sizes.
+
+if [ $# -lt 1 ]; then
+    echo "usage: $0 <sjasm_binary> [num_label] [num_define] [num_macro]"
+    exit 2
+fi
+
+SJASM=$1
+NUM_LABEL=${2:-200000}
+NUM_DEFINE=${3:-30000}
+NUM_MACRO=${4:-2000}
+REF_STEP=16
+
+TMP=${TMPDIR:-/tmp}/sjasm_stress.$$
+mkdir -p "$TMP" || exit 2
+trap 'rm -rf "$TMP"' EXIT
+
+# generate source and expected output bytes (decimal, one per line)
+awk -v nl="$NUM_LABEL" -v nd="$NUM_DEFINE" -v nm="$NUM_MACRO" -v step="$REF_STEP" \
+    -v src="$TMP/stress.asm" -v expf="$TMP/expected.txt" 'BEGIN {
+    print "\torg 0" > src
+
+    # defines must be declared before use
+    for (i = 0; i < nd; i++)
+        printf("\tdefine DEF_%d %d\n", i, i % 251) > src
+
+    # macros must be declared before use
+    for (i = 0; i < nm; i++)
+    {
+        printf("\tmacro MAC_%d\n\tdb %d\n\tendm\n", i, i % 256) > src
+    }
+
+    # label references (forward)
+    for (i = 0; i < nl; i += step)
+    {
+        d = i % nd;
+        v = (i * 7) % 65000 + (d % 251);
+        printf("\tdw LBL_%d+DEF_%d\n", i, d) > src
+        printf("%d\n%d\n", v % 256, int(v / 256)) > expf
+    }
+
+    # macro invocations
+    for (i = 0; i < nm; i++)
+    {
+        printf("\tMAC_%d\n", i) > src
+        printf("%d\n", i % 256) > expf
+    }
+
+    # label definitions
+    for (i = 0; i < nl; i++)
+        printf("LBL_%d equ %d\n", i, (i * 7) % 65000) > src
+}'
+
+START=$(date +%s)
+
+if ! "$SJASM" "$TMP/stress.asm" "$TMP/stress.bin" "$TMP/stress.lst" > "$TMP/sjasm.log" 2>&1; then
+    cat "$TMP/sjasm.log"
+    echo "FAILED: assembly error"
+    exit 1
+fi
+
+END=$(date +%s)
+
+od -An -v -tu1 "$TMP/stress.bin" | tr -s ' ' '\n' | sed '/^$/d' > "$TMP/result.txt"
+
+if ! cmp -s "$TMP/expected.txt" "$TMP/result.txt"; then
+    echo "FAILED: output mismatch ($(wc -l < "$TMP/result.txt") bytes, expected $(wc -l < "$TMP/expected.txt"))"
+    exit 1
+fi
+
+echo "OK: $NUM_LABEL labels, $NUM_DEFINE defines, $NUM_MACRO macros assembled in $((END - START)) s"
+exit 0
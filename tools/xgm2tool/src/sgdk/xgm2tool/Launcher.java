@@ -29,6 +29,7 @@ public class Launcher extends JFrame
     public static boolean sampleRateFix = true;
     public static boolean sampleIgnore = true;
     public static boolean sampleAdvancedCompare = false;
+    public static boolean sampleFastCompare = false;
     public static boolean delayKeyOff = false;
 
     /**
@@ -80,17 +81,68 @@ public class Launcher extends JFrame
         }
     }
 
-    private static int execute(String[] args) throws IOException
+    /**
+     * Convert the given VGM file(s) to XGM2 binary data without going through files (used by rescomp to avoid
+     * spawning a new process for each conversion).<br>
+     * Several input files produce a multi tracks XGM2 (PCM sharing), a single XGM / XGC input file is just
+     * converted.
+     *
+     * @param inFiles
+     *        input VGM file(s)
+     * @param packed
+     *        <code>true</code> for XGC2 (packed XGM2) output, <code>false</code> for XGM2 output
+     * @param options
+     *        conversion options, same as command line options (-s, -v, -di, -dr, -dd, -ac, -n, -p)
+     * @return converted data
+     */
+    public static synchronized byte[] convert(List<String> inFiles, boolean packed, List<String> options) throws IOException
     {
-        // out/sor2*.vgm out/sor2.xgc
-        
-        final List<String> files = new ArrayList<>();
+        // only get options from there
+        parseOptions(options.toArray(new String[options.size()]), new ArrayList<>());
+
+        if (inFiles.isEmpty())
+            throw new IllegalArgumentException("No input file");
+
+        for (String file : inFiles)
+            if (!FileUtil.exists(file))
+                throw new IOException("Error: the source file '" + file + "' could not be find");
+
+        // multi tracks
+        if (inFiles.size() > 1)
+        {
+            final List<XGM> xgms = new ArrayList<>();
+
+            for (String file : inFiles)
+                xgms.add(new XGM(loadVGM(file), packed));
+
+            return new XGMMulti(xgms, packed).asByteArray();
+        }
+
+        final String inFile = inFiles.get(0);
+        final String inExt = FileUtil.getFileExtension(inFile, false).toUpperCase();
+
+        // input file is XGM or XGC
+        if (StringUtil.equals(inExt, "XGM") || StringUtil.equals(inExt, "XGC"))
+        {
+            final XGM xgm = loadXGM(inFile);
+
+            xgm.packed = packed;
+            return xgm.asByteArray();
+        }
 
+        // assume VGM
+        return new XGM(loadVGM(inFile), packed).asByteArray();
+    }
+
+    private static void parseOptions(String[] args, List<String> files)
+    {
         sys = SYSTEM_AUTO;
         silent = false;
         verbose = false;
         sampleIgnore = true;
         sampleRateFix = true;
+        sampleAdvancedCompare = false;
+        sampleFastCompare = false;
         delayKeyOff = true;
 
         // options
@@ -116,6 +168,8 @@ public class Launcher extends JFrame
                 delayKeyOff = false;
             else if (StringUtil.equals(arg, "-ac"))
                 sampleAdvancedCompare = true;
+            else if (StringUtil.equals(arg, "-af"))
+                sampleFastCompare = true;
             else if (StringUtil.equals(arg, "-n"))
                 sys = SYSTEM_NTSC;
             else if (StringUtil.equals(arg, "-p"))
@@ -129,7 +183,16 @@ public class Launcher extends JFrame
         // silent mode has priority
         if (silent)
             verbose = false;
-        
+    }
+
+    private static int execute(String[] args) throws IOException
+    {
+        // out/sor2*.vgm out/sor2.xgc
+
+        final List<String> files = new ArrayList<>();
+
+        parseOptions(args, files);
+
         final int numFile = files.size();
         final String outFile = files.get(files.size() - 1);
         final String outExt = FileUtil.getFileExtension(outFile, false).toUpperCase();
@@ -334,6 +397,7 @@ public class Launcher extends JFrame
         System.out.println("-dr\tdisable PCM sample rate auto fix (it can help when PCM are not properly extracted).");
         System.out.println("-dd\tdisable delayed KEY OFF event when we have KEY ON/OFF in a single frame (it can fix incorrect instrument sound).");
         System.out.println("-ac\tenable fingerprint compare on PCM merging operation (use it to improve duplicate sample detection, can be too aggressive..).");
+        System.out.println("-af\twith -ac, skip fingerprint compare of PCM with very different loudness (faster but lossy: can miss a merge of the same sample played at a different volume).");
     }
 
     // easier access
@@ -3,7 +3,11 @@ package sgdk.xgm2tool.format;
 import java.io.ByteArrayOutputStream;
 import java.io.IOException;
 import java.util.ArrayList;
+import java.util.Collection;
+import java.util.HashMap;
 import java.util.List;
+import java.util.Map;
+import java.util.TreeMap;
 
 import sgdk.xgm2tool.Launcher;
 import sgdk.xgm2tool.tool.Util;
@@ -16,6 +20,12 @@ public class XGMMulti
     public final List<XGM> xgms;
     public final List<XGMSample> sharedSamples;
 
+    // shared samples indexed by length (advanced compare) and by head hash (exact compare) so we only compare candidates
+    private final TreeMap<Integer, List<XGMSample>> samplesByLength;
+    private final Map<Long, List<XGMSample>> samplesByHead;
+    // shared samples too short to have a head hash (exact compare)
+    private final List<XGMSample> shortSamples;
+
     public boolean pal;
     public boolean hasGD3;
     public boolean packed;
@@ -32,6 +42,9 @@ public class XGMMulti
 
         this.xgms = xgms;
         sharedSamples = new ArrayList<>();
+        samplesByLength = new TreeMap<>();
+        samplesByHead = new HashMap<>();
+        shortSamples = new ArrayList<>();
         packed = pack;
 
         if (xgms.size() > 128)
@@ -92,20 +105,71 @@ public class XGMMulti
         }
     }
 
+    private void addSharedSample(XGMSample sample)
+    {
+        sharedSamples.add(sample);
+
+        samplesByLength.computeIfAbsent(Integer.valueOf(sample.getLength()), k -> new ArrayList<>()).add(sample);
+
+        final Long head = sample.getHeadHash();
+        if (head != null)
+            samplesByHead.computeIfAbsent(head, k -> new ArrayList<>()).add(sample);
+        else
+            shortSamples.add(sample);
+    }
+
+    /**
+     * Return the shared samples which can possibly replace the given sample (see XGMSample.isMatchCandidate(..))
+     */
+    private List<Collection<XGMSample>> getCandidateSamples(XGMSample sample)
+    {
+        final List<Collection<XGMSample>> result = new ArrayList<>();
+
+        if (Launcher.sampleAdvancedCompare)
+        {
+            // a shared sample can't be more than 150 bytes shorter than the sample it replaces
+            result.addAll(samplesByLength.tailMap(Integer.valueOf(sample.getLength() - 150), true).values());
+        }
+        else
+        {
+            final Long head = sample.getHeadHash();
+
+            // short sample ? --> any shared sample can start with it
+            if (head == null)
+                result.add(sharedSamples);
+            else
+            {
+                // exact compare on at least SIGNATURE_BLOCK_SIZE bytes ? --> same head hash
+                final List<XGMSample> sameHead = samplesByHead.get(head);
+                if (sameHead != null)
+                    result.add(sameHead);
+                // or compare on less bytes
+                result.add(shortSamples);
+            }
+        }
+
+        return result;
+    }
+
     private XGMSample findMatchingSample(XGMSample sample)
     {
         XGMSample bestMatch = null;
         double bestScore = 0d;
 
-        for (XGMSample s : sharedSamples)
+        for (Collection<XGMSample> candidates : getCandidateSamples(sample))
         {
-            if (s != sample)
+            for (XGMSample s : candidates)
             {
-                final double score = s.getSimilarityScore(sample);
-                if (score > bestScore)
+                // cheap prefilter before full similarity check
+                if ((s != sample) && s.isMatchCandidate(sample))
                 {
-                    bestMatch = s;
-                    bestScore = score;
+                    final double score = s.getSimilarityScore(sample);
+                    // on same score keep the first shared sample (lower id) as a full scan would do
+                    if ((score > bestScore) || ((score == bestScore) && (bestMatch != null) && (s.id < bestMatch.id)))
+                    {
+                        bestMatch = s;
+                        bestScore = score;
+                    }
                 }
             }
         }
@@ -143,7 +207,7 @@ public class XGMMulti
             }
 
             // just add the sample
-            sharedSamples.add(sample);
+            addSharedSample(sample);
 
             final int newId = sharedSamples.size();
             // update VGM so it now uses the new sample id
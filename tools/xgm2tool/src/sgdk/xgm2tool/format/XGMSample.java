@@ -34,6 +34,13 @@ public class XGMSample
     final static int XGM_FULL_RATE = 13300;
     final static int XGM_HALF_RATE = (XGM_FULL_RATE / 2);
 
+    // block size for the coarse sample signature (prefix hash and energy)
+    final static int SIGNATURE_BLOCK_SIZE = 256;
+    // max allowed loudness ratio between 2 samples to be compared (fast advanced compare only)
+    final static int MAX_ENERGY_RATIO = 4;
+    // fingerprint frame size for each compared length bucket (see getFingerprintBucket(..))
+    final static int[] FINGERPRINT_FRAME_SIZES = {256, 512, 1024, 2048};
+
     int id;
     final byte[] data;
 
@@ -42,6 +49,12 @@ public class XGMSample
     final int originId;
     final int originAddr;
 
+    // fingerprint of the whole sample for each frame size bucket (built on first use, sample data is never modified)
+    private final byte[][] fingerprints = new byte[FINGERPRINT_FRAME_SIZES.length][];
+    // prefix hash and absolute amplitude sum at each signature block boundary (built on first use)
+    private long[] blockHashes;
+    private long[] blockEnergies;
+
     public XGMSample(int id, byte[] data, boolean halfRate, int originId, int originAddr)
     {
         super();
@@ -78,19 +91,91 @@ public class XGMSample
         return data.length;
     }
 
-    public double getSimilarityScore(XGMSample originSample)
+    private void buildSignature()
     {
-        final int deltaSize = originSample.data.length - data.length;
-        // origin sample is longer ? cannot use a shorter sample to replace it...
-        if (deltaSize > 150)
-            return 0d;
+        if (blockHashes != null)
+            return;
 
-        final int minSize = Math.min(data.length, originSample.data.length);
+        final int numBlock = data.length / SIGNATURE_BLOCK_SIZE;
 
-        // advanced sample compare using fingerprint
-        if (Launcher.sampleAdvancedCompare)
+        blockHashes = new long[numBlock + 1];
+        blockEnergies = new long[numBlock + 1];
+
+        long hash = 0;
+        long energy = 0;
+        int off = 0;
+        for (int b = 1; b <= numBlock; b++)
         {
-            int minSizePadded = (minSize < 2048) ? (int) MathUtil.nextPow2(minSize) : minSize;
+            for (int i = 0; i < SIGNATURE_BLOCK_SIZE; i++, off++)
+            {
+                hash = (hash * 31) + (data[off] & 0xFF);
+                energy += Math.abs(data[off]);
+            }
+
+            blockHashes[b] = hash;
+            blockEnergies[b] = energy;
+        }
+    }
+
+    /**
+     * Return hash of the first <code>size</code> bytes of sample data
+     */
+    private long getPrefixHash(int size)
+    {
+        buildSignature();
+
+        final int block = size / SIGNATURE_BLOCK_SIZE;
+        long hash = blockHashes[block];
+
+        for (int i = block * SIGNATURE_BLOCK_SIZE; i < size; i++)
+            hash = (hash * 31) + (data[i] & 0xFF);
+
+        return hash;
+    }
+
+    /**
+     * Return mean absolute amplitude of the first <code>size</code> bytes of sample data (full blocks only)
+     * or -1 if sample is too short
+     */
+    private double getMeanEnergy(int size)
+    {
+        buildSignature();
+
+        final int block = size / SIGNATURE_BLOCK_SIZE;
+        if (block == 0)
+            return -1d;
+
+        return (double) blockEnergies[block] / (block * SIGNATURE_BLOCK_SIZE);
+    }
+
+    /**
+     * Return fingerprint frame size bucket to use to compare samples on <code>size</code> bytes
+     */
+    private static int getFingerprintBucket(int size)
+    {
+        if (size < 512)
+            return 0;
+        if (size < 1024)
+            return 1;
+        if (size < 2048)
+            return 2;
+
+        return 3;
+    }
+
+    /**
+     * Return the fingerprint of the whole sample using frame size of given bucket (computed only once per bucket).<br>
+     * The comparison locates the best matching frame offset and is normalized on the shortest fingerprint so we don't
+     * need a fingerprint for each compared length.
+     */
+    private byte[] getFingerprint(int bucket)
+    {
+        byte[] result = fingerprints[bucket];
+
+        if (result == null)
+        {
+            final int size = data.length;
+            int sizePadded = (size < 2048) ? (int) MathUtil.nextPow2(size) : size;
 
             final FingerprintManager fingerprintManager = new FingerprintManager();
 
@@ -98,39 +183,84 @@ public class XGMSample
             {
                 Field sampleSizePerFrameF = FingerprintManager.class.getDeclaredField("sampleSizePerFrame");
                 sampleSizePerFrameF.setAccessible(true);
-
-                if (minSize < 512)
-                    sampleSizePerFrameF.set(fingerprintManager, Integer.valueOf(256));
-                else if (minSize < 1024)
-                    sampleSizePerFrameF.set(fingerprintManager, Integer.valueOf(512));
-                else if (minSize < 2048)
-                    sampleSizePerFrameF.set(fingerprintManager, Integer.valueOf(1024));
-                else if (minSize < 4096)
-                    sampleSizePerFrameF.set(fingerprintManager, Integer.valueOf(2048));
-                else
-                    // default
-                    sampleSizePerFrameF.set(fingerprintManager, Integer.valueOf(2048));
+                sampleSizePerFrameF.set(fingerprintManager, Integer.valueOf(FINGERPRINT_FRAME_SIZES[bucket]));
             }
             catch (Exception e)
             {
                 // pad to 2048
-                minSizePadded = Math.max(minSize, 2048);
+                sizePadded = Math.max(size, 2048);
             }
 
-            final byte[] sample1 = new byte[minSizePadded];
-            Arrays.fill(sample1, (byte) 128);
-            for (int i = 0; i < minSize; i++)
-                sample1[i] = (byte) (data[i] + 128);
+            final byte[] sample = new byte[sizePadded];
+            Arrays.fill(sample, (byte) 128);
+            for (int i = 0; i < size; i++)
+                sample[i] = (byte) (data[i] + 128);
+
+            result = fingerprintManager.extractFingerprint(new Wave(xgmWaveHeader, sample));
+            fingerprints[bucket] = result;
+        }
+
+        return result;
+    }
+
+    /**
+     * Return hash of the first {@link #SIGNATURE_BLOCK_SIZE} bytes of sample data (used to index samples for exact compare)
+     * or <code>null</code> if sample is shorter than that
+     */
+    public Long getHeadHash()
+    {
+        if (data.length < SIGNATURE_BLOCK_SIZE)
+            return null;
+
+        return Long.valueOf(getPrefixHash(SIGNATURE_BLOCK_SIZE));
+    }
+
+    /**
+     * Cheap test to know if this sample can replace the origin sample, to call before {@link #getSimilarityScore(XGMSample)}.<br>
+     * Length and prefix hash (exact compare) tests never reject a pair {@link #getSimilarityScore(XGMSample)} would accept.<br>
+     * Loudness test (fast advanced compare only) is a heuristic and can reject a valid match.
+     */
+    public boolean isMatchCandidate(XGMSample originSample)
+    {
+        // origin sample is longer ? cannot use a shorter sample to replace it...
+        if ((originSample.data.length - data.length) > 150)
+            return false;
+
+        final int minSize = Math.min(data.length, originSample.data.length);
+
+        // exact compare --> compare prefix hash
+        if (!Launcher.sampleAdvancedCompare)
+            return getPrefixHash(minSize) == originSample.getPrefixHash(minSize);
+        // fingerprint compare is spectral so loudness can't be used to reject a pair without loss
+        if (!Launcher.sampleFastCompare)
+            return true;
+
+        final double energy1 = getMeanEnergy(minSize);
+        final double energy2 = originSample.getMeanEnergy(minSize);
 
-            final byte[] sample2 = new byte[minSizePadded];
-            Arrays.fill(sample2, (byte) 128);
-            for (int i = 0; i < minSize; i++)
-                sample2[i] = (byte) (originSample.data[i] + 128);
+        // too short to get a significant energy
+        if ((energy1 < 0) || (energy2 < 0))
+            return true;
 
-            final Wave wave1 = new Wave(xgmWaveHeader, sample1);
-            final Wave wave2 = new Wave(xgmWaveHeader, sample2);
-            final byte[] fp1 = fingerprintManager.extractFingerprint(wave1);
-            final byte[] fp2 = fingerprintManager.extractFingerprint(wave2);
+        // very different loudness --> not the same sample
+        return Math.max(energy1, energy2) <= ((Math.min(energy1, energy2) * MAX_ENERGY_RATIO) + 1d);
+    }
+
+    public double getSimilarityScore(XGMSample originSample)
+    {
+        final int deltaSize = originSample.data.length - data.length;
+        // origin sample is longer ? cannot use a shorter sample to replace it...
+        if (deltaSize > 150)
+            return 0d;
+
+        final int minSize = Math.min(data.length, originSample.data.length);
+
+        // advanced sample compare using fingerprint
+        if (Launcher.sampleAdvancedCompare)
+        {
+            final int bucket = getFingerprintBucket(minSize);
+            final byte[] fp1 = getFingerprint(bucket);
+            final byte[] fp2 = originSample.getFingerprint(bucket);
             final FingerprintSimilarity similarity = new FingerprintSimilarityComputer(fp2, fp1).getFingerprintsSimilarity();
 
             if (Launcher.verbose)
@@ -141,6 +271,12 @@ public class XGMSample
         }
 
         // simple sample compare (exact match)
-        return Arrays.equals(Arrays.copyOf(data, minSize), Arrays.copyOf(originSample.data, minSize)) ? 1d : 0d;
+        if (getPrefixHash(minSize) != originSample.getPrefixHash(minSize))
+            return 0d;
+        for (int i = 0; i < minSize; i++)
+            if (data[i] != originSample.data[i])
+                return 0d;
+
+        return 1d;
     }
 }
@@ -19,6 +19,8 @@ typedef struct
     int offset;
     int len;
     int id;
+    // allocated data size (0 when data still refers to the source VGM buffer)
+    int allocated;
 } SampleBank;
 
 
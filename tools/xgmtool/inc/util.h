@@ -23,6 +23,27 @@ typedef struct LList_
     struct LList_ *next;
 } LList;
 
+typedef int (*LListValueFunc)(void* element);
+
+// contiguous index of a linked list (rebuilt on demand when the list is modified)
+typedef struct
+{
+    LList* list;
+    LList** elements;
+    // prefix sums: offsets[i] / times[i] = sum of size / time values of elements 0..i-1 (size + 1 entries)
+    int* offsets;
+    int* times;
+    // element pointer --> position hash table
+    void** hashElements;
+    int* hashPositions;
+    int hashMask;
+    int size;
+    int allocated;
+    int stamp;
+    LListValueFunc sizeFunc;
+    LListValueFunc timeFunc;
+} LListIndex;
+
 
 //void initList(List* list);
 //List* createList();
@@ -48,6 +69,14 @@ LList* insertBeforeLList(LList* linkedElement, void* element);
 LList* insertAllAfterLList(LList* linkedElement, LList* elements);
 LList* insertAllBeforeLList(LList* linkedElement, LList* elements);
 LList* removeFromLList(LList* linkedElement);
+void setElementLList(LList* linkedElement, void* element);
+void invalidateLListIndexes();
+
+LListIndex* getLListIndex(LListIndex* index, LList* list, LListValueFunc sizeFunc, LListValueFunc timeFunc);
+void deleteLListIndex(LListIndex* index);
+int getPositionLListIndex(LListIndex* index, void* element);
+int findOffsetLListIndex(LListIndex* index, int offset);
+int findTimeLListIndex(LListIndex* index, int time);
 
 //void* getFromLList(LList* list, int index);
 //void addToLList(LList* list, void* element);
@@ -76,7 +105,9 @@ char* getFileExtension(char* path);
 unsigned int getFileSizeEx(FILE* f);
 unsigned int getFileSize(char* file);
 unsigned char* readBinaryFile(char* fileName, int* size);
+unsigned char* mapBinaryFile(char* fileName, int* size);
 bool writeBinaryFile(unsigned char* data, int size, char* fileName);
+FILE* openTempFile();
 unsigned char* inEx(FILE* fin, int inOffset, int size, int* outSize);
 int inEx2(FILE* fin, int inOffset, int size, unsigned char* dest, int outOffset);
 bool out(unsigned char* data, int inOffset, int size, int intSize, bool swap, char* out);
@@ -14,6 +14,7 @@ typedef struct
 
     LList* sampleBanks;
     LList* commands;
+    LListIndex* commandIndex;
 
     int version;
 
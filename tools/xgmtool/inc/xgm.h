@@ -9,6 +9,7 @@ typedef struct
 {
     LList* samples;
     LList* commands;
+    LListIndex* commandIndex;
     GD3* gd3;
     XD3* xd3;
     int pal;
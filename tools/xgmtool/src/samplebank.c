@@ -18,8 +18,10 @@ SampleBank* SampleBank_create(VGMCommand* command)
 
     result = malloc(sizeof(SampleBank));
 
+    // refer source data (no copy)
     result->data = command->data;
     result->offset = command->offset;
+    result->allocated = 0;
 
     // id
     result->id = VGMCommand_getDataBankId(command);
@@ -41,11 +43,30 @@ void SampleBank_addBlock(SampleBank* bank, VGMCommand* command)
         return;
 
     // concat data block
-    int newLen = bank->len + VGMCommand_getDataBlockLen(command);
-    unsigned char* newData = malloc(newLen + 7);
+    const int blockLen = VGMCommand_getDataBlockLen(command);
+    const int newLen = bank->len + blockLen;
+    unsigned char* newData;
 
-    memcpy(&newData[0], &bank->data[bank->offset], bank->len + 7);
-    memcpy(&newData[bank->len + 7], &command->data[command->offset + 7], VGMCommand_getDataBlockLen(command));
+    // data still in source buffer --> copy it in a growable buffer
+    if (bank->allocated == 0)
+    {
+        bank->allocated = (newLen + 7) + ((newLen + 7) / 2);
+        newData = malloc(bank->allocated);
+        memcpy(&newData[0], &bank->data[bank->offset], bank->len + 7);
+    }
+    else
+    {
+        newData = bank->data;
+
+        // grow buffer by 50% to avoid a full copy for each added block
+        if ((newLen + 7) > bank->allocated)
+        {
+            bank->allocated = (newLen + 7) + ((newLen + 7) / 2);
+            newData = realloc(newData, bank->allocated);
+        }
+    }
+
+    memcpy(&newData[bank->len + 7], &command->data[command->offset + 7], blockLen);
     // adjust len
     setInt(newData, 0 + 3, newLen);
 
@@ -53,7 +74,7 @@ void SampleBank_addBlock(SampleBank* bank, VGMCommand* command)
         printf("Initial block sample added [%6X-%6X]   rate: %d Hz\n", bank->len, newLen - 1, 0);
 
     // add new sample corresponding to this data block
-    insertAfterLList(bank->samples, Sample_create(getSizeLList(bank->samples), bank->len, VGMCommand_getDataBlockLen(command), 0));
+    insertAfterLList(bank->samples, Sample_create(getSizeLList(bank->samples), bank->len, blockLen, 0));
 
     // set new data and len
     bank->data = newData;
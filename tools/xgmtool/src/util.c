@@ -4,8 +4,32 @@
 #include <string.h>
 #include <math.h>
 
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#endif
+
 #include "../inc/util.h"
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+// max deflate compression ratio is about 1032:1 so any bigger gzip ISIZE value is bogus
+#define GZIP_MAX_RATIO          1032
+// don't pre allocate more than that from the (untrusted) gzip ISIZE value, buffer grows on demand above
+#define GZIP_MAX_INIT_SIZE      (64 * 1024 * 1024)
+// max inflated size (output size is stored as int)
+#define GZIP_MAX_SIZE           (1024 * 1024 * 1024)
+
 
 //void initList(List* list)
 //{
@@ -126,6 +150,10 @@
 //}
 
 
+// list modification stamp (used to detect obsolete list index)
+static int lListStamp = 0;
+
+
 LList* createEmptyElement()
 {
     LList* result = malloc(sizeof(LList));
@@ -152,6 +180,8 @@ void deleteLList(LList* list)
 {
     LList* l = list;
 
+    lListStamp++;
+
     while(l != NULL)
     {
         LList* n = l->next;
@@ -228,6 +258,8 @@ LList* insertAfterLList(LList* linkedElement, void* element)
 {
     LList* newElement = createElement(element);
 
+    lListStamp++;
+
     if (linkedElement != NULL)
     {
         connectNext(newElement, linkedElement->next);
@@ -242,6 +274,8 @@ LList* insertBeforeLList(LList* linkedElement, void* element)
 {
     LList* newElement = createElement(element);
 
+    lListStamp++;
+
     if (linkedElement != NULL)
     {
         connectPrev(newElement, linkedElement->prev);
@@ -286,6 +320,8 @@ LList* removeFromLList(LList* linkedElement)
 {
     if (linkedElement == NULL) return NULL;
 
+    lListStamp++;
+
     // next element present ?
     if (linkedElement->next != NULL)
         // link next to prev
@@ -305,6 +341,207 @@ LList* removeFromLList(LList* linkedElement)
     return result;
 }
 
+void setElementLList(LList* linkedElement, void* element)
+{
+    linkedElement->element = element;
+    lListStamp++;
+}
+
+/**
+ * Force rebuild of list indexes (to call when an indexed element value changed)
+ */
+void invalidateLListIndexes()
+{
+    lListStamp++;
+}
+
+
+static int hashPointer(void* ptr, int mask)
+{
+    unsigned long long h = (unsigned long long) (size_t) ptr;
+
+    // pointers are aligned so mix high bits
+    h ^= h >> 17;
+    h *= 0x9E3779B97F4A7C15ULL;
+
+    return (int) (h >> 32) & mask;
+}
+
+static void buildLListIndex(LListIndex* index)
+{
+    LList* l;
+    int i;
+    int offset;
+    int time;
+    int size = getSizeLList(index->list);
+
+    // need more space ?
+    if (size >= index->allocated)
+    {
+        free(index->elements);
+        free(index->offsets);
+        free(index->times);
+        free(index->hashElements);
+        free(index->hashPositions);
+
+        index->allocated = size + (size / 2) + 16;
+        index->elements = malloc(sizeof(LList*) * index->allocated);
+        index->offsets = malloc(sizeof(int) * (index->allocated + 1));
+        index->times = malloc(sizeof(int) * (index->allocated + 1));
+
+        // hash table load <= 50%
+        i = 32;
+        while(i < (index->allocated * 2)) i <<= 1;
+        index->hashMask = i - 1;
+        index->hashElements = malloc(sizeof(void*) * i);
+        index->hashPositions = malloc(sizeof(int) * i);
+    }
+
+    memset(index->hashElements, 0, sizeof(void*) * (index->hashMask + 1));
+
+    i = 0;
+    offset = 0;
+    time = 0;
+    l = index->list;
+    while(l != NULL)
+    {
+        void* element = l->element;
+        int h = hashPointer(element, index->hashMask);
+
+        index->elements[i] = l;
+        index->offsets[i] = offset;
+        index->times[i] = time;
+
+        // keep first position for duplicated element
+        while((index->hashElements[h] != NULL) && (index->hashElements[h] != element))
+            h = (h + 1) & index->hashMask;
+        if (index->hashElements[h] == NULL)
+        {
+            index->hashElements[h] = element;
+            index->hashPositions[h] = i;
+        }
+
+        offset += index->sizeFunc(element);
+        time += index->timeFunc(element);
+        l = l->next;
+        i++;
+    }
+
+    index->offsets[i] = offset;
+    index->times[i] = time;
+    index->size = size;
+    index->stamp = lListStamp;
+}
+
+/**
+ * Return an up to date index for the specified list (index is allocated if NULL and rebuilt if list changed)
+ */
+LListIndex* getLListIndex(LListIndex* index, LList* list, LListValueFunc sizeFunc, LListValueFunc timeFunc)
+{
+    LListIndex* result = index;
+
+    if (result == NULL)
+    {
+        result = malloc(sizeof(LListIndex));
+
+        result->elements = NULL;
+        result->offsets = NULL;
+        result->times = NULL;
+        result->hashElements = NULL;
+        result->hashPositions = NULL;
+        result->hashMask = 0;
+        result->size = 0;
+        result->allocated = 0;
+        result->stamp = lListStamp - 1;
+    }
+    // still valid ?
+    else if ((result->list == list) && (result->stamp == lListStamp) && (result->sizeFunc == sizeFunc) && (result->timeFunc == timeFunc))
+        return result;
+
+    result->list = list;
+    result->sizeFunc = sizeFunc;
+    result->timeFunc = timeFunc;
+    buildLListIndex(result);
+
+    return result;
+}
+
+void deleteLListIndex(LListIndex* index)
+{
+    if (index == NULL) return;
+
+    free(index->elements);
+    free(index->offsets);
+    free(index->times);
+    free(index->hashElements);
+    free(index->hashPositions);
+    free(index);
+}
+
+/**
+ * Return position of the specified element in the indexed list (-1 if not found)
+ */
+int getPositionLListIndex(LListIndex* index, void* element)
+{
+    int h;
+
+    if ((element == NULL) || (index->size == 0)) return -1;
+
+    h = hashPointer(element, index->hashMask);
+    while(index->hashElements[h] != NULL)
+    {
+        if (index->hashElements[h] == element)
+            return index->hashPositions[h];
+
+        h = (h + 1) & index->hashMask;
+    }
+
+    return -1;
+}
+
+// return first position where values[pos] >= value (size if none)
+static int lowerBound(int* values, int size, int value)
+{
+    int low = 0;
+    int high = size;
+
+    while(low < high)
+    {
+        const int mid = (low + high) >> 1;
+
+        if (values[mid] < value) low = mid + 1;
+        else high = mid;
+    }
+
+    return low;
+}
+
+/**
+ * Return position of the first element located at specified offset (-1 if not found)
+ */
+int findOffsetLListIndex(LListIndex* index, int offset)
+{
+    const int pos = lowerBound(index->offsets, index->size, offset);
+
+    if ((pos < index->size) && (index->offsets[pos] == offset))
+        return pos;
+
+    return -1;
+}
+
+/**
+ * Return position of the first element located at or after specified time (-1 if not found)
+ */
+int findTimeLListIndex(LListIndex* index, int time)
+{
+    const int pos = lowerBound(index->times, index->size, time);
+
+    if (pos < index->size)
+        return pos;
+
+    return -1;
+}
+
 
 //void** listToArray(LList* list)
 //{
@@ -550,6 +787,165 @@ unsigned char* readBinaryFile(char* fileName, int* size)
     return data;
 }
 
+static bool isGZip(unsigned char* data, int size)
+{
+    return (size > 18) && (data[0] == 0x1F) && (data[1] == 0x8B);
+}
+
+static unsigned char* inflateGZip(unsigned char* data, int size, int* outSize)
+{
+#ifdef HAVE_ZLIB
+    z_stream stream;
+    unsigned char* result;
+    unsigned int isize;
+    int allocated;
+    int ret;
+
+    // uncompressed size (modulo 2^32) is stored at end of gzip stream, only use it as a hint
+    isize = getInt(data, size - 4);
+    if ((isize >= (unsigned int) size) && ((isize / GZIP_MAX_RATIO) <= (unsigned int) size) && (isize <= GZIP_MAX_INIT_SIZE))
+        allocated = isize;
+    else
+        allocated = min(size, GZIP_MAX_INIT_SIZE / 4) * 4;
+
+    result = malloc(allocated);
+    if (result == NULL)
+    {
+        printf("Error: not enough memory to inflate gzip data (%d bytes)\n", allocated);
+        return NULL;
+    }
+
+    memset(&stream, 0, sizeof(stream));
+    // 16 + MAX_WBITS --> gzip header
+    if (inflateInit2(&stream, 16 + MAX_WBITS) != Z_OK)
+    {
+        printf("Error: cannot initialize gzip decompression\n");
+        free(result);
+        return NULL;
+    }
+
+    stream.next_in = data;
+    stream.avail_in = size;
+    stream.next_out = result;
+    stream.avail_out = allocated;
+
+    while((ret = inflate(&stream, Z_NO_FLUSH)) == Z_OK)
+    {
+        // output buffer full --> grow it
+        if (stream.avail_out == 0)
+        {
+            unsigned char* newResult;
+
+            if (allocated > (GZIP_MAX_SIZE / 2))
+            {
+                printf("Error: inflated gzip data is too large (> %d bytes)\n", allocated);
+                inflateEnd(&stream);
+                free(result);
+                return NULL;
+            }
+
+            newResult = realloc(result, allocated * 2);
+            if (newResult == NULL)
+            {
+                printf("Error: not enough memory to inflate gzip data (%d bytes)\n", allocated * 2);
+                inflateEnd(&stream);
+                free(result);
+                return NULL;
+            }
+
+            result = newResult;
+            stream.next_out = result + allocated;
+            stream.avail_out = allocated;
+            allocated *= 2;
+        }
+    }
+
+    *outSize = stream.total_out;
+    inflateEnd(&stream);
+
+    if (ret != Z_STREAM_END)
+    {
+        printf("Error: corrupted gzip data\n");
+        free(result);
+        return NULL;
+    }
+
+    return result;
+#else
+    printf("Error: compressed input (VGZ) not supported (xgmtool built without zlib)\n");
+    return NULL;
+#endif
+}
+
+/**
+ * Load a binary file for read: the file is memory mapped when possible (no copy, data is only read from disk when accessed).<br>
+ * Data can be modified (private mapping) without affecting the file.<br>
+ * GZip compressed file (as VGZ) is directly inflated from the mapped data.
+ */
+unsigned char* mapBinaryFile(char* fileName, int* size)
+{
+    unsigned char* data;
+    unsigned char* result;
+    int outSize;
+#ifndef _WIN32
+    bool mapped = false;
+#endif
+
+#ifdef _WIN32
+    data = readBinaryFile(fileName, size);
+    if (data == NULL) return NULL;
+#else
+    struct stat st;
+    const int fd = open(fileName, O_RDONLY);
+
+    if (fd == -1)
+    {
+        printf("Error: couldn't open input file %s\n", fileName);
+        // error
+        return NULL;
+    }
+
+    if ((fstat(fd, &st) == -1) || (st.st_size == 0))
+    {
+        printf("Error: empty file %s\n", fileName);
+        close(fd);
+        // error
+        return NULL;
+    }
+
+    *size = st.st_size;
+    data = mmap(NULL, *size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    // cannot map --> use standard read
+    if (data == MAP_FAILED)
+    {
+        data = readBinaryFile(fileName, size);
+        if (data == NULL) return NULL;
+    }
+    else mapped = true;
+#endif
+
+    if (!isGZip(data, *size))
+        return data;
+
+    result = inflateGZip(data, *size, &outSize);
+
+    // release compressed data
+#ifndef _WIN32
+    if (mapped)
+        munmap(data, *size);
+    else
+#endif
+        free(data);
+
+    if (result == NULL) return NULL;
+
+    *size = outSize;
+
+    return result;
+}
+
 bool writeBinaryFile(unsigned char* data, int size, char* fileName)
 {
     return out(data, 0, size, 1, false, fileName);
@@ -654,13 +1050,40 @@ bool outEx(unsigned char* data, int inOffset, int size, int intSize, bool swap,
 }
 
 
+/**
+ * Open a temporary binary file for read and write.<br>
+ * The file is unique to the process and removed on close so concurrent conversions don't collide.
+ */
+FILE* openTempFile()
+{
+#ifdef _WIN32
+    char path[MAX_PATH];
+    char fileName[MAX_PATH];
+    FILE* result;
+
+    // tmpfile() wants to create the file in the drive root on Windows (may need admin rights) so use the user temp folder
+    if (!GetTempPathA(sizeof(path), path)) return NULL;
+    // create an unique empty file
+    if (!GetTempFileNameA(path, "xgm", 0, fileName)) return NULL;
+
+    // 'T' = temporary (avoid flush to disk when possible), 'D' = delete on close
+    result = fopen(fileName, "w+bTD");
+    if (result == NULL) DeleteFileA(fileName);
+
+    return result;
+#else
+    return tmpfile();
+#endif
+}
+
+
 unsigned char* resample(unsigned char* data, int offset, int len, int inputRate, int outputRate, int align, int* outSize)
 {
-    FILE* f = fopen("tmp.bin", "wb+");
+    FILE* f = openTempFile();
 
     if (f == NULL)
     {
-        printf("Error: cannot open file tmp.bin\n");
+        printf("Error: cannot open temporary file\n");
         return NULL;
     }
 
@@ -61,6 +61,8 @@ VGM* VGM_create(unsigned char* data, int dataSize, int offset, bool convert)
 
     VGM* result = malloc(sizeof(VGM));
 
+    result->commandIndex = NULL;
+
     // set version
     result->version = ver;
 
@@ -205,6 +207,7 @@ VGM* VGM_createFromXGM(XGM* xgm)
     result->offset = 0;
 
     result->sampleBanks = NULL;
+    result->commandIndex = NULL;
 
     result->version = 0x60;
     result->offsetStart = 0;
@@ -349,25 +352,40 @@ VGM* VGM_createFromXGM(XGM* xgm)
     return result;
 }
 
+static int getCommandSize(void* command)
+{
+    return ((VGMCommand*) command)->size;
+}
+
+static int getCommandWait(void* command)
+{
+    return VGMCommand_getWaitValue(command);
+}
+
+/**
+ * Return command index (offset and time position of each command)
+ */
+static LListIndex* getCommandIndex(VGM* vgm)
+{
+    vgm->commandIndex = getLListIndex(vgm->commandIndex, vgm->commands, getCommandSize, getCommandWait);
+
+    return vgm->commandIndex;
+}
+
 int VGM_computeLenEx(VGM* vgm, VGMCommand* from)
 {
-    LList* curCom = vgm->commands;
-    int result = 0;
-    bool count = (from == NULL);
+    LListIndex* index = getCommandIndex(vgm);
+    const int total = index->times[index->size];
 
-    while(curCom != NULL)
-    {
-        VGMCommand* command = curCom->element;
+    if (from == NULL)
+        return total;
 
-        if (command == from)
-            count = true;
-        if (count)
-            result += VGMCommand_getWaitValue(command);
+    const int pos = getPositionLListIndex(index, from);
 
-        curCom = curCom->next;
-    }
+    if (pos == -1)
+        return 0;
 
-    return result;
+    return total - index->times[pos];
 }
 
 int VGM_computeLen(VGM* vgm)
@@ -380,21 +398,13 @@ int VGM_computeLen(VGM* vgm)
  */
 int VGM_getOffset(VGM* vgm, VGMCommand* command)
 {
-    LList* curCom = vgm->commands;
-    int result = 0;
+    LListIndex* index = getCommandIndex(vgm);
+    const int pos = getPositionLListIndex(index, command);
 
-    while(curCom != NULL)
-    {
-        VGMCommand* c = curCom->element;
+    if (pos == -1)
+        return -1;
 
-        if (c == command)
-            return result;
-        result += c->size;
-
-        curCom = curCom->next;
-    }
-
-    return -1;
+    return index->offsets[pos];
 }
 
 /**
@@ -402,21 +412,13 @@ int VGM_getOffset(VGM* vgm, VGMCommand* command)
  */
 int VGM_getTime(VGM* vgm, VGMCommand* command)
 {
-    LList* curCom = vgm->commands;
-    int result = 0;
+    LListIndex* index = getCommandIndex(vgm);
+    const int pos = getPositionLListIndex(index, command);
 
-    while(curCom != NULL)
-    {
-        VGMCommand* c = curCom->element;
-
-        if (c == command)
-            return result;
-        result += VGMCommand_getWaitValue(c);
-
-        curCom = curCom->next;
-    }
+    if (pos == -1)
+        return 0;
 
-    return 0;
+    return index->times[pos];
 }
 
 
@@ -433,21 +435,13 @@ int VGM_getTimeInFrame(VGM* vgm, VGMCommand* command)
  */
 LList* VGM_getCommandElementAtTime(VGM* vgm, int time)
 {
-    LList* c = vgm->commands;
-    int result = 0;
-
-    while(c != NULL)
-    {
-        VGMCommand* command = c->element;
+    LListIndex* index = getCommandIndex(vgm);
+    const int pos = findTimeLListIndex(index, time);
 
-        if (result >= time)
-            return c;
-
-        result += VGMCommand_getWaitValue(command);
-        c = c->next;
-    }
+    if (pos == -1)
+        return NULL;
 
-    return NULL;
+    return index->elements[pos];
 }
 
 /**
@@ -647,7 +641,7 @@ static void VGM_buildSamples(VGM* vgm, bool convert)
                     Sample_setRate(sample, sampleIdFrequencies[VGMCommand_getStreamId(command)]);
                     // convert to long command as we use single data block
                     if (convert)
-                        curCom->element = Sample_getStartLongCommandEx(bank, sample, sample->len);
+                        setElementLList(curCom, Sample_getStartLongCommandEx(bank, sample, sample->len));
                 }
                 else if (!silent)
                     printf("Warning: sample id %2X not found !\n", sampleId);
@@ -1028,7 +1022,7 @@ static void VGM_cleanPlayPCMCommands(VGM* vgm)
                     if (wait == 0)
                         removeFromLList(curCom);
                     else
-                        curCom->element = VGMCommand_create(0x70 + (wait - 1), time);
+                        setElementLList(curCom, VGMCommand_create(0x70 + (wait - 1), time));
                 }
             }
         }
@@ -1064,7 +1058,7 @@ static void VGM_removeSeekAndPlayPCMCommands(VGM* vgm)
             if (wait == 0)
                 removeFromLList(curCom);
             else
-                curCom->element = VGMCommand_create(0x70 + (wait - 1), time);
+                setElementLList(curCom, VGMCommand_create(0x70 + (wait - 1), time));
         }
 
         curCom = curCom->next;
@@ -1639,11 +1633,11 @@ unsigned char* VGM_asByteArray(VGM* vgm, int* outSize)
     int i;
     int gd3Offset;
     unsigned char byte;
-    FILE* f = fopen("tmp.bin", "wb+");
+    FILE* f = openTempFile();
 
     if (f == NULL)
     {
-        printf("Error: cannot open file tmp.bin\n");
+        printf("Error: cannot open temporary file\n");
         return NULL;
     }
 
@@ -1816,11 +1810,11 @@ unsigned char* VGM_asByteArray2(VGM* vgm, int* outSize, unsigned char **dataBl,
     int i;
     int gd3Offset;
     unsigned char byte;
-    FILE* f = fopen("tmp.bin", "wb+");
+    FILE* f = openTempFile();
 
     if (f == NULL)
     {
-        printf("Error: cannot open file tmp.bin\n");
+        printf("Error: cannot open temporary file\n");
         return NULL;
     }
 
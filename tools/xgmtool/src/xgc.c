@@ -648,25 +648,40 @@ int XGC_computeLenInSecond(XGM* source)
     return XGC_computeLenInFrameOf(source->commands) / (source->pal ? 50 : 60);
 }
 
+static int getCommandSize(void* command)
+{
+    return ((XGMCommand*) command)->size;
+}
+
+static int getCommandFrame(void* command)
+{
+    return XGCCommand_isFrameSize(command) ? 1 : 0;
+}
+
+/**
+ * Return command index (offset and frame position of each command)
+ */
+static LListIndex* getCommandIndex(XGM* source)
+{
+    source->commandIndex = getLListIndex(source->commandIndex, source->commands, getCommandSize, getCommandFrame);
+
+    return source->commandIndex;
+}
+
 /**
  * Return elapsed time when specified command happen (in 1/44100 of second)
  */
 int XGC_getTime(XGM* source, XGMCommand* command)
 {
-    LList* com = source->commands;
-    int result = -1;
+    LListIndex* index = getCommandIndex(source);
+    int pos = getPositionLListIndex(index, command);
 
-    while(com != NULL)
-    {
-        XGMCommand* c = com->element;
+    // not found --> use end position
+    if (pos == -1)
+        pos = index->size - 1;
 
-        if (XGCCommand_isFrameSize(c))
-            result++;
-        if (c == command)
-            break;
-
-        com = com->next;
-    }
+    // number of frame up to the command (included)
+    const int result = index->times[pos + 1] - 1;
 
     // convert in sample (44100 Hz)
     return (result * 44100) / (source->pal ? 50 : 60);
@@ -686,23 +701,13 @@ int XGC_getTimeInFrame(XGM* xgm, XGMCommand* command)
  */
 LList* XGC_getCommandElementAtTime(XGM* source, int time)
 {
-    LList* com = source->commands;
-    const int adjTime = (time * 60) / 44100;
-    int result = 0;
-
-    while(com != NULL)
-    {
-        XGMCommand* command = com->element;
-
-        if (result >= adjTime)
-            return com;
-        if (XGCCommand_isFrameSize(command))
-            result++;
+    LListIndex* index = getCommandIndex(source);
+    const int pos = findTimeLListIndex(index, (time * 60) / 44100);
 
-        com = com->next;
-    }
+    if (pos == -1)
+        return NULL;
 
-    return com;
+    return index->elements[pos];
 }
 
 unsigned char* XGC_asByteArray(XGM* source, int *outSize)
@@ -710,12 +715,12 @@ unsigned char* XGC_asByteArray(XGM* source, int *outSize)
     int s;
     int offset;
     unsigned char byte;
-    FILE* f = fopen("tmp.bin", "wb+");
+    FILE* f = openTempFile();
     LList* l;
 
     if (f == NULL)
     {
-        printf("Error: cannot open file tmp.bin\n");
+        printf("Error: cannot open temporary file\n");
         return NULL;
     }
 
@@ -25,6 +25,7 @@ XGM* XGM_create()
 
     result->samples = NULL;
     result->commands = NULL;
+    result->commandIndex = NULL;
     result->gd3 = NULL;
     result->xd3 = NULL;
     result->pal = -1;
@@ -627,26 +628,38 @@ int XGM_computeLenInSecond(XGM* xgm)
     return XGM_computeLenInFrame(xgm) / (xgm->pal ? 50 : 60);
 }
 
+static int getCommandSize(void* command)
+{
+    return ((XGMCommand*) command)->size;
+}
+
+static int getCommandFrame(void* command)
+{
+    return XGMCommand_isFrame(command) ? 1 : 0;
+}
+
 /**
- * Return the offset of the specified command
+ * Return command index (offset and frame position of each command)
  */
-int XGM_getOffset(XGM* xgm, XGMCommand* command)
+static LListIndex* getCommandIndex(XGM* xgm)
 {
-    int result = 0;
-    LList* com = xgm->commands;
+    xgm->commandIndex = getLListIndex(xgm->commandIndex, xgm->commands, getCommandSize, getCommandFrame);
 
-    while(com != NULL)
-    {
-        XGMCommand* c = com->element;
+    return xgm->commandIndex;
+}
 
-        if (c == command)
-            return result;
+/**
+ * Return the offset of the specified command
+ */
+int XGM_getOffset(XGM* xgm, XGMCommand* command)
+{
+    LListIndex* index = getCommandIndex(xgm);
+    const int pos = getPositionLListIndex(index, command);
 
-        result += c->size;
-        com = com->next;
-    }
+    if (pos == -1)
+        return -1;
 
-    return -1;
+    return index->offsets[pos];
 }
 
 /**
@@ -654,20 +667,15 @@ int XGM_getOffset(XGM* xgm, XGMCommand* command)
  */
 int XGM_getTime(XGM* xgm, XGMCommand* command)
 {
-    int result = -1;
-    LList* com = xgm->commands;
+    LListIndex* index = getCommandIndex(xgm);
+    int pos = getPositionLListIndex(index, command);
 
-    while(com != NULL)
-    {
-        XGMCommand* c = com->element;
+    // not found --> use end position
+    if (pos == -1)
+        pos = index->size - 1;
 
-        if (XGMCommand_isFrame(c))
-            result++;
-        if (c == command)
-            break;
-
-        com = com->next;
-    }
+    // number of frame up to the command (included)
+    const int result = index->times[pos + 1] - 1;
 
     // convert in sample (44100 Hz)
     return (result * 44100) / (xgm->pal ? 50 : 60);
@@ -683,21 +691,13 @@ int XGM_getTimeInFrame(XGM* xgm, XGMCommand* command)
 
 LList* XGM_getCommandElementAtOffset(XGM* xgm, int offset)
 {
-    LList* com = xgm->commands;
-    int curOffset = 0;
-
-    while(com != NULL)
-    {
-        XGMCommand* command = com->element;
+    LListIndex* index = getCommandIndex(xgm);
+    const int pos = findOffsetLListIndex(index, offset);
 
-        if (curOffset == offset)
-            return com;
-
-        curOffset += command->size;
-        com = com->next;
-    }
+    if (pos == -1)
+        return NULL;
 
-    return NULL;
+    return index->elements[pos];
 }
 
 /**
@@ -705,23 +705,13 @@ LList* XGM_getCommandElementAtOffset(XGM* xgm, int offset)
  */
 LList* XGM_getCommandElementAtTime(XGM* xgm, int time)
 {
-    int adjTime = (time * 60) / 44100;
-    int result = 0;
-    LList* com = xgm->commands;
-
-    while(com != NULL)
-    {
-        XGMCommand* command = com->element;
-
-        if (result >= adjTime)
-            return com;
-        if (XGMCommand_isFrame(command))
-            result++;
+    LListIndex* index = getCommandIndex(xgm);
+    const int pos = findTimeLListIndex(index, (time * 60) / 44100);
 
-        com = com->next;
-    }
+    if (pos == -1)
+        return NULL;
 
-    return NULL;
+    return index->elements[pos];
 }
 
 XGMCommand* XGM_getCommandAtOffset(XGM* xgm, int offset)
@@ -843,12 +833,12 @@ unsigned char* XGM_asByteArray(XGM* xgm, int *outSize)
     int i;
     int offset;
     unsigned char byte;
-    FILE* f = fopen("tmp.bin", "wb+");
+    FILE* f = openTempFile();
     LList* l;
 
     if (f == NULL)
     {
-        printf("Error: cannot open file tmp.bin\n");
+        printf("Error: cannot open temporary file\n");
         return NULL;
     }
 
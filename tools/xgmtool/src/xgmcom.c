@@ -295,6 +295,8 @@ bool XGMCommand_removeYM2612RegWrite(XGMCommand* source, int port, int reg)
         // replace data and size
         source->data = data;
         source->size = (newSize * 2) + 1;
+        // command size changed
+        invalidateLListIndexes();
     }
     else free(data);
 
@@ -11,10 +11,34 @@
 #include "../inc/xgc.h"
 #include "../inc/compress.h"
 
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <process.h>
+#else
+#include <unistd.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#endif
+
 #define SYSTEM_AUTO     -1
 #define SYSTEM_NTSC     0
 #define SYSTEM_PAL      1
 
+#define BATCH_MAX_ARG   32
+
+
+typedef struct
+{
+    char* inFile;
+    char* outFile;
+    int argc;
+    char* argv[BATCH_MAX_ARG];
+    int pid;
+    double start;
+} BatchEntry;
+
 
 const char* version = "1.76";
 int sys;
@@ -25,66 +49,71 @@ bool sampleIgnore;
 bool delayKeyOff;
 bool keepRF5C68Cmds;
 
-int main(int argc, char *argv[ ])
-{
-    int i;
-    FILE *infile, *outfile;
 
-    if (argc < 3)
-    {
-        printf("XGMTool %s - Stephane Dallongeville - copyright 2024\n", version);
-        printf("\n");
-        printf("Usage: xgmtool inputFile outputFile <options>\n");
-        printf("XGMTool can do the following operations:\n");
-        printf(" - Optimize and reduce size of Sega Megadrive VGM file\n");
-        printf("   Note that it won't work correctly on VGM file which require sub frame accurate timing.\n");
-        printf(" - Convert a Sega Megadrive VGM file to XGM file\n");
-        printf(" - Convert a Sega Megadrive VGM file to ZGM (compressed) file\n");
-        printf(" - Convert a XGM file to Sega Megadrive VGM file\n");
-        printf(" - Compile a XGM file into a binary file (XGC) ready to played by the Z80 XGM driver\n");
-        printf(" - Convert a XGC binary file to XGM file (experimental)\n");
-        printf(" - Convert a XGC binary file to Sega Megadrive VGM file (experimental)\n");
-        printf("\n");
-        printf("Optimize VGM:\n");
-        printf("  xgmtool input.vgm output.vgm\n");
-        printf("\n");
-        printf("Convert VGM to XGM:\n");
-        printf("  xgmtool input.vgm output.xgm\n");
-        printf("\n");
-        printf("Convert VGM to ZGM:\n");
-        printf("  xgmtool input.vgm output.zgm\n");
-        printf("\n");
-        printf("Convert and compile VGM to binary/XGC:\n");
-        printf("  xgmtool input.vgm output.bin\n");
-        printf("  xgmtool input.vgm output.xgc\n");
-        printf("\n");
-        printf("Convert XGM to VGM:\n");
-        printf("  xgmtool input.xgm output.vgm\n");
-        printf("\n");
-        printf("Compile XGM to binary/XGC:\n");
-        printf("  xgmtool input.xgm output.bin\n");
-        printf("  xgmtool input.xgm output.xgc\n");
-        printf("\n");
-        printf("Convert XGC to XGM (experimental):\n");
-        printf("  xgmtool input.xgc output.xgm\n");
-        printf("\n");
-        printf("Compile XGC to VGM (experimental):\n");
-        printf("  xgmtool input.xgc output.vgm\n");
-        printf("\n");
-        printf("The action xmgtool performs is dependant from the input and output file extension.\n");
-        printf("Supported options:\n");
-        printf("-s\tenable silent mode (no message except error and warning).\n");
-        printf("-v\tenable verbose mode (give more info about conversion).\n");
-        printf("-n\tforce NTSC timing (only meaningful for VGM to XGM conversion).\n");
-        printf("-p\tforce PAL timing (only meaningful for VGM to XGM conversion).\n");
-        printf("-di\tdisable PCM sample auto ignore (it can help when PCM are not properly extracted).\n");
-        printf("-dr\tdisable PCM sample rate auto fix (it can help when PCM are not properly extracted).\n");
-        printf("-dd\tdisable delayed KEY OFF event when we have KEY ON/OFF in a single frame (it can fix incorrect instrument sound).\n");
-        printf("-r\tkeep RF5C68 and RF5C164 register write commands.\n");
+static void showUsage()
+{
+    printf("XGMTool %s - Stephane Dallongeville - copyright 2024\n", version);
+    printf("\n");
+    printf("Usage: xgmtool inputFile outputFile <options>\n");
+    printf("XGMTool can do the following operations:\n");
+    printf(" - Optimize and reduce size of Sega Megadrive VGM file\n");
+    printf("   Note that it won't work correctly on VGM file which require sub frame accurate timing.\n");
+    printf(" - Convert a Sega Megadrive VGM file to XGM file\n");
+    printf(" - Convert a Sega Megadrive VGM file to ZGM (compressed) file\n");
+    printf(" - Convert a XGM file to Sega Megadrive VGM file\n");
+    printf(" - Compile a XGM file into a binary file (XGC) ready to played by the Z80 XGM driver\n");
+    printf(" - Convert a XGC binary file to XGM file (experimental)\n");
+    printf(" - Convert a XGC binary file to Sega Megadrive VGM file (experimental)\n");
+    printf("\n");
+    printf("Compressed VGM (VGZ) input is accepted wherever VGM input is.\n");
+    printf("\n");
+    printf("Optimize VGM:\n");
+    printf("  xgmtool input.vgm output.vgm\n");
+    printf("\n");
+    printf("Convert VGM to XGM:\n");
+    printf("  xgmtool input.vgm output.xgm\n");
+    printf("\n");
+    printf("Convert VGM to ZGM:\n");
+    printf("  xgmtool input.vgm output.zgm\n");
+    printf("\n");
+    printf("Convert and compile VGM to binary/XGC:\n");
+    printf("  xgmtool input.vgm output.bin\n");
+    printf("  xgmtool input.vgm output.xgc\n");
+    printf("\n");
+    printf("Convert XGM to VGM:\n");
+    printf("  xgmtool input.xgm output.vgm\n");
+    printf("\n");
+    printf("Compile XGM to binary/XGC:\n");
+    printf("  xgmtool input.xgm output.bin\n");
+    printf("  xgmtool input.xgm output.xgc\n");
+    printf("\n");
+    printf("Convert XGC to XGM (experimental):\n");
+    printf("  xgmtool input.xgc output.xgm\n");
+    printf("\n");
+    printf("Compile XGC to VGM (experimental):\n");
+    printf("  xgmtool input.xgc output.vgm\n");
+    printf("\n");
+    printf("The action xmgtool performs is dependant from the input and output file extension.\n");
+    printf("Supported options:\n");
+    printf("-s\tenable silent mode (no message except error and warning).\n");
+    printf("-v\tenable verbose mode (give more info about conversion).\n");
+    printf("-n\tforce NTSC timing (only meaningful for VGM to XGM conversion).\n");
+    printf("-p\tforce PAL timing (only meaningful for VGM to XGM conversion).\n");
+    printf("-di\tdisable PCM sample auto ignore (it can help when PCM are not properly extracted).\n");
+    printf("-dr\tdisable PCM sample rate auto fix (it can help when PCM are not properly extracted).\n");
+    printf("-dd\tdisable delayed KEY OFF event when we have KEY ON/OFF in a single frame (it can fix incorrect instrument sound).\n");
+    printf("-r\tkeep RF5C68 and RF5C164 register write commands.\n");
+    printf("\n");
+    printf("Batch conversion:\n");
+    printf("  xgmtool -b manifest.txt [-j<n>] <options>\n");
+    printf("Manifest contains one conversion per line: inputFile outputFile <options> (use double quotes for path containing spaces, # for comment).\n");
+    printf("Conversions run in separate processes, -j<n> sets the number of concurrent conversions (number of CPU by default).\n");
+    printf("Options given after the manifest apply to all entries, entries are silent by default (use -v to get messages).\n");
 
-        exit(1);
-    }
+}
 
+static void setDefaultOptions()
+{
     sys = SYSTEM_AUTO;
     silent = false;
     verbose = false;
@@ -92,25 +121,13 @@ int main(int argc, char *argv[ ])
     sampleRateFix = true;
     delayKeyOff = true;
     keepRF5C68Cmds = false;
+}
 
-    // Open source for binary read (will fail if file does not exist)
-    if ((infile = fopen(argv[1], "rb")) == NULL)
-    {
-        printf("Error: the source file %s could not be opened\n", argv[1]);
-        exit(2);
-    }
-
-    // test open output for write
-    if ((outfile = fopen(argv[2], "wb")) == NULL)
-    {
-        printf("Error: the output file %s could not be opened\n", argv[2]);
-        exit(3);
-    }
-    // can close
-    fclose(outfile);
+static void parseOptions(int argc, char *argv[])
+{
+    int i;
 
-    // options
-    for(i = 3; i < argc; i++)
+    for(i = 0; i < argc; i++)
     {
         if (!strcasecmp(argv[i], "-s"))
         {
@@ -141,13 +158,41 @@ int main(int argc, char *argv[ ])
     // silent mode has priority
     if (silent)
         verbose = false;
+}
+
+// release command index of a VGM / XGM object we are done with
+static void releaseIndex(LListIndex** index)
+{
+    deleteLListIndex(*index);
+    *index = NULL;
+}
+
+static int convert(char* inFile, char* outFile)
+{
+    FILE *infile, *outfile;
+
+    // Open source for binary read (will fail if file does not exist)
+    if ((infile = fopen(inFile, "rb")) == NULL)
+    {
+        printf("Error: the source file %s could not be opened\n", inFile);
+        exit(2);
+    }
+
+    // test open output for write
+    if ((outfile = fopen(outFile, "wb")) == NULL)
+    {
+        printf("Error: the output file %s could not be opened\n", outFile);
+        exit(3);
+    }
+    // can close
+    fclose(outfile);
 
-    char* inExt = getFileExtension(argv[1]);
-    char* outExt = getFileExtension(argv[2]);
+    char* inExt = getFileExtension(inFile);
+    char* outExt = getFileExtension(outFile);
     int errCode = 0;
 
-    // VGM or empty (assumed as VGM)
-    if (!strcasecmp(inExt, "VGM") || !strlen(inExt))
+    // VGM, VGZ (compressed VGM) or empty (assumed as VGM)
+    if (!strcasecmp(inExt, "VGM") || !strcasecmp(inExt, "VGZ") || !strlen(inExt))
     {
         if ((!strcasecmp(outExt, "VGM")) || (!strcasecmp(outExt, "XGM")) || (!strcasecmp(outExt, "BIN")) || (!strcasecmp(outExt, "XGC")) || (!strcasecmp(outExt, "ZGM")))
         {
@@ -160,7 +205,7 @@ int main(int argc, char *argv[ ])
 //            VGM* optVgm;
 
             // load file
-            inData = readBinaryFile(argv[1], &inDataSize);
+            inData = mapBinaryFile(inFile, &inDataSize);
             if (inData == NULL) exit(1);
             // load VGM
             if (sys == SYSTEM_NTSC)
@@ -185,8 +230,9 @@ int main(int argc, char *argv[ ])
                 // get byte array
                 outData = VGM_asByteArray(vgm, &outDataSize);
                 if (outData == NULL) exit(1);
+                releaseIndex(&vgm->commandIndex);
                 // write to file
-                writeBinaryFile(outData, outDataSize, argv[2]);
+                writeBinaryFile(outData, outDataSize, outFile);
             }
             else if (!strcasecmp(outExt, "ZGM"))
             {
@@ -200,13 +246,14 @@ int main(int argc, char *argv[ ])
                 // split VGM command stream and PCM data blocks
                 outData = VGM_asByteArray2(vgm, &outDataSize, &outData2, &outDataSize2);
                 if (outData == NULL) exit(1);
+                releaseIndex(&vgm->commandIndex);
 
                 // compress VGM stream
                 lzsize = lz77c_compress_buf(outData, outDataSize, (void **)&lz);
                 if (lz == NULL) exit(1);
 
                 // write to file
-                fp = fopen(argv[2], "wb");
+                fp = fopen(outFile, "wb");
                 fwrite(lz, 1, lzsize, fp);
                 fwrite(outData2, 1, outDataSize2, fp);
                 fclose(fp);
@@ -220,6 +267,7 @@ int main(int argc, char *argv[ ])
                 // convert to XGM
                 xgm = XGM_createFromVGM(vgm);
                 if (xgm == NULL) exit(1);
+                releaseIndex(&vgm->commandIndex);
 
                 // XGM output
                 if (!strcasecmp(outExt, "XGM"))
@@ -236,16 +284,18 @@ int main(int argc, char *argv[ ])
                     if (xgc == NULL) exit(1);
                     // get byte array
                     outData = XGC_asByteArray(xgc, &outDataSize);
+                    releaseIndex(&xgc->commandIndex);
                 }
 
+                releaseIndex(&xgm->commandIndex);
                 if (outData == NULL) exit(1);
                 // write to file
-                writeBinaryFile(outData, outDataSize, argv[2]);
+                writeBinaryFile(outData, outDataSize, outFile);
             }
         }
         else
         {
-            printf("Error: the output file %s is incorrect (should be a VGM, XGM or BIN/XGC file)\n", argv[2]);
+            printf("Error: the output file %s is incorrect (should be a VGM, XGM or BIN/XGC file)\n", outFile);
             errCode = 4;
         }
     }
@@ -261,7 +311,7 @@ int main(int argc, char *argv[ ])
             XGM* xgm;
 
             // load file
-            inData = readBinaryFile(argv[1], &inDataSize);
+            inData = mapBinaryFile(inFile, &inDataSize);
             if (inData == NULL) exit(1);
             // load XGM
             xgm = XGM_createFromData(inData, inDataSize);
@@ -277,6 +327,7 @@ int main(int argc, char *argv[ ])
                 if (vgm == NULL) exit(1);
                 // get byte array
                 outData = VGM_asByteArray(vgm, &outDataSize);
+                releaseIndex(&vgm->commandIndex);
             }
             else
             {
@@ -287,15 +338,17 @@ int main(int argc, char *argv[ ])
                 if (xgc == NULL) exit(1);
                 // get byte array
                 outData = XGC_asByteArray(xgc, &outDataSize);
+                releaseIndex(&xgc->commandIndex);
             }
 
+            releaseIndex(&xgm->commandIndex);
             if (outData == NULL) exit(1);
             // write to file
-            writeBinaryFile(outData, outDataSize, argv[2]);
+            writeBinaryFile(outData, outDataSize, outFile);
         }
         else
         {
-            printf("Error: the output file %s is incorrect (should be a VGM or BIN/XGC file)\n", argv[2]);
+            printf("Error: the output file %s is incorrect (should be a VGM or BIN/XGC file)\n", outFile);
             errCode = 4;
         }
     }
@@ -311,7 +364,7 @@ int main(int argc, char *argv[ ])
             XGM* xgm;
 
             // load file
-            inData = readBinaryFile(argv[1], &inDataSize);
+            inData = mapBinaryFile(inFile, &inDataSize);
             if (inData == NULL) exit(1);
             // load XGM
             xgm = XGM_createFromXGCData(inData, inDataSize);
@@ -327,6 +380,7 @@ int main(int argc, char *argv[ ])
                 if (vgm == NULL) exit(1);
                 // get byte array
                 outData = VGM_asByteArray(vgm, &outDataSize);
+                releaseIndex(&vgm->commandIndex);
             }
             else
             {
@@ -334,25 +388,378 @@ int main(int argc, char *argv[ ])
                 outData = XGM_asByteArray(xgm, &outDataSize);
             }
 
+            releaseIndex(&xgm->commandIndex);
             if (outData == NULL) exit(1);
             // write to file
-            writeBinaryFile(outData, outDataSize, argv[2]);
+            writeBinaryFile(outData, outDataSize, outFile);
         }
         else
         {
-            printf("Error: the output file %s is incorrect (should be a XGM or VGM file)\n", argv[2]);
+            printf("Error: the output file %s is incorrect (should be a XGM or VGM file)\n", outFile);
             errCode = 4;
         }
     }
     else
     {
-        printf("Error: the input file %s is incorrect (should be a VGM, XGM or XGC file)\n", argv[1]);
+        printf("Error: the input file %s is incorrect (should be a VGM, VGZ, XGM or XGC file)\n", inFile);
         errCode = 4;
     }
 
     fclose(infile);
 
-    remove("tmp.bin");
-
     return errCode;
 }
+
+
+static double getTime()
+{
+#ifdef _WIN32
+    LARGE_INTEGER freq;
+    LARGE_INTEGER counter;
+
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&counter);
+
+    return (double) counter.QuadPart / (double) freq.QuadPart;
+#else
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+
+    return tv.tv_sec + (tv.tv_usec / 1000000.0);
+#endif
+}
+
+static int getNumCPU()
+{
+#ifdef _WIN32
+    SYSTEM_INFO info;
+
+    GetSystemInfo(&info);
+
+    return (info.dwNumberOfProcessors > 0) ? (int) info.dwNumberOfProcessors : 1;
+#else
+    const long result = sysconf(_SC_NPROCESSORS_ONLN);
+
+    return (result > 0) ? result : 1;
+#endif
+}
+
+static int getFileSizeOrError(char* file)
+{
+    FILE* f = fopen(file, "rb");
+
+    if (f == NULL) return -1;
+
+    const int result = getFileSizeEx(f);
+    fclose(f);
+
+    return result;
+}
+
+/**
+ * Split a manifest line in arguments (double quotes can be used for argument containing spaces)
+ */
+static int splitArgs(char* line, char* args[], int max)
+{
+    char* s = line;
+    int result = 0;
+
+    while(true)
+    {
+        // skip spaces
+        while((*s == ' ') || (*s == '\t') || (*s == '\r') || (*s == '\n')) s++;
+        // end of line or comment
+        if ((*s == 0) || (*s == '#')) break;
+
+        if (result >= max)
+        {
+            printf("Warning: too many arguments in batch entry (max = %d)\n", max);
+            break;
+        }
+
+        if (*s == '"')
+        {
+            args[result++] = ++s;
+            while(*s && (*s != '"')) s++;
+        }
+        else
+        {
+            args[result++] = s;
+            while(*s && (*s != ' ') && (*s != '\t') && (*s != '\r') && (*s != '\n')) s++;
+        }
+
+        if (*s == 0) break;
+        *s++ = 0;
+    }
+
+    return result;
+}
+
+static BatchEntry* readManifest(char* fileName, int* num)
+{
+    char line[1024];
+    BatchEntry* result = NULL;
+    int allocated = 0;
+    int lineNum = 0;
+    FILE* f;
+
+    *num = 0;
+
+    if ((f = fopen(fileName, "r")) == NULL)
+    {
+        printf("Error: the manifest file %s could not be opened\n", fileName);
+        return NULL;
+    }
+
+    while(fgets(line, sizeof(line), f) != NULL)
+    {
+        char* args[BATCH_MAX_ARG + 2];
+        int argc;
+        int i;
+
+        lineNum++;
+        argc = splitArgs(line, args, BATCH_MAX_ARG + 2);
+
+        // empty line or comment
+        if (argc == 0) continue;
+        if (argc < 2)
+        {
+            printf("Warning: manifest line %d ignored (missing output file)\n", lineNum);
+            continue;
+        }
+
+        if (*num >= allocated)
+        {
+            allocated = (allocated * 2) + 16;
+            result = realloc(result, sizeof(BatchEntry) * allocated);
+        }
+
+        BatchEntry* entry = &result[(*num)++];
+
+        entry->inFile = strdup(args[0]);
+        entry->outFile = strdup(args[1]);
+        entry->argc = argc - 2;
+        for(i = 0; i < entry->argc; i++)
+            entry->argv[i] = strdup(args[i + 2]);
+        entry->pid = 0;
+        entry->start = 0;
+    }
+
+    fclose(f);
+
+    return result;
+}
+
+static void showBatchResult(BatchEntry* entry, int status, double time)
+{
+    const int inSize = getFileSizeOrError(entry->inFile);
+    const int outSize = getFileSizeOrError(entry->outFile);
+
+    if (status == 0)
+        printf("%s -> %s: %d -> %d bytes in %.3f s\n", entry->inFile, entry->outFile, inSize, outSize, time);
+    else
+        printf("%s -> %s: failed (error %d) in %.3f s\n", entry->inFile, entry->outFile, status, time);
+
+    fflush(stdout);
+}
+
+/**
+ * Convert all entries of the manifest file, each conversion runs in its own process (isolated) and up to numJob run concurrently
+ */
+static int batch(char* manifest, int numJob, int argc, char *argv[])
+{
+    BatchEntry* entries;
+    int num;
+    int numError;
+    double start;
+
+    entries = readManifest(manifest, &num);
+    if (entries == NULL) return 1;
+
+    if (numJob <= 0)
+        numJob = getNumCPU();
+#ifdef _WIN32
+    // limited by WaitForMultipleObjects(..)
+    if (numJob > MAXIMUM_WAIT_OBJECTS)
+        numJob = MAXIMUM_WAIT_OBJECTS;
+#endif
+
+    printf("Batch conversion of %d file(s) (%d job(s))\n", num, numJob);
+    fflush(stdout);
+
+    numError = 0;
+    start = getTime();
+
+#ifdef _WIN32
+    // no fork here --> re-launch ourself for each entry
+    HANDLE handles[MAXIMUM_WAIT_OBJECTS];
+    BatchEntry* runningEntries[MAXIMUM_WAIT_OBJECTS];
+    int next = 0;
+    int running = 0;
+
+    while((next < num) || (running > 0))
+    {
+        // start new conversions
+        while((next < num) && (running < numJob))
+        {
+            BatchEntry* entry = &entries[next++];
+            char* args[(BATCH_MAX_ARG * 2) + 5];
+            char inFile[1024];
+            char outFile[1024];
+            int n = 0;
+            int j;
+
+            snprintf(inFile, sizeof(inFile), "\"%s\"", entry->inFile);
+            snprintf(outFile, sizeof(outFile), "\"%s\"", entry->outFile);
+
+            args[n++] = "xgmtool";
+            args[n++] = inFile;
+            args[n++] = outFile;
+            args[n++] = "-s";
+            for(j = 0; (j < argc) && (j < BATCH_MAX_ARG); j++) args[n++] = argv[j];
+            for(j = 0; j < entry->argc; j++) args[n++] = entry->argv[j];
+            args[n] = NULL;
+
+            entry->start = getTime();
+            // command line is built at spawn time so args can be released right after
+            const intptr_t handle = _spawnv(_P_NOWAIT, _pgmptr, (const char* const*) args);
+
+            if (handle == -1)
+            {
+                printf("Error: cannot start conversion of %s\n", entry->inFile);
+                numError++;
+                continue;
+            }
+
+            handles[running] = (HANDLE) handle;
+            runningEntries[running] = entry;
+            running++;
+        }
+
+        if (running == 0) break;
+
+        // wait for any conversion to end
+        const DWORD res = WaitForMultipleObjects(running, handles, FALSE, INFINITE);
+
+        if ((res < WAIT_OBJECT_0) || (res >= (WAIT_OBJECT_0 + running))) break;
+
+        const int i = res - WAIT_OBJECT_0;
+        BatchEntry* entry = runningEntries[i];
+        DWORD code;
+
+        if (!GetExitCodeProcess(handles[i], &code)) code = (DWORD) -1;
+        CloseHandle(handles[i]);
+
+        if (code != 0) numError++;
+        showBatchResult(entry, (int) code, getTime() - entry->start);
+
+        // keep running handles packed
+        running--;
+        handles[i] = handles[running];
+        runningEntries[i] = runningEntries[running];
+    }
+#else
+    int next = 0;
+    int running = 0;
+
+    while((next < num) || (running > 0))
+    {
+        // start new conversions
+        while((next < num) && (running < numJob))
+        {
+            BatchEntry* entry = &entries[next++];
+
+            // don't duplicate buffered output in child
+            fflush(stdout);
+
+            entry->start = getTime();
+            entry->pid = fork();
+
+            if (entry->pid == 0)
+            {
+                // child: entries are silent by default
+                setDefaultOptions();
+                silent = true;
+                parseOptions(argc, argv);
+                parseOptions(entry->argc, entry->argv);
+
+                exit(convert(entry->inFile, entry->outFile));
+            }
+
+            if (entry->pid < 0)
+            {
+                printf("Error: cannot start conversion of %s\n", entry->inFile);
+                numError++;
+                continue;
+            }
+
+            running++;
+        }
+
+        // wait for any conversion to end
+        int status;
+        const int pid = wait(&status);
+        int i;
+
+        if (pid < 0) break;
+
+        for(i = 0; i < num; i++)
+        {
+            BatchEntry* entry = &entries[i];
+
+            if (entry->pid == pid)
+            {
+                const int code = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+
+                if (code != 0) numError++;
+                showBatchResult(entry, code, getTime() - entry->start);
+                entry->pid = 0;
+                running--;
+                break;
+            }
+        }
+    }
+#endif
+
+    printf("Batch done: %d file(s) converted, %d error(s) in %.3f s\n", num - numError, numError, getTime() - start);
+
+    return (numError > 0) ? 5 : 0;
+}
+
+int main(int argc, char *argv[ ])
+{
+    if (argc < 3)
+    {
+        showUsage();
+        exit(1);
+    }
+
+    // batch mode
+    if (!strcasecmp(argv[1], "-b"))
+    {
+        char* options[BATCH_MAX_ARG];
+        int numOption = 0;
+        int numJob = 0;
+        int i;
+
+        for(i = 3; i < argc; i++)
+        {
+            if (!strncasecmp(argv[i], "-j", 2))
+            {
+                // -j<n> or -j <n>
+                if (argv[i][2] != 0) numJob = atoi(&argv[i][2]);
+                else if ((i + 1) < argc) numJob = atoi(argv[++i]);
+            }
+            else if (numOption < BATCH_MAX_ARG)
+                options[numOption++] = argv[i];
+        }
+
+        return batch(argv[2], numJob, numOption, options);
+    }
+
+    setDefaultOptions();
+    parseOptions(argc - 3, &argv[3]);
+
+    return convert(argv[1], argv[2]);
+}